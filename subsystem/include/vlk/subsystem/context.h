@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <memory>
 #include <string_view>
 #include <utility>
 #include <vector>
@@ -14,6 +16,24 @@ namespace vlk {
 
 enum class SubsystemError : uint8_t { Exists };
 
+/// wakes the app's event loop up whilst it is blocked waiting for events (i.e.
+/// when idle), so the completion of a background task is picked up without
+/// polling. thread-safe.
+struct EventLoopWaker {
+  void wake() const {
+    void (*wake_fn)() = wake_fn_.load(std::memory_order_acquire);
+    if (wake_fn != nullptr) wake_fn();
+  }
+
+  /// binds the function that wakes the event loop up, called by the app
+  void __bind(void (*wake_fn)()) {
+    wake_fn_.store(wake_fn, std::memory_order_release);
+  }
+
+ private:
+  std::atomic<void (*)()> wake_fn_{nullptr};
+};
+
 struct SubsystemsContext {
   SubsystemsContext() = default;
 
@@ -26,6 +46,9 @@ struct SubsystemsContext {
     }
   }
 
+  /// shared with the background tasks, so it outlives the context
+  std::shared_ptr<EventLoopWaker> get_waker() const { return waker_; }
+
   stx::Span<std::string_view const> enumerate_subsystems() const {
     return enumeration_;
   }
@@ -73,6 +96,7 @@ struct SubsystemsContext {
  private:
   std::map<std::string, stx::Rc<Subsystem*>, std::less<>> map_;
   std::vector<std::string_view> enumeration_;
+  std::shared_ptr<EventLoopWaker> waker_ = std::make_shared<EventLoopWaker>();
 };
 
 }  // namespace vlk
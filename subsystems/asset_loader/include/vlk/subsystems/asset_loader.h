@@ -1,11 +1,11 @@
 #pragma once
 
+#include <memory>
 #include <utility>
 
 #include "stx/async.h"
 #include "stx/result.h"
 #include "stx/scheduler.h"
-#include "stx/scheduler/scheduling/schedule.h"
 #include "vlk/font_asset.h"
 #include "vlk/font_source.h"
 #include "vlk/image_asset.h"
@@ -32,6 +32,8 @@ struct AssetLoader : public Subsystem {
     scheduler = stx::Some(
         stx::transmute(scheduler_subsystem.handle->as<TaskScheduler>().unwrap(),
                        std::move(scheduler_subsystem)));
+
+    waker = context.get_waker();
   }
 
   virtual void tick(std::chrono::nanoseconds) override {}
@@ -45,8 +47,7 @@ struct AssetLoader : public Subsystem {
       FileImageSource source) {
     stx::Rc<FileImageSourceData const*>& data = source.data;
 
-    return stx::sched::fn(
-        scheduler.value().handle->scheduler,
+    return scheduler.value().handle->fn_and_wake(
         [data_ = data.share()]() -> stx::Result<ImageAsset, ImageLoadError> {
           return impl::StbiImageBuffer::load_from_file(
                      data_.handle->path, data_.handle->target_format)
@@ -54,7 +55,7 @@ struct AssetLoader : public Subsystem {
                 return ImageAsset{impl::make_sk_image(buffer)};
               });
         },
-        stx::NORMAL_PRIORITY,
+        waker,
         stx::TaskTraceInfo{
             stx::string::rc::make_static_view("AssetLoader"),
             stx::transmute(std::string_view{data.handle->tag}, data.share())});
@@ -64,14 +65,13 @@ struct AssetLoader : public Subsystem {
       MemoryImageSource source) {
     stx::Rc<MemoryImageSourceData const*>& data = source.data;
 
-    return stx::sched::fn(
-        scheduler.value().handle->scheduler,
+    return scheduler.value().handle->fn_and_wake(
         [data_ = data.share()]() -> stx::Result<ImageAsset, ImageLoadError> {
           return stx::Ok{ImageAsset{impl::make_sk_image(
               data_.handle->info, stx::Span{data_.handle->bytes.data(),
                                             data_.handle->bytes.size()})}};
         },
-        stx::NORMAL_PRIORITY,
+        waker,
         stx::TaskTraceInfo{
             stx::string::rc::make_static_view("AssetLoader"),
             stx::transmute(std::string_view{data.handle->tag}, data.share())});
@@ -80,15 +80,14 @@ struct AssetLoader : public Subsystem {
   stx::Future<stx::Result<FontAsset, FontLoadError>> load_font(
       MemoryTypefaceSource source) {
     auto& data = source.data;
-    return stx::sched::fn(
-        scheduler.value().handle->scheduler,
+    return scheduler.value().handle->fn_and_wake(
         [source_ = source]() {
           return impl::load_typeface_from_memory(source_.get_bytes().handle)
               .map([](sk_sp<SkTypeface>&& typeface) {
                 return FontAsset{std::move(typeface)};
               });
         },
-        stx::NORMAL_PRIORITY,
+        waker,
         stx::TaskTraceInfo{
             stx::string::rc::make_static_view("AssetLoader"),
             stx::transmute(std::string_view{data.handle->tag}, data.share())});
@@ -97,15 +96,14 @@ struct AssetLoader : public Subsystem {
   stx::Future<stx::Result<FontAsset, FontLoadError>> load_font(
       FileTypefaceSource source) {
     auto& data = source.data;
-    return stx::sched::fn(
-        scheduler.value().handle->scheduler,
+    return scheduler.value().handle->fn_and_wake(
         [source_ = source]() {
           return impl::load_typeface_from_file(source_.get_path())
               .map([](sk_sp<SkTypeface>&& typeface) {
                 return FontAsset{std::move(typeface)};
               });
         },
-        stx::NORMAL_PRIORITY,
+        waker,
         stx::TaskTraceInfo{
             stx::string::rc::make_static_view("AssetLoader"),
             stx::transmute(std::string_view{data.handle->tag}, data.share())});
@@ -115,8 +113,7 @@ struct AssetLoader : public Subsystem {
       SystemFont font) {
     Rc<SystemFontData const*> font_data = font.data.share();
     std::string_view tag{font_data.handle->tag};
-    return stx::sched::fn(
-        scheduler.value().handle->scheduler,
+    return scheduler.value().handle->fn_and_wake(
         [font_ = std::move(font)]() {
           return impl::load_system_typeface(font_.get_family(),
                                             font_.get_style())
@@ -124,7 +121,7 @@ struct AssetLoader : public Subsystem {
                 return FontAsset{std::move(typeface)};
               });
         },
-        stx::NORMAL_PRIORITY,
+        waker,
         stx::TaskTraceInfo{
             stx::string::rc::make_static_view("AssetLoader"),
             stx::transmute(std::string_view{tag}, std::move(font_data))});
@@ -136,6 +133,10 @@ struct AssetLoader : public Subsystem {
       FileFontSource source);
 
   stx::Option<stx::Rc<vlk::TaskScheduler*>> scheduler = stx::None;
+
+  // the tasks wake the event loop up once they complete, the widgets awaiting
+  // their futures keep it ticking until the futures are completed
+  std::shared_ptr<EventLoopWaker> waker = std::make_shared<EventLoopWaker>();
 };
 
 }  // namespace vlk
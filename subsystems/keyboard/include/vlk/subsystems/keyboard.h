@@ -31,6 +31,14 @@ struct Keyboard : public Subsystem {
 
   void __fire();
 
+  // calls the listeners with the event, in the order they were added
+  void __dispatch(KeyboardEvent const &event) {
+    listeners_.span().for_each(
+        [&event](stx::RcFn<void(KeyboardEvent)> &listener) {
+          listener.handle(event);
+        });
+  }
+
   stx::Vec<stx::RcFn<void(KeyboardEvent)>> listeners_;
 };
 
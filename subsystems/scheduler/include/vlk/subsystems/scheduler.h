@@ -1,6 +1,12 @@
 #pragma once
 
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "stx/async.h"
 #include "stx/scheduler.h"
+#include "stx/scheduler/scheduling/schedule.h"
 #include "vlk/subsystem.h"
 #include "vlk/subsystem/context.h"
 #include "vlk/subsystems/scheduler.h"
@@ -24,6 +30,31 @@ struct TaskScheduler : public Subsystem {
 
   virtual ~TaskScheduler() override {}
 
+  // runs `fn` on the worker threads and wakes the event loop up once it
+  // completes. unlike `stx::sched::fn`'s, the returned future is completed by
+  // the task itself before waking the event loop up, so the woken event loop
+  // never finds it still pending.
+  template <typename Fn>
+  auto fn_and_wake(Fn fn, std::shared_ptr<EventLoopWaker> const& waker,
+                   stx::TaskTraceInfo trace_info) {
+    using Output = std::invoke_result_t<Fn const&>;
+
+    stx::Promise<Output> promise =
+        stx::make_promise<Output>(stx::os_allocator).unwrap();
+    stx::Future<Output> future = promise.get_future();
+
+    stx::sched::fn(
+        scheduler,
+        [fn_ = std::move(fn), promise_ = std::move(promise),
+         waker_ = waker]() {
+          promise_.notify_completed(fn_());
+          waker_->wake();
+        },
+        stx::NORMAL_PRIORITY, std::move(trace_info));
+
+    return future;
+  }
+
   stx::TaskScheduler scheduler;
 };
 
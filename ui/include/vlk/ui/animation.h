@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "stx/async.h"
+#include "stx/struct.h"
+#include "vlk/subsystem.h"
+#include "vlk/subsystem/context.h"
+#include "vlk/ui/layer_effects.h"
+#include "vlk/ui/tween.h"
+#include "vlk/ui/widget.h"
+
+namespace vlk {
+namespace ui {
+
+/// identifies an animation on the engine. ids are never re-used, so a stale
+/// id doesn't refer to a later animation.
+using AnimationId = uint64_t;
+
+/// the property of a widget an animation writes to. the widget is marked with
+/// `dirtiness` whenever the property's value changes.
+///
+/// NOTE: the widget must outlive its animations, a widget that is deleted
+/// whilst animating must first cancel them (`AnimationEngine::cancel`).
+struct AnimationTarget {
+  Widget *widget = nullptr;
+  float *value = nullptr;
+  WidgetDirtiness dirtiness = WidgetDirtiness::Render;
+
+  /// the layer effects are picked up by the tile cache on its next tick, so
+  /// animating them doesn't dirty the widget
+  static AnimationTarget layer_opacity(Widget &widget) {
+    return layer_target_(widget,
+                         &WidgetSystemProxy::get_layer_effects(widget).opacity);
+  }
+
+  static AnimationTarget layer_translate_x(Widget &widget) {
+    return layer_target_(
+        widget,
+        &WidgetSystemProxy::get_layer_effects(widget).transform.translate_x);
+  }
+
+  static AnimationTarget layer_translate_y(Widget &widget) {
+    return layer_target_(
+        widget,
+        &WidgetSystemProxy::get_layer_effects(widget).transform.translate_y);
+  }
+
+  static AnimationTarget layer_scale_x(Widget &widget) {
+    return layer_target_(
+        widget,
+        &WidgetSystemProxy::get_layer_effects(widget).transform.scale_x);
+  }
+
+  static AnimationTarget layer_scale_y(Widget &widget) {
+    return layer_target_(
+        widget,
+        &WidgetSystemProxy::get_layer_effects(widget).transform.scale_y);
+  }
+
+ private:
+  static AnimationTarget layer_target_(Widget &widget, float *value) {
+    VLK_ENSURE(widget.is_layer(), "Widget is not a compositing layer", widget);
+    return AnimationTarget{&widget, value, WidgetDirtiness::None};
+  }
+};
+
+// evaluates all of the running animations in a batch, once per frame, before
+// the widgets are ticked.
+//
+// the animations are stored as structure-of-arrays, bucketed by curve, so each
+// bucket is evaluated by a tight branch-free loop over contiguous floats that
+// the compiler vectorizes. the results are then scattered to the targets, and
+// only the widgets whose values changed are marked dirty. an animating widget
+// thus doesn't need to subscribe to ticks nor evaluate its own curves.
+//
+// the animations complete with the value at its end, and are then removed.
+// cancelling an animation leaves its value as is.
+//
+// it is registered on the pipeline's subsystems as "VLK_Animations". the
+// pipeline evaluates it at the start of its tick, so its `Subsystem::tick` is a
+// no-op.
+//
+struct AnimationEngine : public Subsystem {
+  static constexpr AnimationId kNoAnimation = 0;
+
+  AnimationEngine() = default;
+
+  STX_MAKE_PINNED(AnimationEngine)
+
+  ~AnimationEngine() override {}
+
+  virtual void link(SubsystemsContext const &) override {}
+
+  virtual void tick(std::chrono::nanoseconds) override {}
+
+  virtual stx::FutureAny get_future() override {
+    return stx::FutureAny{
+        stx::make_promise<void>(stx::os_allocator).unwrap().get_future()};
+  }
+
+  /// animates the target from `from` to `to`. starting an animation on a
+  /// property that is already animating doesn't cancel the previous one, the
+  /// caller should cancel it first.
+  AnimationId animate(AnimationTarget const &target, float from, float to,
+                      std::chrono::nanoseconds duration,
+                      Curve curve = Curve::Linear) {
+    VLK_ENSURE(target.widget != nullptr && target.value != nullptr,
+               "Animation target is not bound to a widget's property");
+
+    uint32_t slot = 0;
+
+    if (free_slots_.empty()) {
+      slot = static_cast<uint32_t>(slots_.size());
+      slots_.push_back(Slot{});
+    } else {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    }
+
+    Batch &batch = batches_[static_cast<size_t>(curve)];
+
+    slots_[slot].curve = curve;
+    slots_[slot].index = static_cast<uint32_t>(batch.slots.size());
+    slots_[slot].is_active = true;
+
+    batch.from.push_back(from);
+    batch.to.push_back(to);
+    batch.elapsed.push_back(0.0f);
+    // zero-length animations complete on the next non-zero interval
+    batch.duration.push_back(
+        std::max(std::chrono::duration<float>(duration).count(), 1e-9f));
+    batch.value.push_back(from);
+    batch.targets.push_back(target);
+    batch.slots.push_back(slot);
+
+    return make_id_(slot, slots_[slot].generation);
+  }
+
+  /// animates the target from its present value
+  AnimationId animate_to(AnimationTarget const &target, float to,
+                         std::chrono::nanoseconds duration,
+                         Curve curve = Curve::Linear) {
+    return animate(target, *target.value, to, duration, curve);
+  }
+
+  /// returns false once the animation completed or was cancelled
+  bool is_active(AnimationId id) const { return find_slot_(id) != nullptr; }
+
+  void cancel(AnimationId id) {
+    Slot const *slot = find_slot_(id);
+    if (slot == nullptr) return;
+    remove_(batches_[static_cast<size_t>(slot->curve)], slot->index);
+  }
+
+  /// cancels all of the widget's animations. `O(n)`.
+  void cancel(Widget const &widget) {
+    for (Batch &batch : batches_) {
+      for (size_t i = 0; i < batch.slots.size();) {
+        if (batch.targets[i].widget == &widget) {
+          remove_(batch, i);
+        } else {
+          i++;
+        }
+      }
+    }
+  }
+
+  /// number of running animations
+  size_t size() const {
+    size_t size = 0;
+    for (Batch const &batch : batches_) {
+      size += batch.slots.size();
+    }
+    return size;
+  }
+
+  /// advances all of the animations by `interval` and writes their values to
+  /// their targets. returns the number of values that changed.
+  size_t evaluate(std::chrono::nanoseconds interval) {
+    float const dt = std::chrono::duration<float>(interval).count();
+
+    evaluate_batches_(dt, std::make_index_sequence<kNumCurves>{});
+
+    size_t num_changed = 0;
+
+    for (Batch &batch : batches_) {
+      num_changed += write_values_(batch);
+
+      for (size_t i = 0; i < batch.slots.size();) {
+        if (batch.elapsed[i] >= batch.duration[i]) {
+          remove_(batch, i);
+        } else {
+          i++;
+        }
+      }
+    }
+
+    return num_changed;
+  }
+
+ private:
+  struct Slot {
+    // incremented once the slot is freed, to invalidate its ids
+    uint32_t generation = 1;
+    uint32_t index = 0;
+    Curve curve = Curve::Linear;
+    bool is_active = false;
+  };
+
+  // the animations of a curve. the elapsed time and duration are in seconds.
+  struct Batch {
+    std::vector<float> from;
+    std::vector<float> to;
+    std::vector<float> elapsed;
+    std::vector<float> duration;
+    std::vector<float> value;
+    std::vector<AnimationTarget> targets;
+    std::vector<uint32_t> slots;
+  };
+
+  static AnimationId make_id_(uint32_t slot, uint32_t generation) {
+    return (static_cast<AnimationId>(generation) << 32) | slot;
+  }
+
+  Slot const *find_slot_(AnimationId id) const {
+    uint64_t const slot = id & 0xFFFF'FFFFULL;
+    uint64_t const generation = id >> 32;
+
+    if (slot >= slots_.size()) return nullptr;
+
+    Slot const &found = slots_[slot];
+    if (!found.is_active || found.generation != generation) return nullptr;
+
+    return &found;
+  }
+
+  template <Curve C>
+  static void evaluate_batch_(Batch &batch, float dt) {
+    size_t const size = batch.slots.size();
+    float const *from = batch.from.data();
+    float const *to = batch.to.data();
+    float const *duration = batch.duration.data();
+    float *elapsed = batch.elapsed.data();
+    float *value = batch.value.data();
+
+    for (size_t i = 0; i < size; i++) {
+      float const e = std::min(elapsed[i] + dt, duration[i]);
+      float const t = e / duration[i];
+      elapsed[i] = e;
+      value[i] = e >= duration[i]
+                     ? to[i]
+                     : from[i] + (to[i] - from[i]) * impl::ease<C>(t);
+    }
+  }
+
+  template <size_t... I>
+  void evaluate_batches_(float dt, std::index_sequence<I...>) {
+    (evaluate_batch_<static_cast<Curve>(I)>(batches_[I], dt), ...);
+  }
+
+  static size_t write_values_(Batch &batch) {
+    size_t num_changed = 0;
+
+    for (size_t i = 0; i < batch.slots.size(); i++) {
+      AnimationTarget const &target = batch.targets[i];
+      if (*target.value == batch.value[i]) continue;
+
+      *target.value = batch.value[i];
+      num_changed++;
+
+      if (target.dirtiness != WidgetDirtiness::None) {
+        target.widget->add_dirtiness(target.dirtiness);
+      }
+    }
+
+    return num_changed;
+  }
+
+  // swaps the last animation of the batch into the removed one's place
+  void remove_(Batch &batch, size_t index) {
+    Slot &slot = slots_[batch.slots[index]];
+    slot.is_active = false;
+    slot.generation++;
+    free_slots_.push_back(batch.slots[index]);
+
+    size_t const last = batch.slots.size() - 1;
+
+    if (index != last) {
+      batch.from[index] = batch.from[last];
+      batch.to[index] = batch.to[last];
+      batch.elapsed[index] = batch.elapsed[last];
+      batch.duration[index] = batch.duration[last];
+      batch.value[index] = batch.value[last];
+      batch.targets[index] = batch.targets[last];
+      batch.slots[index] = batch.slots[last];
+      slots_[batch.slots[index]].index = static_cast<uint32_t>(index);
+    }
+
+    batch.from.pop_back();
+    batch.to.pop_back();
+    batch.elapsed.pop_back();
+    batch.duration.pop_back();
+    batch.value.pop_back();
+    batch.targets.pop_back();
+    batch.slots.pop_back();
+  }
+
+  std::array<Batch, kNumCurves> batches_;
+  std::vector<Slot> slots_;
+  std::vector<uint32_t> free_slots_;
+};
+
+}  // namespace ui
+}  // namespace vlk
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <string>
@@ -42,6 +43,7 @@ struct AppCfg {
 };
 
 struct Pipeline;
+struct RenderThread;
 struct VkRenderContext;
 
 struct Version {
@@ -76,14 +78,26 @@ struct App {
   bool should_quit = false;
   // used for rendering and presentation
   std::shared_ptr<VkRenderContext> vk_render_context;
-  std::unique_ptr<Pipeline> pipeline;
+  // the pipeline unbinds the widgets on destruction, so it must be destroyed
+  // before the root widget
   std::unique_ptr<Widget> root_widget;
+  std::unique_ptr<Pipeline> pipeline;
+  // rasterizes and presents the frames recorded by the pipeline. it uses the
+  // window and the render context, so it must be destroyed before them.
+  std::unique_ptr<RenderThread> render_thread;
+  // set by the render thread once it had to recreate the swapchain
+  std::atomic<bool> swapchain_recreated{false};
   std::unique_ptr<spdlog::logger> logger;
   uint32_t present_refresh_rate_hz = 0;
+  std::chrono::steady_clock::time_point last_tick_begin{};
 
   AppCfg cfg;
 
   static constexpr EngineCfg engine_cfg{};
+
+  // the wait is bounded so the task scheduler's delayed tasks are still
+  // dispatched whilst idle
+  static constexpr std::chrono::milliseconds kIdleWaitTimeout{250};
 };
 
 }  // namespace ui
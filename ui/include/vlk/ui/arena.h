@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "stx/allocator.h"
+#include "stx/result.h"
+#include "stx/struct.h"
+
+namespace vlk {
+namespace ui {
+
+// a region (bump) allocator. allocations are carved out of large chunks and
+// are only released in bulk, on `reset` or destruction, so building and
+// tearing down a screen doesn't fragment the heap. the chunks are retained
+// across resets, so a screen that is rebuilt with the same (or a smaller)
+// footprint doesn't allocate from the heap at all.
+//
+// deallocating the most recent allocation releases it immediately, other
+// deallocations are no-ops. reallocating the most recent allocation extends
+// it in-place if the chunk has enough space left.
+//
+// NOTE: not thread-safe. all allocations are aligned to
+// `alignof(std::max_align_t)`.
+//
+struct ArenaAllocatorHandle final : public stx::AllocatorHandle {
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+  static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+  explicit ArenaAllocatorHandle(size_t init_chunk_size = kDefaultChunkSize)
+      : chunk_size_{init_chunk_size} {}
+
+  STX_MAKE_PINNED(ArenaAllocatorHandle)
+
+  ~ArenaAllocatorHandle() {
+    for (Chunk const &chunk : chunks_) {
+      ::operator delete(chunk.memory);
+    }
+  }
+
+  virtual stx::Result<void *, stx::AllocError> allocate(size_t size) override {
+    void *memory = bump_(size);
+    if (memory == nullptr) return stx::Err(stx::AllocError::NoMemory);
+    return stx::Ok(static_cast<void *>(memory));
+  }
+
+  virtual stx::Result<void *, stx::AllocError> reallocate(
+      void *memory, size_t new_size) override {
+    if (memory == nullptr) return allocate(new_size);
+
+    Header *header = get_header_(memory);
+    size_t const old_size = header->size;
+
+    if (new_size <= old_size) return stx::Ok(static_cast<void *>(memory));
+
+    if (memory == last_) {
+      Chunk const &chunk = chunks_[chunk_index_];
+      size_t const begin = static_cast<char *>(memory) - chunk.memory;
+
+      if (begin + align_(new_size) <= chunk.size) {
+        header->size = new_size;
+        offset_ = begin + align_(new_size);
+        bytes_used_ += new_size - old_size;
+        return stx::Ok(static_cast<void *>(memory));
+      }
+    }
+
+    void *new_memory = bump_(new_size);
+    if (new_memory == nullptr) return stx::Err(stx::AllocError::NoMemory);
+
+    std::memcpy(new_memory, memory, old_size);
+
+    return stx::Ok(static_cast<void *>(new_memory));
+  }
+
+  virtual void deallocate(void *memory) override {
+    if (memory == nullptr || memory != last_) return;
+
+    Chunk const &chunk = chunks_[chunk_index_];
+    bytes_used_ -= get_header_(memory)->size;
+    offset_ = static_cast<char *>(memory) - chunk.memory - kHeaderSize;
+    last_ = nullptr;
+  }
+
+  /// releases all of the allocations at once. the chunks are retained for
+  /// re-use.
+  void reset() {
+    chunk_index_ = 0;
+    offset_ = 0;
+    last_ = nullptr;
+    bytes_used_ = 0;
+    num_allocations_ = 0;
+  }
+
+  /// number of bytes handed out since the last reset
+  size_t get_bytes_used() const { return bytes_used_; }
+
+  /// number of bytes allocated from the heap for the chunks
+  size_t get_bytes_reserved() const {
+    size_t bytes = 0;
+    for (Chunk const &chunk : chunks_) {
+      bytes += chunk.size;
+    }
+    return bytes;
+  }
+
+  /// number of allocations since the last reset
+  size_t get_num_allocations() const { return num_allocations_; }
+
+  size_t get_num_chunks() const { return chunks_.size(); }
+
+ private:
+  struct Chunk {
+    char *memory = nullptr;
+    size_t size = 0;
+  };
+
+  // precedes each allocation, so it can be reallocated
+  struct alignas(kAlignment) Header {
+    size_t size = 0;
+  };
+
+  static constexpr size_t kHeaderSize = sizeof(Header);
+
+  static constexpr size_t align_(size_t offset) {
+    return (offset + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  static Header *get_header_(void *memory) {
+    return reinterpret_cast<Header *>(static_cast<char *>(memory) -
+                                      kHeaderSize);
+  }
+
+  void *bump_(size_t size) {
+    size_t const required = kHeaderSize + align_(size);
+
+    // the chunks retained from before the last reset are re-used in order,
+    // the ones that are too small for the allocation are skipped
+    while (chunk_index_ + 1 < chunks_.size() &&
+           offset_ + required > chunks_[chunk_index_].size) {
+      chunk_index_++;
+      offset_ = 0;
+    }
+
+    if (chunks_.empty() || offset_ + required > chunks_[chunk_index_].size) {
+      size_t const chunk_size = std::max(chunk_size_, required);
+      char *memory =
+          static_cast<char *>(::operator new(chunk_size, std::nothrow));
+      if (memory == nullptr) return nullptr;
+
+      chunks_.push_back(Chunk{memory, chunk_size});
+      chunk_index_ = chunks_.size() - 1;
+      offset_ = 0;
+    }
+
+    char *header = chunks_[chunk_index_].memory + offset_;
+    new (header) Header{size};
+
+    offset_ += required;
+    bytes_used_ += size;
+    num_allocations_++;
+    last_ = header + kHeaderSize;
+
+    return last_;
+  }
+
+  size_t chunk_size_;
+  std::vector<Chunk> chunks_;
+  size_t chunk_index_ = 0;
+  size_t offset_ = 0;
+  void *last_ = nullptr;
+  size_t bytes_used_ = 0;
+  size_t num_allocations_ = 0;
+};
+
+// an arena that owns objects, i.e. a screen's widgets. the objects are
+// destroyed in reverse order of construction, and their memory released in
+// bulk, once the arena is reset or destroyed.
+//
+// the screen's containers (i.e. the widgets' child lists) can be allocated on
+// the arena too, using `ArenaStdAllocator`.
+//
+// NOTE: a widget subtree allocated on the arena must be detached from the
+// pipeline (or the pipeline destroyed) before the arena is reset.
+//
+struct Arena {
+  explicit Arena(size_t chunk_size = ArenaAllocatorHandle::kDefaultChunkSize)
+      : handle_{chunk_size} {}
+
+  STX_MAKE_PINNED(Arena)
+
+  ~Arena() { destroy_objects_(); }
+
+  stx::Allocator get_allocator() { return stx::Allocator{handle_}; }
+
+  ArenaAllocatorHandle &get_handle() { return handle_; }
+
+  ArenaAllocatorHandle const &get_handle() const { return handle_; }
+
+  template <typename T, typename... Args>
+  T *make(Args &&...args) {
+    static_assert(alignof(T) <= ArenaAllocatorHandle::kAlignment,
+                  "over-aligned types can't be allocated on an arena");
+
+    void *memory = handle_.allocate(sizeof(T)).expect(
+        "unable to allocate memory for object on arena");
+
+    T *object = new (memory) T{std::forward<Args>(args)...};
+
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      void *finalizer_memory = handle_.allocate(sizeof(Finalizer)).expect(
+          "unable to allocate memory for finalizer on arena");
+
+      finalizers_ = new (finalizer_memory) Finalizer{
+          object, [](void *ptr) { static_cast<T *>(ptr)->~T(); }, finalizers_};
+    }
+
+    return object;
+  }
+
+  /// destroys all of the objects and releases all of the allocations. the
+  /// memory is retained for re-use.
+  void reset() {
+    destroy_objects_();
+    handle_.reset();
+  }
+
+ private:
+  struct Finalizer {
+    void *object = nullptr;
+    void (*destroy)(void *) = nullptr;
+    Finalizer *next = nullptr;
+  };
+
+  void destroy_objects_() {
+    while (finalizers_ != nullptr) {
+      finalizers_->destroy(finalizers_->object);
+      finalizers_ = finalizers_->next;
+    }
+  }
+
+  ArenaAllocatorHandle handle_;
+  Finalizer *finalizers_ = nullptr;
+};
+
+/// adapts an arena for the standard containers
+template <typename T>
+struct ArenaStdAllocator {
+  using value_type = T;
+
+  explicit ArenaStdAllocator(ArenaAllocatorHandle &init_handle)
+      : handle{&init_handle} {}
+
+  explicit ArenaStdAllocator(Arena &arena) : handle{&arena.get_handle()} {}
+
+  template <typename U>
+  ArenaStdAllocator(ArenaStdAllocator<U> const &other)
+      : handle{other.handle} {}
+
+  T *allocate(size_t n) {
+    static_assert(alignof(T) <= ArenaAllocatorHandle::kAlignment,
+                  "over-aligned types can't be allocated on an arena");
+    return static_cast<T *>(handle->allocate(n * sizeof(T))
+                                .expect("unable to allocate memory on arena"));
+  }
+
+  void deallocate(T *memory, size_t) { handle->deallocate(memory); }
+
+  template <typename U>
+  bool operator==(ArenaStdAllocator<U> const &other) const {
+    return handle == other.handle;
+  }
+
+  template <typename U>
+  bool operator!=(ArenaStdAllocator<U> const &other) const {
+    return handle != other.handle;
+  }
+
+  ArenaAllocatorHandle *handle;
+};
+
+}  // namespace ui
+}  // namespace vlk
@@ -12,7 +12,17 @@ namespace ui {
 /// a wrapper over the Skia canvas
 struct Canvas {
   explicit constexpr Canvas(SkCanvas& canvas, Extent extent, Dpr dpr)
-      : canvas_addr_{&canvas}, extent_{extent}, dpr_{dpr} {}
+      : canvas_addr_{&canvas},
+        extent_{extent},
+        dpr_{dpr},
+        draw_area_{VOffset{0.0f, 0.0f}, virtualize(extent)} {}
+
+  explicit constexpr Canvas(SkCanvas& canvas, Extent extent, Dpr dpr,
+                            VRect draw_area)
+      : canvas_addr_{&canvas},
+        extent_{extent},
+        dpr_{dpr},
+        draw_area_{draw_area} {}
 
   static constexpr Canvas from_skia(SkCanvas& pimpl, Extent extent, Dpr dpr) {
     return Canvas{pimpl, extent, dpr};
@@ -24,10 +34,16 @@ struct Canvas {
 
   Dpr get_device_pixel_ratio() const { return dpr_; }
 
+  /// the portion of the widget being recorded (i.e. its part of the tile
+  /// being recorded), relative to the widget. anything drawn outside of it is
+  /// clipped, so widgets with expensive content can skip drawing it.
+  constexpr VRect draw_area() const { return draw_area_; }
+
  private:
   SkCanvas* canvas_addr_;
   Extent extent_;
   Dpr dpr_;
+  VRect draw_area_;
 };
 
 }  // namespace ui
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <chrono>
+
 #include "vlk/primitives.h"
 
 namespace vlk {
 namespace ui {
 
+// when the event was received from the window system, used for measuring the
+// event-to-present latency and for velocity tracking
+using EventTimestamp = std::chrono::steady_clock::time_point;
+
 enum class MouseButton : uint8_t {
   Primary,
   Secondary,
@@ -27,6 +33,7 @@ struct MouseMotionEvent {
   MouseID mouse_id{};
   IOffset offset;
   IOffset translation;
+  EventTimestamp timestamp{};
 };
 
 struct MouseButtonEvent {
@@ -35,6 +42,16 @@ struct MouseButtonEvent {
   uint32_t clicks = 0;
   MouseButton button = MouseButton::Primary;
   MouseAction action = MouseAction::Press;
+  EventTimestamp timestamp{};
+};
+
+struct MouseWheelEvent {
+  MouseID mouse_id{};
+  // the pointer's position
+  IOffset offset;
+  // the scroll amount, positive away from the user and to the right
+  IOffset translation;
+  EventTimestamp timestamp{};
 };
 
 enum class WindowEvent : uint8_t {
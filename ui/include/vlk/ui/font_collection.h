@@ -0,0 +1,223 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTypeface.h"
+#include "modules/skparagraph/include/FontCollection.h"
+#include "modules/skparagraph/include/ParagraphBuilder.h"
+#include "modules/skparagraph/include/ParagraphStyle.h"
+#include "modules/skparagraph/include/TypefaceFontProvider.h"
+#include "stx/async.h"
+#include "stx/option.h"
+#include "stx/rc.h"
+#include "stx/scheduler.h"
+#include "stx/struct.h"
+#include "vlk/subsystem.h"
+#include "vlk/subsystem/context.h"
+#include "vlk/subsystems/scheduler.h"
+#include "vlk/ui/glyph_cache.h"
+#include "vlk/ui/paragraph_cache.h"
+#include "vlk/utils.h"
+
+namespace vlk {
+namespace ui {
+
+// the font collection shared by all of the text widgets of a pipeline.
+//
+// resolving a paragraph's font families to typefaces (and their fallbacks) is
+// expensive, the skia font collection caches the resolved typefaces, so it is
+// only done once per family and style rather than once per paragraph built.
+// the loaded font assets are registered on the collection's asset font manager
+// once, by their source tag.
+//
+// the paragraphs built with the collection are cached on its paragraph cache,
+// so the text widgets with identical content and style share them. the glyphs
+// of the labels laid out without the paragraph engine are cached on its glyph
+// cache.
+//
+// the paragraphs are shaped on the task scheduler's worker threads (see
+// `shape_async`), unless synchronous shaping is requested, i.e. by tests. the
+// paragraph cache and registrations must only be accessed by the thread that
+// ticks the pipeline.
+//
+struct SharedFontCollection : public Subsystem {
+  struct Stats {
+    // number of distinct typefaces registered
+    size_t num_typefaces = 0;
+    // number of registrations of typefaces that were already registered
+    size_t num_duplicate_registrations = 0;
+    // number of paragraphs built with the collection
+    size_t num_paragraphs_built = 0;
+    // number of times the collection's resolved typefaces were discarded
+    size_t num_cache_clears = 0;
+  };
+
+  SharedFontCollection()
+      : font_provider_{sk_make_sp<skia::textlayout::TypefaceFontProvider>()} {
+    sk_sp<skia::textlayout::FontCollection> collection =
+        sk_make_sp<skia::textlayout::FontCollection>();
+
+    // the paragraphs are cached by the text widgets themselves
+    collection->getParagraphCache()->turnOn(false);
+    collection->setAssetFontManager(font_provider_);
+
+    sk_sp<SkFontMgr> font_mgr = SkFontMgr::RefDefault();
+
+    if (font_mgr != nullptr) {
+      collection->setDefaultFontManager(font_mgr);
+      default_typeface_ = font_mgr->legacyMakeTypeface(nullptr, SkFontStyle{});
+    }
+
+    shaping_context_ = std::make_shared<ShapingContext>(std::move(collection));
+  }
+
+  STX_MAKE_PINNED(SharedFontCollection)
+
+  ~SharedFontCollection() override {}
+
+  virtual void link(SubsystemsContext const &context) override {
+    stx::Rc<Subsystem *> scheduler_subsystem =
+        context.get("VLK_TaskScheduler")
+            .expect("Unable to find task scheduler subsystem");
+
+    scheduler_ = stx::Some(stx::transmute(
+        scheduler_subsystem.handle->as<TaskScheduler>().unwrap(),
+        std::move(scheduler_subsystem)));
+
+    waker_ = context.get_waker();
+  }
+
+  virtual void tick(std::chrono::nanoseconds) override {}
+
+  virtual stx::FutureAny get_future() override {
+    return stx::FutureAny{
+        stx::make_promise<void>(stx::os_allocator).unwrap().get_future()};
+  }
+
+  // registers the typeface as the font family `tag`. returns false if the tag
+  // is already registered.
+  bool register_typeface(std::string_view tag, sk_sp<SkTypeface> typeface) {
+    VLK_ENSURE(typeface != nullptr, "Registering a null typeface");
+
+    auto const [iter, is_new] =
+        typefaces_.emplace(std::string{tag}, std::move(typeface));
+
+    if (!is_new) {
+      stats_.num_duplicate_registrations++;
+      return false;
+    }
+
+    {
+      std::lock_guard lock{shaping_context_->mutex};
+
+      font_provider_->registerTypeface(iter->second,
+                                       SkString{tag.data(), tag.size()});
+
+      // the family might have previously been resolved to a fallback typeface
+      // whilst the font was loading, the paragraphs shaped with it are stale
+      shaping_context_->collection->clearCaches();
+    }
+
+    paragraph_cache_.clear();
+    stats_.num_typefaces++;
+    stats_.num_cache_clears++;
+
+    return true;
+  }
+
+  bool has_typeface(std::string_view tag) const {
+    return typefaces_.find(tag) != typefaces_.end();
+  }
+
+  // the paragraphs aren't cached, see `get_paragraph_cache`.
+  //
+  // NOTE: the paragraph must be built and laid out with the shaping context's
+  // mutex held whilst background shaping tasks might be running.
+  std::unique_ptr<skia::textlayout::ParagraphBuilder> make_paragraph_builder(
+      skia::textlayout::ParagraphStyle const &paragraph_style) {
+    return shaping_context_->make_paragraph_builder(paragraph_style);
+  }
+
+  sk_sp<skia::textlayout::FontCollection> const &get() const {
+    return shaping_context_->collection;
+  }
+
+  std::shared_ptr<ShapingContext> const &get_shaping_context() const {
+    return shaping_context_;
+  }
+
+  ParagraphCache &get_paragraph_cache() { return paragraph_cache_; }
+
+  GlyphCache &get_glyph_cache() { return glyph_cache_; }
+
+  // the typeface the text is laid out with until its font is loaded, null if
+  // the platform has no font manager
+  sk_sp<SkTypeface> const &get_default_typeface() const {
+    return default_typeface_;
+  }
+
+  // the collection is only shaped asynchronously once it is linked to a task
+  // scheduler
+  bool is_shaping_synchronous() const {
+    return is_shaping_synchronous_ || scheduler_.is_none();
+  }
+
+  void set_shaping_synchronous(bool is_synchronous) {
+    is_shaping_synchronous_ = is_synchronous;
+  }
+
+  // runs `shape` with the shaping context on the task scheduler's worker
+  // threads. `shape` must lock the context whilst using it. the event loop is
+  // woken up once it completes.
+  template <typename ShapeFn>
+  auto shape_async(ShapeFn shape) {
+    VLK_ENSURE(scheduler_.is_some(), "Font collection is not linked");
+
+    return scheduler_.value().handle->fn_and_wake(
+        [shape_ = std::move(shape), shaping_context_ = shaping_context_]() {
+          return shape_(shaping_context_);
+        },
+        waker_,
+        stx::TaskTraceInfo{
+            stx::string::rc::make_static_view("FontCollection"),
+            stx::string::rc::make_static_view("ShapeParagraph")});
+  }
+
+  Stats get_stats() const {
+    Stats stats = stats_;
+    stats.num_paragraphs_built =
+        shaping_context_->num_paragraphs_built.load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  // the collection used by the text widgets that aren't yet bound to a
+  // pipeline. it is never linked, so it shapes synchronously.
+  static SharedFontCollection &unbound() {
+    static SharedFontCollection collection;
+    return collection;
+  }
+
+ private:
+  std::shared_ptr<ShapingContext> shaping_context_;
+  sk_sp<skia::textlayout::TypefaceFontProvider> font_provider_;
+  std::map<std::string, sk_sp<SkTypeface>, std::less<>> typefaces_;
+  ParagraphCache paragraph_cache_;
+  GlyphCache glyph_cache_;
+  sk_sp<SkTypeface> default_typeface_;
+  stx::Option<stx::Rc<TaskScheduler *>> scheduler_ = stx::None;
+  std::shared_ptr<EventLoopWaker> waker_;
+  bool is_shaping_synchronous_ = false;
+  Stats stats_;
+};
+
+}  // namespace ui
+}  // namespace vlk
@@ -34,6 +34,8 @@ struct FutureAwaiter {
     }
   }
 
+  bool is_pending() const { return state_ == State::Pending; }
+
   stx::Future<T> future_;
 
   // i.e. call Widget::mark_render_dirty() once image is loaded
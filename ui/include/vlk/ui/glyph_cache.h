@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "include/core/SkFont.h"
+#include "include/core/SkFontMetrics.h"
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTypeface.h"
+#include "include/core/SkTypes.h"
+
+namespace vlk {
+namespace ui {
+
+struct Glyph {
+  // 0 if the typeface has no glyph for the code point
+  SkGlyphID id = 0;
+  float advance = 0.0f;
+};
+
+// the glyphs and advances of the code points of a font (a typeface at a size),
+// resolved from the typeface once.
+struct FontGlyphs {
+  explicit FontGlyphs(SkFont init_font) : font{std::move(init_font)} {
+    font.getMetrics(&metrics);
+  }
+
+  // looks up the code point's glyph, resolving it if it isn't yet
+  Glyph get(SkUnichar code_point) {
+    if (code_point >= 0 && code_point < kNumAsciiGlyphs) {
+      Glyph& glyph = ascii_glyphs_[code_point];
+      if (!ascii_resolved_[code_point]) {
+        glyph = resolve_(code_point);
+        ascii_resolved_[code_point] = true;
+      }
+      return glyph;
+    }
+
+    auto const iter = glyphs_.find(code_point);
+    if (iter != glyphs_.end()) return iter->second;
+
+    Glyph const glyph = resolve_(code_point);
+    glyphs_.emplace(code_point, glyph);
+    return glyph;
+  }
+
+  size_t get_num_resolved() const { return num_resolved_; }
+
+  SkFont font;
+  SkFontMetrics metrics{};
+
+ private:
+  static constexpr SkUnichar kNumAsciiGlyphs = 128;
+
+  Glyph resolve_(SkUnichar code_point) {
+    Glyph glyph;
+    glyph.id = font.unicharToGlyph(code_point);
+    font.getWidths(&glyph.id, 1, &glyph.advance);
+    num_resolved_++;
+    return glyph;
+  }
+
+  // the ascii glyphs are looked up by most labels, they are indexed directly
+  std::array<Glyph, kNumAsciiGlyphs> ascii_glyphs_{};
+  std::array<bool, kNumAsciiGlyphs> ascii_resolved_{};
+  std::unordered_map<SkUnichar, Glyph> glyphs_;
+  size_t num_resolved_ = 0;
+};
+
+// a cache of the fonts' glyphs and advances, shared by the labels measured and
+// drawn without the paragraph engine. resolving a glyph and its advance from
+// the typeface is expensive, so it is only done once per font and code point
+// rather than once per label laid out.
+//
+// the fonts are keyed by their typeface's unique id and size. the typeface is
+// retained by the cached font, so its id isn't reused whilst cached.
+//
+// NOTE: not thread-safe, it is only accessed by the thread that ticks the
+// pipeline.
+//
+struct GlyphCache {
+  struct Stats {
+    // number of fonts cached
+    size_t num_fonts = 0;
+    // number of code points resolved from the typefaces
+    size_t num_glyphs_resolved = 0;
+  };
+
+  // the typeface may be null, in which case skia's default typeface is used
+  FontGlyphs& get(sk_sp<SkTypeface> const& typeface, float font_size) {
+    SkTypefaceID const typeface_id =
+        typeface == nullptr ? 0 : typeface->uniqueID();
+
+    auto iter = fonts_.find(Key{typeface_id, font_size});
+
+    if (iter == fonts_.end()) {
+      SkFont font{typeface, font_size};
+      // the advances are positioned at subpixel precision, as skparagraph
+      // positions them
+      font.setSubpixel(true);
+      font.setEdging(SkFont::Edging::kAntiAlias);
+      font.setHinting(SkFontHinting::kSlight);
+      iter = fonts_.emplace(Key{typeface_id, font_size}, FontGlyphs{font})
+                 .first;
+    }
+
+    return iter->second;
+  }
+
+  Stats get_stats() const {
+    Stats stats;
+    stats.num_fonts = fonts_.size();
+    for (auto const& [key, glyphs] : fonts_) {
+      stats.num_glyphs_resolved += glyphs.get_num_resolved();
+    }
+    return stats;
+  }
+
+  void clear() { fonts_.clear(); }
+
+ private:
+  using Key = std::pair<SkTypefaceID, float>;
+
+  std::map<Key, FontGlyphs> fonts_;
+};
+
+}  // namespace ui
+}  // namespace vlk
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace vlk {
+namespace ui {
+
+// counts of the allocations made through the global `operator new` (and thus
+// the standard containers and `new`-expressions). used to verify that
+// steady-state frames don't allocate from the heap.
+//
+// the counters are only maintained by programs that link the
+// `vlk_ui_heap_stats` library, which replaces the global allocation
+// functions. allocations made directly through `malloc` (i.e. by
+// `stx::os_allocator`) are not counted.
+struct HeapStats {
+  uint64_t num_allocations = 0;
+  uint64_t num_deallocations = 0;
+  uint64_t bytes_allocated = 0;
+
+  HeapStats since(HeapStats const &start) const {
+    return HeapStats{num_allocations - start.num_allocations,
+                     num_deallocations - start.num_deallocations,
+                     bytes_allocated - start.bytes_allocated};
+  }
+};
+
+/// the counts since the program started, across all threads
+HeapStats get_heap_stats();
+
+}  // namespace ui
+}  // namespace vlk
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "vlk/primitives.h"
+#include "vlk/ui/view_tree.h"
+
+namespace vlk {
+namespace ui {
+
+// spatial index used for dispatching pointer events to the widgets beneath
+// the pointer without walking the widget tree.
+//
+// the view tree's screen space is divided into a uniform grid of cells, each
+// cell holds the entries whose visible (clipped) area overlaps it, sorted in
+// descending paint order. hit-testing a point thus only requires visiting the
+// entries of a single cell, topmost first.
+//
+// the paint order follows the tile cache's: compositing layers are painted
+// above the root layer in the order they appear on the view tree, and the
+// entries within a layer are painted in ascending z-index order.
+//
+// the entries whose clip rect changed on a view tree tick (i.e. by scrolling)
+// are moved to their new cells incrementally, or all of the entries are
+// re-bucketed if many changed. the paint order is only re-computed when the
+// index is rebuilt.
+//
+// NOTE: layer effects (transforms, opacity, and clips) are not considered,
+// entries are hit-tested using their untransformed screen rects.
+//
+struct HitTestIndex {
+  // maximum number of cells, the cells are enlarged for large screen spaces
+  static constexpr size_t kMaxCells = 1 << 16;
+
+  // minimum logical extent of a cell
+  static constexpr uint32_t kMinCellExtent = 128;
+
+  ViewTree const *view_tree = nullptr;
+
+  // paint rank of each entry, entries with higher ranks are painted above
+  // those with lower ranks
+  std::vector<size_t> paint_ranks;
+
+  // the rect each entry was last indexed with
+  std::vector<IRect> indexed_rects;
+
+  // the screen area covered by the cells
+  IRect bounds;
+
+  uint32_t cell_extent = kMinCellExtent;
+  int64_t columns = 0;
+  int64_t rows = 0;
+
+  // row-major, entry indices sorted in descending paint rank
+  std::vector<std::vector<size_t>> cells;
+
+  // number of times the entries' paint order was computed, only on
+  // re-indexing after a view tree build or splice
+  size_t num_paint_order_sorts = 0;
+
+  // re-indexes all of the entries, their paint order included. the view
+  // tree's offsets must have been cleaned.
+  void build(ViewTree const &tree) {
+    view_tree = &tree;
+    rank_();
+    rebucket_();
+  }
+
+  // moves the entries that changed on the last view tree tick to their new
+  // cells. the entries' paint order only changes when the view tree is
+  // rebuilt, so it is retained.
+  void update() {
+    if (view_tree == nullptr) return;
+
+    if (paint_ranks.size() != view_tree->entries.size()) {
+      build(*view_tree);
+      return;
+    }
+
+    std::vector<size_t> const &changed = view_tree->changed_entries;
+
+    // the covered area changed (i.e. on layout), or it is cheaper to
+    // re-bucket all of the entries (i.e. whilst scrolling a large list)
+    if (view_tree->root_view().clip_rect != bounds ||
+        changed.size() > view_tree->entries.size() / 4) {
+      rebucket_();
+      return;
+    }
+
+    for (size_t index : changed) {
+      auto const is_above = [this](size_t a, size_t b) {
+        return paint_ranks[a] > paint_ranks[b];
+      };
+
+      for_each_cell_(indexed_rects[index], [&](std::vector<size_t> &cell) {
+        auto const pos =
+            std::lower_bound(cell.begin(), cell.end(), index, is_above);
+        if (pos != cell.end() && *pos == index) cell.erase(pos);
+      });
+
+      IRect const &rect = view_tree->entries[index].clip_rect;
+      indexed_rects[index] = rect;
+
+      for_each_cell_(rect, [&](std::vector<size_t> &cell) {
+        cell.insert(std::lower_bound(cell.begin(), cell.end(), index, is_above),
+                    index);
+      });
+    }
+  }
+
+  // calls `visitor` with the entries containing `point` (in screen
+  // coordinates) in descending paint order, until it returns true. returns
+  // whether any call returned true.
+  template <typename Visitor>
+  bool hit_test(IOffset const &point, Visitor &&visitor) const {
+    if (view_tree == nullptr || !bounds.visible()) return false;
+
+    IOffset const relative = point - bounds.offset;
+
+    if (relative.x < 0 || relative.y < 0) return false;
+
+    int64_t const column = relative.x / cell_extent;
+    int64_t const row = relative.y / cell_extent;
+
+    if (column >= columns || row >= rows) return false;
+
+    for (size_t index : cells[row * columns + column]) {
+      ViewTree::Entry const &entry = view_tree->entries[index];
+      if (contains_(entry.clip_rect, point) && visitor(entry)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // the topmost entry containing `point`, if any
+  ViewTree::Entry const *hit_test(IOffset const &point) const {
+    ViewTree::Entry const *hit = nullptr;
+
+    hit_test(point, [&hit](ViewTree::Entry const &entry) {
+      hit = &entry;
+      return true;
+    });
+
+    return hit;
+  }
+
+ private:
+  static bool contains_(IRect const &rect, IOffset const &point) {
+    return point.x >= rect.offset.x && point.y >= rect.offset.y &&
+           point.x < rect.offset.x + static_cast<int64_t>(rect.extent.width) &&
+           point.y < rect.offset.y + static_cast<int64_t>(rect.extent.height);
+  }
+
+  // computes the entries' paint order and ranks
+  void rank_() {
+    ViewTree const &tree = *view_tree;
+    size_t const num_entries = tree.entries.size();
+
+    // rank of each view's content layer
+    std::vector<size_t> &layer_ranks = layer_ranks_;
+    layer_ranks.clear();
+    layer_ranks.resize(tree.views.size(), 0);
+    size_t num_layers = 0;
+
+    for (size_t index = 0; index < tree.views.size(); index++) {
+      ViewTree::View const &view = tree.views[index];
+      if (view.content_layer == index) {
+        num_layers++;
+        layer_ranks[index] = num_layers;
+      } else if (view.content_layer != ViewTree::kNoView) {
+        layer_ranks[index] = layer_ranks[view.content_layer];
+      }
+    }
+
+    std::vector<size_t> &paint_order = paint_order_;
+    paint_order.resize(num_entries);
+
+    for (size_t i = 0; i < num_entries; i++) {
+      paint_order[i] = i;
+    }
+
+    auto const layer_rank = [&](ViewTree::Entry const &entry) {
+      return entry.layer == ViewTree::kNoView ? 0 : layer_ranks[entry.layer];
+    };
+
+    // the entries are ordered by their index within the same layer and
+    // z-index. this is what a stable sort would do, without its temporary
+    // buffer.
+    std::sort(paint_order.begin(), paint_order.end(), [&](size_t a, size_t b) {
+      ViewTree::Entry const &entry_a = tree.entries[a];
+      ViewTree::Entry const &entry_b = tree.entries[b];
+      size_t const layer_a = layer_rank(entry_a);
+      size_t const layer_b = layer_rank(entry_b);
+      if (layer_a != layer_b) return layer_a < layer_b;
+      if (entry_a.z_index != entry_b.z_index) {
+        return entry_a.z_index < entry_b.z_index;
+      }
+      return a < b;
+    });
+
+    paint_ranks.resize(num_entries);
+
+    for (size_t rank = 0; rank < num_entries; rank++) {
+      paint_ranks[paint_order[rank]] = rank;
+    }
+
+    num_paint_order_sorts++;
+  }
+
+  // re-inserts all of the entries into the cells, in their retained paint
+  // order
+  void rebucket_() {
+    size_t const num_entries = view_tree->entries.size();
+
+    resize_cells_();
+
+    indexed_rects.clear();
+    indexed_rects.resize(num_entries, IRect{});
+
+    // inserting in descending paint order keeps the cells sorted
+    for (size_t rank = num_entries; rank > 0; rank--) {
+      size_t const index = paint_order_[rank - 1];
+      IRect const &rect = view_tree->entries[index].clip_rect;
+      indexed_rects[index] = rect;
+      for_each_cell_(rect, [&](std::vector<size_t> &cell) {
+        cell.push_back(index);
+      });
+    }
+  }
+
+  void resize_cells_() {
+    bounds = view_tree->root_view().clip_rect;
+
+    cell_extent = kMinCellExtent;
+
+    auto const num_cells_along = [](uint32_t extent, uint32_t cell) {
+      return (static_cast<int64_t>(extent) + cell - 1) / cell;
+    };
+
+    while (static_cast<uint64_t>(
+               num_cells_along(bounds.extent.width, cell_extent)) *
+               num_cells_along(bounds.extent.height, cell_extent) >
+           kMaxCells) {
+      cell_extent *= 2;
+    }
+
+    columns = num_cells_along(bounds.extent.width, cell_extent);
+    rows = num_cells_along(bounds.extent.height, cell_extent);
+
+    // the cells retain their capacity across re-indexing
+    cells.resize(columns * rows);
+
+    for (std::vector<size_t> &cell : cells) {
+      cell.clear();
+    }
+  }
+
+  template <typename Fn>
+  void for_each_cell_(IRect const &rect, Fn &&fn) {
+    if (!rect.visible() || !bounds.visible() || !bounds.overlaps(rect)) return;
+
+    IRect const area = bounds.intersect(rect);
+    IOffset const begin = area.offset - bounds.offset;
+
+    int64_t const column_begin = begin.x / cell_extent;
+    int64_t const row_begin = begin.y / cell_extent;
+    int64_t const column_end = std::min<int64_t>(
+        columns, (begin.x + area.extent.width + cell_extent - 1) / cell_extent);
+    int64_t const row_end = std::min<int64_t>(
+        rows, (begin.y + area.extent.height + cell_extent - 1) / cell_extent);
+
+    for (int64_t row = row_begin; row < row_end; row++) {
+      for (int64_t column = column_begin; column < column_end; column++) {
+        fn(cells[row * columns + column]);
+      }
+    }
+  }
+
+  // retained across re-indexing to avoid re-allocating
+  std::vector<size_t> layer_ranks_;
+  std::vector<size_t> paint_order_;
+};
+
+}  // namespace ui
+}  // namespace vlk
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cmath>
+#include <utility>
+
+#include "stx/option.h"
+#include "vlk/primitives.h"
+
+namespace vlk {
+namespace ui {
+
+/// a 2D affine transform. maps a point (x, y) to:
+/// (scale_x * x + skew_x * y + translate_x,
+///  skew_y * x + scale_y * y + translate_y)
+struct Transform2D {
+  float scale_x = 1.0f;
+  float skew_x = 0.0f;
+  float translate_x = 0.0f;
+  float skew_y = 0.0f;
+  float scale_y = 1.0f;
+  float translate_y = 0.0f;
+
+  static constexpr Transform2D identity() { return Transform2D{}; }
+
+  static constexpr Transform2D translation(float x, float y) {
+    return Transform2D{1.0f, 0.0f, x, 0.0f, 1.0f, y};
+  }
+
+  static constexpr Transform2D scaling(float x, float y) {
+    return Transform2D{x, 0.0f, 0.0f, 0.0f, y, 0.0f};
+  }
+
+  static constexpr Transform2D skewing(float x, float y) {
+    return Transform2D{1.0f, x, 0.0f, y, 1.0f, 0.0f};
+  }
+
+  /// rotates clockwise by `radians`
+  static Transform2D rotation(float radians) {
+    float const cos = std::cos(radians);
+    float const sin = std::sin(radians);
+    return Transform2D{cos, -sin, 0.0f, sin, cos, 0.0f};
+  }
+
+  /// the transform that applies `this` and then `next`
+  constexpr Transform2D then(Transform2D const &next) const {
+    return Transform2D{
+        next.scale_x * scale_x + next.skew_x * skew_y,
+        next.scale_x * skew_x + next.skew_x * scale_y,
+        next.scale_x * translate_x + next.skew_x * translate_y +
+            next.translate_x,
+        next.skew_y * scale_x + next.scale_y * skew_y,
+        next.skew_y * skew_x + next.scale_y * scale_y,
+        next.skew_y * translate_x + next.scale_y * translate_y +
+            next.translate_y};
+  }
+
+  constexpr bool is_identity() const { return *this == identity(); }
+
+  constexpr bool operator==(Transform2D const &other) const {
+    return scale_x == other.scale_x && skew_x == other.skew_x &&
+           translate_x == other.translate_x && skew_y == other.skew_y &&
+           scale_y == other.scale_y && translate_y == other.translate_y;
+  }
+
+  constexpr bool operator!=(Transform2D const &other) const {
+    return !(*this == other);
+  }
+};
+
+/// effects applied to a layer's content when it is composited. updating them
+/// doesn't require re-recording nor re-rasterizing the layer's content, so
+/// they are suited for fades, slides, and scale animations.
+///
+/// all dimensions are in logical coordinates and relative to the layer view's
+/// top-left corner.
+struct LayerEffects {
+  /// in [0.0, 1.0]
+  float opacity = 1.0f;
+
+  Transform2D transform{};
+
+  /// clips the view (before it is transformed). the view is always clipped to
+  /// its own extent.
+  stx::Option<IRect> clip = stx::None;
+
+  LayerEffects with_opacity(float new_opacity) const {
+    LayerEffects out{*this};
+    out.opacity = new_opacity;
+    return out;
+  }
+
+  LayerEffects with_transform(Transform2D const &new_transform) const {
+    LayerEffects out{*this};
+    out.transform = new_transform;
+    return out;
+  }
+
+  LayerEffects with_clip(stx::Option<IRect> new_clip) const {
+    LayerEffects out{*this};
+    out.clip = std::move(new_clip);
+    return out;
+  }
+
+  bool operator==(LayerEffects const &other) const {
+    if (opacity != other.opacity || transform != other.transform) return false;
+    if (clip.is_some() != other.clip.is_some()) return false;
+    return clip.is_none() || clip.value() == other.clip.value();
+  }
+
+  bool operator!=(LayerEffects const &other) const {
+    return !(*this == other);
+  }
+};
+
+}  // namespace ui
+}  // namespace vlk
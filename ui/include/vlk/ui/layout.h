@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cmath>
 #include <cstdint>
+#include <limits>
 #include <numeric>
 #include <variant>
 
@@ -62,6 +64,14 @@ struct Constrain {
     return Constrain{0.0f, value};
   }
 
+  /// an absolute value that isn't clamped to the parent allotted extent. only
+  /// valid in unconstrained contexts, i.e. a view's extent along the axes its
+  /// content can grow unboundedly.
+  static constexpr Constrain unbounded(int64_t value) {
+    return Constrain{0.0f, value, stx::i64_min, stx::i64_max,
+                     Clamp{0.0f, std::numeric_limits<float>::infinity()}};
+  }
+
   int64_t resolve(int64_t source, bool is_restricted) const {
     VLK_ENSURE(max >= min);
     VLK_ENSURE(scale >= 0.0f);
@@ -79,7 +89,9 @@ struct Constrain {
     int64_t const value_i64 = static_cast<int64_t>(scale * source) + bias;
     int64_t const value = std::clamp(value_i64, min, max);
     auto const min = static_cast<int64_t>(clamp.min * source);
-    auto const max = static_cast<int64_t>(clamp.max * source);
+    auto const max = std::isinf(clamp.max)
+                         ? stx::i64_max
+                         : static_cast<int64_t>(clamp.max * source);
 
     return std::clamp(value, min, max);
   }
@@ -187,6 +199,16 @@ struct ViewOffset {
     return ViewOffset::absolute(offset.x, offset.y);
   }
 
+  /// the view offset translates the view's content, scrolling forward thus
+  /// translates the content backwards. i.e. scrolling down by 20px translates
+  /// the view's content by -20px. the translation is clamped to the view
+  /// extent.
+  static constexpr ViewOffset scroll(int64_t x, int64_t y) {
+    return ViewOffset{
+        Constrain{0.0f, -x, stx::i64_min, stx::i64_max, Clamp{-1.0f, 0.0f}},
+        Constrain{0.0f, -y, stx::i64_min, stx::i64_max, Clamp{-1.0f, 0.0f}}};
+  }
+
   IOffset resolve(Extent const& content_extent) const {
     return IOffset{x.resolve(content_extent.width, false),
                    y.resolve(content_extent.height, false)};
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <chrono>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include "stx/span.h"
@@ -169,13 +170,6 @@ struct LayoutTree {
       parent_view_offset = Offset{};
       view_extent = Extent{};
 
-      // NOTE: allocates memory, we might need an extra step to bind the lambda
-      // references if we want to utilize cache to the max
-      WidgetSystemProxy::get_state_proxy(in_widget).on_layout_dirty =
-          stx::fn::rc::make_functor(stx::os_allocator, [&tree] {
-            tree.is_layout_dirty = true;
-          }).unwrap();
-
       size_t const num_children = in_widget.get_children().size();
 
       // note that we are not releasing the memory used by the
@@ -190,6 +184,57 @@ struct LayoutTree {
         children[i].build(*in_widget.get_children()[i], tree);
       }
     }
+
+    // same as `build`, but re-uses the nodes of the children that persisted
+    // (matched by widget) along with their subtrees, so reordering or
+    // filtering the children doesn't re-build nor re-allocate the subtrees of
+    // the unchanged children. the layout is still re-computed.
+    void reconcile(Widget &in_widget, LayoutTree &tree) {
+      widget = &in_widget;
+      type = widget->get_type();
+
+      stx::Span<Widget *const> const new_children = in_widget.get_children();
+      size_t const num_children = new_children.size();
+
+      bool const same_children =
+          children.size() == num_children &&
+          std::equal(children.begin(), children.end(), new_children.begin(),
+                     [](Node const &child, Widget *child_widget) {
+                       return child.widget == child_widget;
+                     });
+
+      if (!same_children) {
+        std::vector<Node> previous = std::move(children);
+        children.clear();
+        children.resize(num_children, Node{});
+
+        auto &sorted = tree.reconcile_scratch_;
+        sorted.clear();
+
+        for (size_t i = 0; i < previous.size(); i++) {
+          sorted.emplace_back(previous[i].widget, i);
+        }
+
+        std::sort(sorted.begin(), sorted.end());
+
+        for (size_t i = 0; i < num_children; i++) {
+          auto const match = std::lower_bound(
+              sorted.begin(), sorted.end(),
+              std::make_pair(new_children[i], static_cast<size_t>(0)));
+
+          if (match != sorted.end() && match->first == new_children[i] &&
+              previous[match->second].widget != nullptr) {
+            children[i] = std::move(previous[match->second]);
+            // a widget appearing twice only re-uses its node once
+            previous[match->second].widget = nullptr;
+          }
+        }
+      }
+
+      for (size_t i = 0; i < num_children; i++) {
+        children[i].reconcile(*new_children[i], tree);
+      }
+    }
   };
 
   LayoutTree() = default;
@@ -296,6 +341,33 @@ struct LayoutTree {
         // correctness purpose
         node.view_extent = node.self_extent;
       }
+    } else if (widget.places_children()) {
+      auto const [content_rect, resolved_padding] = resolve_content_rect(
+          type == WidgetType::View ? resolved_view_extent
+                                   : resolved_self_extent,
+          padding);
+
+      // the widget computes the placement of each child directly, so there's
+      // no need to visit the siblings of a child
+      for (size_t i = 0; i < node.children.size(); i++) {
+        LayoutTree::Node &child = node.children[i];
+        Rect const child_rect =
+            node.widget->get_child_rect(i, content_rect.extent);
+        perform_layout(child, child_rect.extent);
+        child.parent_offset = child_rect.offset + content_rect.offset;
+      }
+
+      if (type == WidgetType::View) {
+        node.view_extent =
+            node.widget->get_children_span(content_rect.extent) +
+            Extent{resolved_padding.left + resolved_padding.right,
+                   resolved_padding.top + resolved_padding.bottom};
+        node.self_extent = view_fit_self_extent(view_fit, resolved_self_extent,
+                                                node.view_extent);
+      } else {
+        node.self_extent = resolved_self_extent;
+        node.view_extent = node.self_extent;
+      }
     } else {
       if (type == WidgetType::View) {
         node.view_extent = resolved_view_extent;
@@ -312,6 +384,8 @@ struct LayoutTree {
         node.view_extent = node.self_extent;
       }
     }
+
+    WidgetSystemProxy::update_layout_extent(*node.widget, node.self_extent);
   }
 
   template <Direction direction>
@@ -611,6 +685,25 @@ struct LayoutTree {
     root_node.build(root_widget, *this);
   }
 
+  // rebuilds the subtree of a node whose widget's children changed. the
+  // addresses of the nodes outside the subtree are preserved. the nodes of the
+  // children that persisted are re-used.
+  void rebuild_subtree(Node &node) {
+    is_layout_dirty = true;
+    node.reconcile(*node.widget, *this);
+  }
+
+  // checks if any of the node's descendants is a view
+  static bool has_nested_views(Node const &node) {
+    for (Node const &child : node.children) {
+      if (child.type == WidgetType::View || has_nested_views(child)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
   void tick(std::chrono::nanoseconds) {
     if (is_layout_dirty) {
       perform_layout(root_node, allotted_extent);
@@ -619,6 +712,11 @@ struct LayoutTree {
       is_layout_dirty = false;
     }
   }
+
+ private:
+  // (widget, index) pairs of a node's previous children, sorted by widget.
+  // only used whilst matching the children of a single node.
+  std::vector<std::pair<Widget *, size_t>> reconcile_scratch_;
 };
 
 }  // namespace ui
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "include/core/SkRefCnt.h"
+#include "modules/skparagraph/include/FontCollection.h"
+#include "modules/skparagraph/include/Paragraph.h"
+#include "modules/skparagraph/include/ParagraphBuilder.h"
+#include "modules/skparagraph/include/ParagraphStyle.h"
+#include "modules/skparagraph/src/ParagraphBuilderImpl.h"
+#include "modules/skparagraph/src/ParagraphImpl.h"
+#include "stx/option.h"
+#include "vlk/ui/layout.h"
+#include "vlk/utils.h"
+
+namespace vlk {
+namespace ui {
+
+// the skia font collection the paragraphs are shaped with. it is shared with
+// the background shaping tasks, so it outlives the subsystem that owns it.
+//
+// skia's font collection isn't thread-safe (it caches the typefaces it resolves
+// as the paragraphs are shaped), so the paragraphs are built and laid out with
+// `mutex` held.
+struct ShapingContext {
+  explicit ShapingContext(
+      sk_sp<skia::textlayout::FontCollection> init_collection)
+      : collection{std::move(init_collection)} {}
+
+  std::unique_ptr<skia::textlayout::ParagraphBuilder> make_paragraph_builder(
+      skia::textlayout::ParagraphStyle const &paragraph_style) {
+    std::unique_ptr<skia::textlayout::ParagraphBuilder> builder =
+        skia::textlayout::ParagraphBuilderImpl::make(paragraph_style,
+                                                     collection);
+    VLK_ENSURE(builder != nullptr);
+    num_paragraphs_built.fetch_add(1, std::memory_order_relaxed);
+    return builder;
+  }
+
+  sk_sp<skia::textlayout::FontCollection> collection;
+  std::mutex mutex;
+  std::atomic<size_t> num_paragraphs_built{0};
+};
+
+// a paragraph shared by the text widgets with identical content and style.
+//
+// the paragraph is drawn at the width of the first widget that draws it. the
+// widgets sharing it that are drawn at other widths draw copies laid out at
+// their widths instead (cached with the width in their keys), so they don't
+// re-lay out the paragraph on each other's draws. it is only re-laid out when
+// a widget measures it at another width, which the widgets cache.
+struct CachedParagraph {
+  std::unique_ptr<skia::textlayout::Paragraph> paragraph;
+
+  // the context the paragraph was built with
+  std::shared_ptr<ShapingContext> shaping_context;
+
+  // width constraint the paragraph is presently laid out at
+  stx::Option<float> laid_out_width = stx::None;
+
+  // width the paragraph is drawn at, claimed by the first widget drawing it
+  stx::Option<float> draw_width = stx::None;
+
+  // measured once the paragraph is built
+  stx::Option<SelfExtent> intrinsic_extent = stx::None;
+
+  // estimated memory used by the paragraph
+  size_t size_bytes = 0;
+
+  // lays out the paragraph at `width`, only if it isn't already laid out at
+  // it. returns the paragraph's height.
+  float layout(float width) {
+    if (laid_out_width.is_none() || laid_out_width.value() != width) {
+      std::lock_guard lock{shaping_context->mutex};
+      paragraph->layout(width);
+      laid_out_width = stx::Some(float{width});
+    }
+
+    return paragraph->getHeight();
+  }
+
+  // forces the paragraph to be laid out again, i.e. once the paints of its
+  // styled blocks are replaced. skparagraph caches the laid-out lines' text
+  // blobs (with their paints) once they are first painted, and whether they
+  // have decorations or backgrounds once the lines are broken.
+  void invalidate_layout() {
+    {
+      std::lock_guard lock{shaping_context->mutex};
+      static_cast<skia::textlayout::ParagraphImpl &>(*paragraph).markDirty();
+    }
+    laid_out_width = stx::None;
+    draw_width = stx::None;
+  }
+
+  // measures the paragraph's intrinsic extent. this shapes the paragraph if it
+  // isn't already.
+  SelfExtent measure() {
+    // perform layout pass to get minimum and maximum width
+    layout(0.0F);
+
+    float const min_intrinsic_width = paragraph->getMinIntrinsicWidth();
+    float const max_intrinsic_width = paragraph->getMaxIntrinsicWidth();
+
+    // perform another layout pass to get the (maximum length, minimum height)
+    // values
+    float const max_intrinsic_height = layout(min_intrinsic_width);
+
+    // perform another layout pass to get the (minimum length, maximum height)
+    // values
+    float const min_intrinsic_height = layout(max_intrinsic_width);
+
+    // we request for max extent but still layout for the given extent.
+    SelfExtent extent{};
+    extent.width.min = static_cast<int64_t>(std::ceil(min_intrinsic_width));
+    extent.width.max = static_cast<int64_t>(std::ceil(max_intrinsic_width));
+    extent.width.bias = extent.width.max;
+
+    extent.height.min = static_cast<int64_t>(std::ceil(min_intrinsic_height));
+    extent.height.max = static_cast<int64_t>(std::ceil(max_intrinsic_height));
+    extent.height.bias = extent.height.min;
+
+    return extent;
+  }
+};
+
+// a least-recently-used cache of the built paragraphs, keyed by their inline
+// texts and resolved text and paragraph props (serialized by the text widget).
+//
+// skia doesn't report the memory a paragraph uses, so it is estimated from the
+// paragraph's content. the least recently used paragraphs are evicted once the
+// estimate exceeds the capacity. evicted paragraphs remain valid for the
+// widgets still using them.
+//
+struct ParagraphCache {
+  static constexpr size_t kDefaultCapacityBytes = 8 << 20;
+
+  // rough estimate of the memory shaping and laying out a UTF-8 code unit of
+  // text uses, i.e. its glyph, cluster, position and line metrics
+  static constexpr size_t kBytesPerCodeUnit = 64;
+
+  struct Stats {
+    size_t num_hits = 0;
+    size_t num_misses = 0;
+    size_t num_evictions = 0;
+    size_t num_entries = 0;
+    size_t size_bytes = 0;
+
+    float hit_rate() const {
+      size_t const num_lookups = num_hits + num_misses;
+      if (num_lookups == 0) return 0.0f;
+      return static_cast<float>(num_hits) / num_lookups;
+    }
+  };
+
+  explicit ParagraphCache(size_t capacity_bytes = kDefaultCapacityBytes)
+      : capacity_bytes_{capacity_bytes} {}
+
+  static size_t estimate_size(std::string const &key, size_t text_size) {
+    return sizeof(CachedParagraph) + sizeof(Entry) + key.size() +
+           text_size * kBytesPerCodeUnit;
+  }
+
+  // returns nullptr if the paragraph isn't cached
+  std::shared_ptr<CachedParagraph> find(std::string const &key) {
+    auto const iter = index_.find(key);
+
+    if (iter == index_.end()) {
+      stats_.num_misses++;
+      return nullptr;
+    }
+
+    stats_.num_hits++;
+    // mark as most recently used
+    entries_.splice(entries_.begin(), entries_, iter->second);
+
+    return iter->second->paragraph;
+  }
+
+  void insert(std::string key, std::shared_ptr<CachedParagraph> paragraph) {
+    VLK_ENSURE(paragraph != nullptr);
+    VLK_ENSURE(index_.find(key) == index_.end(),
+               "Paragraph is already cached");
+
+    size_t const size_bytes = paragraph->size_bytes;
+
+    entries_.push_front(Entry{key, std::move(paragraph)});
+    index_.emplace(std::move(key), entries_.begin());
+
+    stats_.num_entries++;
+    stats_.size_bytes += size_bytes;
+
+    evict_();
+  }
+
+  // checks if `paragraph` is the one cached as `key`, without touching its
+  // recency or the stats
+  bool holds(std::string const &key, CachedParagraph const *paragraph) const {
+    auto const iter = index_.find(key);
+    return iter != index_.end() && iter->second->paragraph.get() == paragraph;
+  }
+
+  void erase(std::string const &key) {
+    auto const iter = index_.find(key);
+    if (iter == index_.end()) return;
+
+    stats_.size_bytes -= iter->second->paragraph->size_bytes;
+    stats_.num_entries--;
+    entries_.erase(iter->second);
+    index_.erase(iter);
+  }
+
+  void clear() {
+    entries_.clear();
+    index_.clear();
+    stats_.num_entries = 0;
+    stats_.size_bytes = 0;
+  }
+
+  void set_capacity(size_t capacity_bytes) {
+    capacity_bytes_ = capacity_bytes;
+    evict_();
+  }
+
+  size_t get_capacity() const { return capacity_bytes_; }
+
+  Stats get_stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<CachedParagraph> paragraph;
+  };
+
+  void evict_() {
+    // the most recently inserted paragraph is retained even if it exceeds the
+    // capacity on its own
+    while (stats_.size_bytes > capacity_bytes_ && entries_.size() > 1) {
+      Entry const &entry = entries_.back();
+      stats_.size_bytes -= entry.paragraph->size_bytes;
+      stats_.num_entries--;
+      stats_.num_evictions++;
+      index_.erase(entry.key);
+      entries_.pop_back();
+    }
+  }
+
+  size_t capacity_bytes_ = kDefaultCapacityBytes;
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  Stats stats_;
+};
+
+}  // namespace ui
+}  // namespace vlk
@@ -1,17 +1,23 @@
 #pragma once
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "vlk/subsystem/context.h"
 #include "vlk/subsystems/asset_loader.h"
 #include "vlk/subsystems/keyboard.h"
 #include "vlk/subsystems/scheduler.h"
+#include "vlk/ui/animation.h"
 #include "vlk/ui/event.h"
+#include "vlk/ui/font_collection.h"
+#include "vlk/ui/hit_test.h"
 #include "vlk/ui/layout.h"
 #include "vlk/ui/layout_tree.h"
 #include "vlk/ui/tile_cache.h"
 #include "vlk/ui/view_tree.h"
 #include "vlk/ui/viewport.h"
 #include "vlk/ui/widget.h"
+#include "vlk/ui/window_event_queue.h"
 
 namespace vlk {
 namespace ui {
@@ -20,25 +26,52 @@ namespace ui {
 // `render_context` and `root_widget` must outlive the pipeline.
 // `tick()` must not be called with either of them deleted.
 struct Pipeline {
-  Widget* root_widget;
+  // a widget whose children changed. `entry` is `ViewTree::kNoView` if the
+  // widget is the view itself.
+  struct ChangedSubtree {
+    // first of the view tree's entries to be replaced
+    size_t begin = 0;
+    size_t view = ViewTree::kNoView;
+    size_t entry = ViewTree::kNoView;
+  };
+
+  Widget* root_widget = nullptr;
   Viewport viewport;
   RenderContext const* render_context;
 
   LayoutTree layout_tree;
   ViewTree view_tree;
   TileCache tile_cache;
+  HitTestIndex hit_test_index;
+  WidgetDirtyQueues dirty_queues;
   bool needs_rebuild = true;
+  bool hit_test_index_needs_rebuild = true;
 
   SubsystemsContext context{};
 
+  // owned by `context`, as "VLK_Animations"
+  AnimationEngine* animations = nullptr;
+
+  // owned by `context`, as "VLK_Keyboard". the key events are dispatched to
+  // its listeners.
+  Keyboard* keyboard = nullptr;
+
+  // owned by `context`, as "VLK_FontCollection". shared by the text widgets.
+  SharedFontCollection* font_collection = nullptr;
+
+  // retained across rebuilds to avoid re-allocating
+  std::vector<ChangedSubtree> changed_subtrees;
+
   Pipeline(Widget& init_root_widget, RenderContext const& init_render_context)
       : root_widget{&init_root_widget}, render_context{&init_render_context} {
-    // pass widget to pipeline => bind on children changed
-    // pass to layout tree => bind on layout changed
-    // pass to view tree => bind on view offset changed
-    // pass to tile_cache => bind on raster dirty
-
-    attach_state_proxies(*root_widget);
+    // on build:
+    // widgets are bound to the pipeline's dirty queues
+    // view tree => binds the view ids
+    // tile_cache => binds the entry ids
+    //
+    // the widgets are bound here so the ones that subscribe to ticks or get
+    // dirty before the first build are ticked on the first frame
+    bind_widgets();
 
     context
         .__register_subsystem(
@@ -55,11 +88,29 @@ struct Pipeline {
                 .unwrap())
         .unwrap();
 
+    stx::Rc<AnimationEngine*> animation_engine =
+        stx::rc::make_inplace<AnimationEngine>(stx::os_allocator).unwrap();
+    animations = animation_engine.handle;
+
+    context.__register_subsystem("VLK_Animations", std::move(animation_engine))
+        .unwrap();
+
+    stx::Rc<Keyboard*> keyboard_subsystem =
+        stx::rc::make_inplace<Keyboard>(stx::os_allocator, stx::os_allocator)
+            .unwrap();
+    keyboard = keyboard_subsystem.handle;
+
+    context.__register_subsystem("VLK_Keyboard", std::move(keyboard_subsystem))
+        .unwrap();
+
+    stx::Rc<SharedFontCollection*> font_collection_subsystem =
+        stx::rc::make_inplace<SharedFontCollection>(stx::os_allocator)
+            .unwrap();
+    font_collection = font_collection_subsystem.handle;
+
     context
-        .__register_subsystem("VLK_Keyboard",
-                              stx::rc::make_inplace<Keyboard>(stx::os_allocator,
-                                                              stx::os_allocator)
-                                  .unwrap())
+        .__register_subsystem("VLK_FontCollection",
+                              std::move(font_collection_subsystem))
         .unwrap();
 
     context.__link();
@@ -80,51 +131,316 @@ struct Pipeline {
   STX_DEFAULT_CONSTRUCTOR(Pipeline)
   STX_MAKE_PINNED(Pipeline)
 
-  void dispatch_events(stx::Span<MouseButtonEvent const> mouse_button_events,
-                       stx::Span<WindowEvent const> window_events) {
-    // TODO(lamarrr): forward events
-    for (auto& event : mouse_button_events) {
-      VLK_LOG("Mouse {}, clicks: {}",
-              event.action == MouseAction::Press ? "Press" : "Release",
-              event.clicks);
+  ~Pipeline() {
+    // the widgets could outlive the pipeline and must not reference its
+    // queues anymore
+    if (root_widget != nullptr) unbind_widgets();
+  }
+
+  // dispatches the pointer event to the widgets beneath it, topmost first,
+  // until one of them consumes it
+  template <typename Event, typename Handler>
+  void dispatch_pointer_event(Event const& event, Handler&& handler) {
+    // the event's offset is relative to the viewport
+    IOffset const point = event.offset + viewport.get_offset();
+
+    hit_test_index.hit_test(point, [&](ViewTree::Entry const& entry) {
+      Event widget_event = event;
+      widget_event.offset = point - entry.screen_offset;
+      return handler(*entry.layout_node->widget, widget_event);
+    });
+  }
+
+  // dispatches the window's input events in their order of arrival. the
+  // earliest of their timestamps is attached to the next recorded frame, for
+  // measuring the event-to-present latency.
+  void dispatch_events(WindowEventQueue const& queue) {
+    for (size_t i = 0; i < queue.input_events.size(); i++) {
+      EventTimestamp const timestamp = get_timestamp(queue.input_events[i]);
+
+      if (!has_pending_input_ || timestamp < pending_input_timestamp_) {
+        pending_input_timestamp_ = timestamp;
+        has_pending_input_ = true;
+      }
+    }
+
+    for (size_t i = 0; i < queue.input_events.size(); i++) {
+      InputEvent const& event = queue.input_events[i];
+
+      // the widgets referenced by the trees could have been deleted since
+      // they were built, i.e. by the previous events' handlers. the pointer
+      // events are dropped until the trees are rebuilt.
+      bool const can_hit_test = !needs_rebuild &&
+                                !hit_test_index_needs_rebuild &&
+                                !dirty_queues.children_changed;
+
+      if (auto const* key = std::get_if<KeyEvent>(&event)) {
+        keyboard->__dispatch(key->keyboard);
+      } else if (!can_hit_test) {
+        continue;
+      } else if (auto const* button = std::get_if<MouseButtonEvent>(&event)) {
+        dispatch_pointer_event(
+            *button, [](Widget& widget, MouseButtonEvent const& widget_event) {
+              return widget.on_mouse_button(widget_event);
+            });
+      } else if (auto const* motion = std::get_if<MouseMotionEvent>(&event)) {
+        dispatch_pointer_event(
+            *motion, [](Widget& widget, MouseMotionEvent const& widget_event) {
+              return widget.on_mouse_motion(widget_event);
+            });
+      } else if (auto const* wheel = std::get_if<MouseWheelEvent>(&event)) {
+        dispatch_pointer_event(
+            *wheel, [](Widget& widget, MouseWheelEvent const& widget_event) {
+              return widget.on_mouse_wheel(widget_event);
+            });
+      }
     }
   }
 
-  void attach_state_proxies(Widget& widget) {
-    WidgetSystemProxy::get_state_proxy(widget).on_children_changed =
-        stx::fn::rc::make_functor(stx::os_allocator, [this] {
-          this->needs_rebuild = true;
-        }).unwrap();
+  void bind_dirty_queues(Widget& widget) {
+    WidgetSystemProxy::bind_dirty_queues(widget, &dirty_queues);
+
+    // widgets that subscribed or got dirty whilst detached
+    if (widget.is_subscribed_to_ticks() ||
+        widget.get_dirtiness() != WidgetDirtiness::None) {
+      WidgetSystemProxy::activate(widget);
+    }
 
     for (Widget* child : widget.get_children()) {
-      attach_state_proxies(*child);
+      bind_dirty_queues(*child);
     }
   }
 
-  void recursive_tick(Widget& widget, std::chrono::nanoseconds interval) {
-    // child will be removed as necessary from the tick callback. of course we
-    // assume that the children have been deleted by the parent so there's no
-    // need to detach the previously attached state proxies. this also means we
-    // can't touch the previous children we got. this also implies that a
-    // detached child must not use its state proxy callbacks or have its
-    // `system_tick` method called unless its state proxies have been updated.
+  void unbind_active_widgets() {
+    for (Widget* widget : dirty_queues.active_widgets) {
+      if (widget != nullptr) {
+        WidgetSystemProxy::bind_dirty_queues(*widget, nullptr);
+        WidgetSystemProxy::update_active_slot(*widget,
+                                              WidgetDirtyQueues::kNoId);
+      }
+    }
 
-    WidgetSystemProxy::tick(widget, interval, context);
-    WidgetSystemProxy::mark_stale(widget);
+    dirty_queues.active_widgets.clear();
+  }
+
+  // the active set is rebuilt from the tree as widgets could have been
+  // detached (but not deleted) since the last build
+  void bind_widgets() {
+    unbind_active_widgets();
+    bind_dirty_queues(*root_widget);
+  }
+
+  void unbind_dirty_queues(Widget& widget) {
+    WidgetSystemProxy::bind_dirty_queues(widget, nullptr);
+    WidgetSystemProxy::update_active_slot(widget, WidgetDirtyQueues::kNoId);
 
     for (Widget* child : widget.get_children()) {
-      // note that we only touch the latest updated pointers to the children,
-      // and if the widget updated its children, we'll rebuild the trees
-      recursive_tick(*child, interval);
+      unbind_dirty_queues(*child);
     }
   }
 
-  // TODO(lamarrrr): should be ticked with subsytem map
+  void unbind_widgets() {
+    unbind_active_widgets();
+    unbind_dirty_queues(*root_widget);
+  }
+
+  // ticks the widgets that subscribed to ticks and flushes the dirtiness of
+  // the others. static widgets are never visited, so the cost of a frame is
+  // proportional to the number of widgets that changed or animate.
+  void tick_active_widgets(std::chrono::nanoseconds interval) {
+    std::vector<Widget*>& active_widgets = dirty_queues.active_widgets;
+
+    // widgets activated whilst ticking (i.e. by their parents) are appended
+    // and processed on this same pass. deleted widgets leave a `nullptr` in
+    // their slot.
+    for (size_t i = 0; i < active_widgets.size(); i++) {
+      Widget* widget = active_widgets[i];
+
+      if (widget == nullptr) continue;
+
+      if (widget->is_subscribed_to_ticks()) {
+        WidgetSystemProxy::tick(*widget, interval, context);
+      } else {
+        WidgetSystemProxy::flush_dirtiness(*widget);
+      }
+    }
+
+    // retain the widgets that are still subscribed. the ones that got dirty
+    // after being processed are also retained and flushed on the next frame.
+    // the paused off-screen ones are parked until they are visible again.
+    size_t num_retained = 0;
+
+    for (Widget* widget : active_widgets) {
+      if (widget == nullptr) continue;
+
+      bool const is_ticking = widget->is_subscribed_to_ticks() &&
+                              !WidgetSystemProxy::is_tick_paused(*widget);
+
+      if (is_ticking || widget->get_dirtiness() != WidgetDirtiness::None) {
+        WidgetSystemProxy::update_active_slot(*widget, num_retained);
+        active_widgets[num_retained] = widget;
+        num_retained++;
+      } else if (widget->is_subscribed_to_ticks()) {
+        WidgetSystemProxy::park(*widget);
+      } else {
+        WidgetSystemProxy::update_active_slot(*widget,
+                                              WidgetDirtyQueues::kNoId);
+      }
+    }
+
+    active_widgets.resize(num_retained);
+  }
+
+  // rebuilds the subtrees of the widgets whose children changed and splices
+  // them into the trees, so only the tiles they cover are invalidated. returns
+  // false if a full rebuild is required, i.e. if views were added or removed.
+  bool rebuild_changed_subtrees() {
+    std::vector<ChangedSubtree>& subtrees = changed_subtrees;
+    subtrees.clear();
+
+    // the ids are resolved before any of the trees is modified
+    for (size_t view : dirty_queues.children_dirty_views) {
+      if (view >= view_tree.views.size()) return false;
+
+      ViewTree::View const& tree_view = view_tree.views[view];
+      if (tree_view.subtree_end != view + 1) return false;
+
+      subtrees.push_back(
+          ChangedSubtree{tree_view.entries_begin, view, ViewTree::kNoView});
+    }
+
+    for (size_t id : dirty_queues.children_dirty_entries) {
+      if (id >= tile_cache.entries.size()) return false;
+
+      size_t const entry = tile_cache.entries[id].view_entry;
+      ViewTree::Entry const& tree_entry = view_tree.entries[entry];
+      if (LayoutTree::has_nested_views(*tree_entry.layout_node)) return false;
+
+      subtrees.push_back(ChangedSubtree{entry + 1, tree_entry.parent, entry});
+    }
+
+    std::sort(subtrees.begin(), subtrees.end(),
+              [](ChangedSubtree const& a, ChangedSubtree const& b) {
+                return a.begin < b.begin ||
+                       (a.begin == b.begin && a.entry < b.entry);
+              });
+
+    // the subtrees nested within another are skipped, their widgets could
+    // have been removed (and deleted) by its ancestors
+    size_t num_outermost = 0;
+    size_t covered_begin = 0;
+    size_t covered_end = 0;
+
+    for (ChangedSubtree const& subtree : subtrees) {
+      size_t const end =
+          subtree.entry == ViewTree::kNoView
+              ? view_tree.views[subtree.view].entries_end
+              : view_tree.entries[subtree.entry].subtree_end;
+
+      if (num_outermost != 0) {
+        ChangedSubtree const& previous = subtrees[num_outermost - 1];
+
+        bool const is_duplicate = previous.begin == subtree.begin &&
+                                  previous.view == subtree.view &&
+                                  previous.entry == subtree.entry;
+        bool const is_nested = subtree.entry != ViewTree::kNoView &&
+                               subtree.entry >= covered_begin &&
+                               subtree.entry < covered_end;
+
+        if (is_duplicate || is_nested) continue;
+      }
+
+      subtrees[num_outermost] = subtree;
+      num_outermost++;
+      covered_begin = subtree.begin;
+      covered_end = end;
+    }
+
+    subtrees.resize(num_outermost);
+
+    // splicing only shifts the entries after the spliced range, so the last
+    // subtrees are processed first to keep the others' indices valid
+    for (size_t i = subtrees.size(); i > 0; i--) {
+      ChangedSubtree const& subtree = subtrees[i - 1];
+
+      LayoutTree::Node& node =
+          subtree.entry == ViewTree::kNoView
+              ? *view_tree.views[subtree.view].layout_node
+              : *view_tree.entries[subtree.entry].layout_node;
+
+      layout_tree.rebuild_subtree(node);
+
+      if (LayoutTree::has_nested_views(node)) return false;
+
+      ViewTree::EntrySplice const splice =
+          subtree.entry == ViewTree::kNoView
+              ? view_tree.rebuild_view_entries(subtree.view)
+              : view_tree.rebuild_entry_subtree(subtree.entry);
+
+      tile_cache.splice_entries(splice);
+
+      bind_dirty_queues(*node.widget);
+    }
+
+    // the entries were moved around
+    hit_test_index_needs_rebuild = true;
+
+    return true;
+  }
+
+  // true if the next UI stage has nothing to do: no widget is dirty,
+  // animating, awaiting a future (they subscribe to ticks), or had its layer
+  // effects updated, and the trees and the recorded tiles are up-to-date. the
+  // app blocks waiting for events whilst idle, the events (and the background
+  // tasks' completions) wake it up.
+  //
+  // the render stage isn't considered: the render thread carries over its
+  // stale tiles on its own. callers rendering on the calling thread (see
+  // `tick`) must also wait for `tile_cache.rasterizer`'s stale tiles.
+  bool is_idle() const {
+    return dirty_queues.active_widgets.empty() && animations->size() == 0 &&
+           !needs_rebuild && !viewport.is_resized() &&
+           !viewport.is_scrolled() &&
+           !viewport.is_widgets_allocation_changed();
+  }
+
+  // runs the UI stage and then renders the frame on the calling thread
   BackingStoreDiff tick(std::chrono::nanoseconds interval) {
-    recursive_tick(*root_widget, interval);
+    TileRasterizer::Clock::time_point const frame_begin =
+        TileRasterizer::Clock::now();
+    return tile_cache.render(record(interval), frame_begin);
+  }
+
+  // the UI stage of the frame: ticks the widgets, layout, and view offsets,
+  // and records the dirty tiles. if the backing store needs updating, the
+  // frame is captured in `tile_cache.snapshot` for the render stage, which can
+  // run on another thread (see `RenderThread`).
+  //
+  // TODO(lamarrrr): should be ticked with subsytem map
+  BackingStoreDiff record(std::chrono::nanoseconds interval) {
+    // the animated widgets are marked dirty and flushed on this same frame
+    animations->evaluate(interval);
+
+    dirty_queues.time += interval;
+    tick_active_widgets(interval);
 
     // dpr
 
+    if (!needs_rebuild) {
+      // the ids are only valid until the trees are modified. a full rebuild
+      // marks everything as dirty anyway.
+      if (dirty_queues.layout_dirty) {
+        layout_tree.is_layout_dirty = true;
+      }
+
+      view_tree.mark_views_dirty(dirty_queues.view_offset_dirty);
+      tile_cache.mark_entries_render_dirty(dirty_queues.render_dirty);
+
+      if (dirty_queues.children_changed && !rebuild_changed_subtrees()) {
+        needs_rebuild = true;
+      }
+    }
+
     if (needs_rebuild) {
       // note that each build method is optimized for rebuilding and should not
       // re-allocate too much of memory in the case where the tree sizes don't
@@ -132,12 +448,16 @@ struct Pipeline {
       // constructor that uses `.resize` and `.clear` for their vectors to
       // prevent forcing a memory re-allocation when the available space is
       // enough
+      bind_widgets();
       layout_tree.build(*root_widget);
       view_tree.build(layout_tree.root_node);
-      tile_cache.build(view_tree.root_view, *render_context);
+      tile_cache.build(view_tree, *render_context);
       needs_rebuild = false;
+      hit_test_index_needs_rebuild = true;
     }
 
+    dirty_queues.clear();
+
     {
       if (viewport.is_scrolled()) {
         tile_cache.scroll_backing_store_logical(viewport.get_offset());
@@ -159,8 +479,9 @@ struct Pipeline {
     bool const layout_tree_was_cleaned = layout_tree.is_layout_dirty;
     layout_tree.tick(interval);
 
-    // if layout tree becomes dirty we need to force a total re-draw by marking
-    // all of the tiles as dirty
+    // if the layout changed, all of the offsets need to be re-calculated.
+    // only the widgets that moved or were resized are re-recorded, unless the
+    // extent of a layer changed.
     if (layout_tree_was_cleaned) {
       view_tree.mark_views_dirty();
       // resize tiles to layout extent
@@ -168,13 +489,35 @@ struct Pipeline {
     }
 
     view_tree.tick(interval);
+    tile_cache.mark_moved_entries_dirty(view_tree.moved_entries);
+
+    // the view tree's offsets are now up-to-date
+    if (hit_test_index_needs_rebuild) {
+      hit_test_index.build(view_tree);
+      hit_test_index_needs_rebuild = false;
+    } else {
+      hit_test_index.update();
+    }
+
+    BackingStoreDiff backing_store_diff = tile_cache.record(interval);
 
-    BackingStoreDiff backing_store_diff = tile_cache.tick(interval);
+    // the input is only measured up to the frame that reflects it
+    if (backing_store_diff == BackingStoreDiff::Some) {
+      tile_cache.snapshot.has_input = has_pending_input_;
+      tile_cache.snapshot.input_timestamp = pending_input_timestamp_;
+    }
+
+    has_pending_input_ = false;
 
     context.__tick(interval);
 
     return backing_store_diff;
   }
+
+ private:
+  // the earliest input dispatched since the last recorded frame
+  EventTimestamp pending_input_timestamp_{};
+  bool has_pending_input_ = false;
 };
 
 }  // namespace ui
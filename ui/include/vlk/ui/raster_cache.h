@@ -82,6 +82,10 @@ struct RasterRecord {
     return *picture_;
   }
 
+  /// the recording is immutable, so it can be shared with (and rasterized on)
+  /// another thread. `nullptr` if there's no recording.
+  sk_sp<SkPicture> share_recording() const { return picture_; }
+
  private:
   sk_sp<SkPicture> picture_;
 
@@ -121,6 +125,10 @@ struct RasterCache {
   }
 
   void rasterize(Dpr target_device_pixel_ratio, RasterRecord const& record) {
+    rasterize(target_device_pixel_ratio, record.get_recording());
+  }
+
+  void rasterize(Dpr target_device_pixel_ratio, SkPicture const& recording) {
     VLK_ENSURE(is_surface_init());
     // first await any pending rendering operation by performing GPU-CPU
     // synchronization
@@ -136,7 +144,7 @@ struct RasterCache {
     canvas->save();
     canvas->scale(target_device_pixel_ratio.x, target_device_pixel_ratio.y);
 
-    canvas->drawPicture(&record.get_recording());
+    canvas->drawPicture(&recording);
 
     // restore transform matrix and clip state
     canvas->restore();
@@ -146,10 +154,11 @@ struct RasterCache {
     submitted_work_ = true;
   }
 
-  void write_to(SkCanvas& canvas, IOffset const& offset) {
+  void write_to(SkCanvas& canvas, IOffset const& offset,
+                SkBlendMode blend_mode = SkBlendMode::kSrc) {
     VLK_ENSURE(is_surface_init());
     SkPaint paint;
-    paint.setBlendMode(SkBlendMode::kSrc);
+    paint.setBlendMode(blend_mode);
     surface_->draw(&canvas, static_cast<float>(offset.x),
                    static_cast<float>(offset.y), &paint);
   }
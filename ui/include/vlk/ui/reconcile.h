@@ -0,0 +1,229 @@
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "stx/span.h"
+#include "stx/struct.h"
+#include "vlk/ui/widget.h"
+#include "vlk/utils.h"
+
+namespace vlk {
+namespace ui {
+
+/// identifies a child widget across updates of its parent's child list. the
+/// keys of a widget's children must be unique.
+using WidgetKey = uint64_t;
+
+/// builds the widget for a key that wasn't on the previous child list. called
+/// with the key and the index the widget is inserted at.
+using KeyedWidgetBuilder = std::function<Widget *(WidgetKey, size_t)>;
+
+enum class ReconcileOpType : uint8_t {
+  /// a new child was inserted at `to`
+  Insert,
+  /// the child at `from` on the previous list is now at `to`
+  Move,
+  /// the child at `from` on the previous list was removed
+  Remove
+};
+
+struct ReconcileOp {
+  static constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+  ReconcileOpType type = ReconcileOpType::Insert;
+  /// index on the previous child list, `kNone` for insertions
+  size_t from = 0;
+  /// index on the new child list, `kNone` for removals
+  size_t to = 0;
+};
+
+constexpr bool operator==(ReconcileOp const &a, ReconcileOp const &b) {
+  return a.type == b.type && a.from == b.from && a.to == b.to;
+}
+
+constexpr bool operator!=(ReconcileOp const &a, ReconcileOp const &b) {
+  return !(a == b);
+}
+
+// a keyed child list. callers describe the new list of children by their keys,
+// and it is diffed against the previous list by key: the widgets of the keys
+// present on both lists are re-used (along with their state), the ones of the
+// keys that are no longer present are deleted, and only the new keys are
+// built.
+//
+// of the re-used children, the longest run that keeps its relative order stays
+// in place and the rest are reported as moved, so the number of operations is
+// minimal. the pipeline matches the persisted children by widget, so their
+// layout nodes, views, and recorded tiles are kept. a reorder or filter thus
+// only re-records the children whose area changed.
+//
+// it owns the widgets returned by the builder. it is used as:
+//
+// ```
+// if (children_.reconcile(keys, builder)) {
+//   Widget::update_children(children_.get_widgets());
+// }
+// ```
+//
+struct KeyedChildren {
+  static constexpr size_t kNone = ReconcileOp::kNone;
+
+  KeyedChildren() = default;
+
+  STX_MAKE_PINNED(KeyedChildren)
+
+  ~KeyedChildren() {
+    for (Widget *widget : widgets_) {
+      delete widget;
+    }
+  }
+
+  /// updates the children to the ones described by `keys`. returns false if
+  /// the child list is unchanged, in which case no widget needs to be
+  /// notified. `O(n log n)`.
+  bool reconcile(stx::Span<WidgetKey const> keys,
+                 KeyedWidgetBuilder const &builder) {
+    ops_.clear();
+
+    sorted_.clear();
+    for (size_t i = 0; i < keys.size(); i++) {
+      sorted_.emplace_back(keys[i], i);
+    }
+
+    std::sort(sorted_.begin(), sorted_.end());
+
+    VLK_ENSURE(std::adjacent_find(sorted_.begin(), sorted_.end(),
+                                  [](auto const &a, auto const &b) {
+                                    return a.first == b.first;
+                                  }) == sorted_.end(),
+               "KeyedChildren's keys must be unique");
+
+    // index of each previous child on the new list
+    targets_.clear();
+    targets_.resize(keys_.size(), kNone);
+
+    // index of each new child on the previous list
+    sources_.clear();
+    sources_.resize(keys.size(), kNone);
+
+    for (size_t i = 0; i < keys_.size(); i++) {
+      auto const match =
+          std::lower_bound(sorted_.begin(), sorted_.end(),
+                           std::make_pair(keys_[i], static_cast<size_t>(0)));
+
+      if (match != sorted_.end() && match->first == keys_[i]) {
+        targets_[i] = match->second;
+        sources_[match->second] = i;
+      }
+    }
+
+    for (size_t i = keys_.size(); i > 0; i--) {
+      if (targets_[i - 1] == kNone) {
+        ops_.push_back(ReconcileOp{ReconcileOpType::Remove, i - 1, kNone});
+        delete widgets_[i - 1];
+        widgets_[i - 1] = nullptr;
+      }
+    }
+
+    mark_stationary();
+
+    scratch_.clear();
+    scratch_.resize(keys.size(), nullptr);
+
+    for (size_t i = 0; i < keys.size(); i++) {
+      size_t const source = sources_[i];
+
+      if (source == kNone) {
+        ops_.push_back(ReconcileOp{ReconcileOpType::Insert, kNone, i});
+        scratch_[i] = builder(keys[i], i);
+        VLK_ENSURE(scratch_[i] != nullptr,
+                   "KeyedChildren's builder returned a null widget");
+      } else {
+        if (!stationary_[i]) {
+          ops_.push_back(ReconcileOp{ReconcileOpType::Move, source, i});
+        }
+        scratch_[i] = widgets_[source];
+      }
+    }
+
+    std::swap(widgets_, scratch_);
+    keys_.assign(keys.begin(), keys.end());
+
+    return !ops_.empty();
+  }
+
+  stx::Span<Widget *const> get_widgets() const { return widgets_; }
+
+  stx::Span<WidgetKey const> get_keys() const { return keys_; }
+
+  /// the operations performed by the last reconciliation. the removals come
+  /// first (in decreasing `from` order), then the insertions and moves (in
+  /// increasing `to` order).
+  stx::Span<ReconcileOp const> get_ops() const { return ops_; }
+
+  /// returns the widget of the child with the specified key or `nullptr`.
+  /// `O(n)`.
+  Widget *find(WidgetKey key) const {
+    auto const it = std::find(keys_.begin(), keys_.end(), key);
+    return it == keys_.end() ? nullptr : widgets_[it - keys_.begin()];
+  }
+
+ private:
+  // marks the longest subsequence of the re-used children whose previous
+  // indices are increasing as stationary (patience sorting).
+  void mark_stationary() {
+    size_t const size = sources_.size();
+
+    stationary_.clear();
+    stationary_.resize(size, false);
+    tails_.clear();
+    predecessors_.clear();
+    predecessors_.resize(size, kNone);
+
+    for (size_t i = 0; i < size; i++) {
+      if (sources_[i] == kNone) continue;
+
+      auto const tail = std::lower_bound(
+          tails_.begin(), tails_.end(), sources_[i],
+          [this](size_t index, size_t source) {
+            return sources_[index] < source;
+          });
+
+      if (tail != tails_.begin()) predecessors_[i] = *(tail - 1);
+
+      if (tail == tails_.end()) {
+        tails_.push_back(i);
+      } else {
+        *tail = i;
+      }
+    }
+
+    if (tails_.empty()) return;
+
+    for (size_t i = tails_.back(); i != kNone; i = predecessors_[i]) {
+      stationary_[i] = true;
+    }
+  }
+
+  std::vector<WidgetKey> keys_;
+  std::vector<Widget *> widgets_;
+  std::vector<ReconcileOp> ops_;
+
+  // retained across reconciliations to avoid re-allocating
+  std::vector<std::pair<WidgetKey, size_t>> sorted_;
+  std::vector<size_t> targets_;
+  std::vector<size_t> sources_;
+  std::vector<size_t> tails_;
+  std::vector<size_t> predecessors_;
+  std::vector<bool> stationary_;
+  std::vector<Widget *> scratch_;
+};
+
+}  // namespace ui
+}  // namespace vlk
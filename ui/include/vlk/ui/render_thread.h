@@ -0,0 +1,207 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "stx/struct.h"
+#include "vlk/ui/raster_cache.h"
+#include "vlk/ui/render_context.h"
+#include "vlk/ui/tile_cache.h"
+
+namespace vlk {
+namespace ui {
+
+// runs the render stage (rasterization, compositing, and presentation) on a
+// separate thread, so the UI stage records frame N+1 whilst frame N is
+// rendered:
+//
+// UI thread:     | record N | record N+1 | record N+2 |
+// render thread:            | render N   | render N+1 | render N+2 |
+//
+// the frames are handed over as snapshots by swapping buffers with the render
+// thread, so neither is copied nor re-allocated in the steady state. at most
+// one frame is queued, `submit` blocks until the render thread picks the
+// previous one up. frames are never dropped, as each one only carries the
+// tiles re-recorded since the previous one.
+//
+// the stale tiles the rasterizer carries over (once the frame budget is
+// exhausted) are rasterized and presented on the following iterations, even if
+// no new frame is submitted.
+//
+// NOTE: the render context (and the surfaces it presents to) must only be used
+// by the render thread whilst it is running, unless it is paused (see
+// `pause`). the backing store is only accessible from `on_rendered`, or whilst
+// paused.
+//
+struct RenderThread {
+  // called on the render thread with the backing store of each rendered frame,
+  // i.e. to present it
+  using Callback = std::function<void(RasterCache &)>;
+
+  explicit RenderThread(RenderContext const &render_context,
+                        Callback on_rendered = {})
+      : context_{&render_context}, on_rendered_{std::move(on_rendered)} {
+    thread_ = std::thread{[this]() { run_(); }};
+  }
+
+  STX_MAKE_PINNED(RenderThread)
+
+  // renders the remaining frame (if any) before joining
+  ~RenderThread() {
+    {
+      std::unique_lock lock{mutex_};
+      should_stop_ = true;
+    }
+    pending_cv_.notify_one();
+    thread_.join();
+  }
+
+  // hands the frame over to the render thread. the snapshot is exchanged with
+  // a previously rendered one, it is to be re-filled by the tile cache.
+  void submit(FrameSnapshot &snapshot) {
+    {
+      std::unique_lock lock{mutex_};
+      free_cv_.wait(lock, [this]() { return !has_pending_; });
+      std::swap(pending_, snapshot);
+      has_pending_ = true;
+      num_submitted_++;
+    }
+    pending_cv_.notify_one();
+  }
+
+  // the deadline of each rendered frame, from the moment its rendering begins
+  void set_frame_budget(std::chrono::nanoseconds frame_budget) {
+    std::unique_lock lock{mutex_};
+    frame_budget_ = frame_budget;
+  }
+
+  // blocks until all of the submitted frames are rendered. the render thread
+  // isn't quiescent once it returns: if the frame budget is bounded, it keeps
+  // rasterizing and presenting their stale tiles. see `pause`.
+  void wait_idle() {
+    std::unique_lock lock{mutex_};
+    idle_cv_.wait(lock, [this]() { return num_rendered_ == num_submitted_; });
+  }
+
+  // blocks until all of the submitted frames are rendered and the render
+  // thread is done with them, and stops it from resuming their stale tiles
+  // until `resume` is called. the render context, its surfaces, and the
+  // rasterizer can then be used by the calling thread, i.e. to recreate the
+  // swapchain. no frame is to be submitted whilst paused.
+  void pause() {
+    std::unique_lock lock{mutex_};
+    is_paused_ = true;
+    idle_cv_.wait(lock, [this]() {
+      return num_rendered_ == num_submitted_ && !is_rendering_;
+    });
+  }
+
+  void resume() {
+    {
+      std::unique_lock lock{mutex_};
+      is_paused_ = false;
+    }
+    pending_cv_.notify_one();
+  }
+
+  size_t get_num_rendered() const {
+    std::unique_lock lock{mutex_};
+    return num_rendered_;
+  }
+
+  // the time from the earliest input event reflected by the last frame that
+  // had any, to the end of its presentation (`on_rendered`)
+  std::chrono::nanoseconds get_input_latency() const {
+    std::unique_lock lock{mutex_};
+    return input_latency_;
+  }
+
+  // NOTE: only valid to access whilst paused
+  TileRasterizer &get_rasterizer() { return rasterizer_; }
+
+ private:
+  void run_() {
+    while (true) {
+      bool is_new_frame = false;
+
+      {
+        std::unique_lock lock{mutex_};
+        pending_cv_.wait(lock, [this]() {
+          return has_pending_ || should_stop_ ||
+                 (!is_paused_ && rasterizer_.has_stale_tiles());
+        });
+
+        if (!has_pending_ && should_stop_) return;
+
+        if (has_pending_) {
+          // the previously rendered frame's buffer becomes the free one
+          std::swap(current_, pending_);
+          has_pending_ = false;
+          is_new_frame = true;
+        }
+
+        rasterizer_.frame_budget = frame_budget_;
+        is_rendering_ = true;
+      }
+
+      if (is_new_frame) {
+        free_cv_.notify_one();
+        rasterizer_.render(current_, *context_);
+      } else {
+        rasterizer_.resume(current_, *context_);
+      }
+
+      if (on_rendered_) {
+        on_rendered_(rasterizer_.backing_store_cache);
+      }
+
+      {
+        std::unique_lock lock{mutex_};
+        is_rendering_ = false;
+
+        if (is_new_frame) {
+          num_rendered_++;
+
+          if (current_.has_input) {
+            input_latency_ =
+                std::chrono::steady_clock::now() - current_.input_timestamp;
+          }
+        }
+      }
+
+      idle_cv_.notify_all();
+    }
+  }
+
+  RenderContext const *context_ = nullptr;
+  Callback on_rendered_;
+
+  // only accessed by the render thread whilst it is running
+  TileRasterizer rasterizer_;
+  FrameSnapshot current_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable pending_cv_;
+  std::condition_variable free_cv_;
+  std::condition_variable idle_cv_;
+  FrameSnapshot pending_;
+  bool has_pending_ = false;
+  bool should_stop_ = false;
+  bool is_paused_ = false;
+  // whether a frame (or its stale tiles) is being rendered or presented
+  bool is_rendering_ = false;
+  std::chrono::nanoseconds frame_budget_ = TileRasterizer::kNoBudget;
+  size_t num_submitted_ = 0;
+  size_t num_rendered_ = 0;
+  std::chrono::nanoseconds input_latency_{0};
+
+  std::thread thread_;
+};
+
+}  // namespace ui
+}  // namespace vlk
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "vlk/utils.h"
+
+namespace vlk {
+namespace ui {
+
+// a fixed-capacity FIFO queue. it never allocates, once full the oldest
+// elements are overwritten.
+template <typename T, size_t Capacity>
+struct RingBuffer {
+  static_assert(Capacity > 0);
+
+  static constexpr size_t capacity() { return Capacity; }
+
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  bool full() const { return size_ == Capacity; }
+
+  // returns false if the oldest element was overwritten to make space
+  bool push(T const &value) {
+    if (full()) {
+      elements_[begin_] = value;
+      begin_ = (begin_ + 1) % Capacity;
+      return false;
+    }
+
+    elements_[(begin_ + size_) % Capacity] = value;
+    size_++;
+    return true;
+  }
+
+  void pop_front() {
+    VLK_ENSURE(!empty());
+    begin_ = (begin_ + 1) % Capacity;
+    size_--;
+  }
+
+  void clear() {
+    begin_ = 0;
+    size_ = 0;
+  }
+
+  // the elements are indexed from the oldest
+  T &operator[](size_t index) {
+    VLK_ENSURE(index < size_);
+    return elements_[(begin_ + index) % Capacity];
+  }
+
+  T const &operator[](size_t index) const {
+    VLK_ENSURE(index < size_);
+    return elements_[(begin_ + index) % Capacity];
+  }
+
+  T &front() { return (*this)[0]; }
+
+  T const &front() const { return (*this)[0]; }
+
+  T &back() { return (*this)[size_ - 1]; }
+
+  T const &back() const { return (*this)[size_ - 1]; }
+
+ private:
+  std::array<T, Capacity> elements_{};
+  size_t begin_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace ui
+}  // namespace vlk
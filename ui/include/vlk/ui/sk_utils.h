@@ -1,8 +1,10 @@
 
 #pragma once
 
+#include "include/core/SkMatrix.h"
 #include "include/core/SkRect.h"
 #include "vlk/primitives.h"
+#include "vlk/ui/layer_effects.h"
 
 namespace vlk {
 
@@ -28,6 +30,13 @@ constexpr std::array<SkVector, 4> to_skia(BorderRadius const& border_radius) {
   };
 }
 
+inline SkMatrix to_sk_matrix(ui::Transform2D const& transform) {
+  return SkMatrix::MakeAll(transform.scale_x, transform.skew_x,
+                           transform.translate_x, transform.skew_y,
+                           transform.scale_y, transform.translate_y, 0.0f, 0.0f,
+                           1.0f);
+}
+
 inline Rect to_vlk_rect(SkRect const& rect) {
   auto x = static_cast<int32_t>(rect.x());
   auto y = static_cast<int32_t>(rect.y());
@@ -1,13 +1,22 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iterator>
 #include <queue>
+#include <tuple>
 #include <vector>
 
+#include "include/core/SkMatrix.h"
+#include "include/core/SkPaint.h"
 #include "vlk/primitives.h"
+#include "vlk/ui/event.h"
+#include "vlk/ui/layer_effects.h"
 #include "vlk/ui/raster_cache.h"
 #include "vlk/ui/raster_tiles.h"
 #include "vlk/ui/render_context.h"
+#include "vlk/ui/sk_utils.h"
 #include "vlk/ui/view_tree.h"
 #include "vlk/ui/widget.h"
 
@@ -57,6 +66,617 @@ constexpr auto get_tiles_range(Extent const &tile_extent, int64_t nrows,
   return std::make_tuple(i_begin_c, i_end_c, j_begin_c, j_end_c);
 }
 
+// a grid of tiles covering a rasterization space. i.e. the root view's area
+// or a compositing layer's content. the tile set only holds the recordings,
+// the tiles are rasterized by the render stage (`TileRasterizer`).
+//
+// NOTE: all dimensions here are in the physical coordinates
+struct TileSet {
+  explicit TileSet(Extent init_tile_physical_extent)
+      : tile_physical_extent_{init_tile_physical_extent} {
+    VLK_ENSURE(tile_physical_extent_.visible());
+  }
+
+  RasterRecordTiles record_tiles;
+  std::vector<bool> tile_record_is_dirty;
+
+  std::vector<bool> tile_is_in_focus;
+
+  // the tiles re-recorded on the last tick, these need to be re-rasterized
+  std::vector<bool> tile_was_recorded;
+
+  Extent physical_extent() const { return physical_extent_; }
+
+  Extent tile_physical_extent() const { return tile_physical_extent_; }
+
+  // same grid as `RasterCacheTiles`
+  uint32_t rows() const {
+    return ((physical_extent_.width + tile_physical_extent_.width) /
+            tile_physical_extent_.width);
+  }
+
+  uint32_t columns() const {
+    return ((physical_extent_.height + tile_physical_extent_.height) /
+            tile_physical_extent_.height);
+  }
+
+  IRect tile_physical_rect(int64_t i, int64_t j) const {
+    Extent const tile_extent = tile_physical_extent();
+    return IRect{IOffset{i * tile_extent.width, j * tile_extent.height},
+                 tile_extent};
+  }
+
+  void resize(Extent new_physical_extent) {
+    // the recordings remain valid if the extent didn't change, i.e. on a
+    // layout change that only moved some of the widgets
+    if (!tile_record_is_dirty.empty() &&
+        physical_extent_ == new_physical_extent) {
+      return;
+    }
+
+    physical_extent_ = new_physical_extent;
+    record_tiles.resize(rows(), columns());
+
+    size_t const num_tiles = record_tiles.get_tiles().size();
+
+    tile_record_is_dirty.resize(num_tiles);
+    tile_is_in_focus.resize(num_tiles);
+    tile_was_recorded.resize(num_tiles);
+
+    // TODO(lamarrr): find a way to ensure we don't discard the recordings
+
+    for (size_t i = 0; i < num_tiles; i++) {
+      tile_record_is_dirty[i] = true;
+      tile_is_in_focus[i] = false;
+      tile_was_recorded[i] = false;
+    }
+  }
+
+  void mark_all_records_dirty() {
+    for (size_t i = 0; i < tile_record_is_dirty.size(); i++) {
+      tile_record_is_dirty[i] = true;
+    }
+  }
+
+  void mark_records_dirty(IRect const &physical_area) {
+    if (!physical_area.visible()) return;
+
+    /// NOTE: the tile's rows and columns are not actually updated until
+    /// tick, so widgets can still mark them as dirty even if a resize
+    /// is needed
+    int64_t const nrows = record_tiles.rows();
+    int64_t const ncols = record_tiles.columns();
+
+    auto const [i_begin, i_end, j_begin, j_end] =
+        get_tiles_range(tile_physical_extent(), nrows, ncols, physical_area);
+
+    for (int64_t j = j_begin; j < j_end; j++) {
+      for (int64_t i = i_begin; i < i_end; i++) {
+        tile_record_is_dirty[j * nrows + i] = true;
+      }
+    }
+  }
+
+  void update_focus(IRect const &physical_focus_rect) {
+    for (uint32_t j = 0; j < columns(); j++) {
+      for (uint32_t i = 0; i < rows(); i++) {
+        size_t const tile_index = j * rows() + i;
+        bool const in_focus =
+            physical_focus_rect.visible() &&
+            tile_physical_rect(i, j).overlaps(physical_focus_rect);
+
+        // tiles are discarded once they are out of focus, so they need to be
+        // re-recorded once they are back in focus
+        if (tile_is_in_focus[tile_index] && !in_focus) {
+          tile_record_is_dirty[tile_index] = true;
+        }
+
+        tile_is_in_focus[tile_index] = in_focus;
+      }
+    }
+  }
+
+  // prepares the in-focus and dirty tiles for recording. returns true if any
+  // tile is to be re-recorded.
+  bool begin_recording(Dpr dpr) {
+    bool any_recording = false;
+
+    // subtiles should be marked as dirty and as in focus or out of focus as
+    // necessary before entering here
+    for (size_t i = 0; i < record_tiles.get_tiles().size(); i++) {
+      RasterRecord &record = record_tiles.get_tiles()[i];
+
+      tile_was_recorded[i] = false;
+
+      // NOTE: the rasters of the tiles out of focus are released by the render
+      // stage
+      if (!tile_is_in_focus[i]) {
+        record.discard();
+      }
+
+      if (tile_is_in_focus[i] && tile_record_is_dirty[i]) {
+        any_recording = true;
+
+        // prepare subtile for recording
+        record.discard();
+
+        VRect tile_virtual_logical_rect = physical_to_logical(
+            dpr, IRect{IOffset{0, 0}, tile_physical_extent()});
+
+        record.begin_recording(tile_virtual_logical_rect);
+      }
+    }
+
+    return any_recording;
+  }
+
+  void finish_recording() {
+    for (size_t i = 0; i < record_tiles.get_tiles().size(); i++) {
+      RasterRecord &record = record_tiles.get_tiles()[i];
+
+      if (tile_record_is_dirty[i] && tile_is_in_focus[i]) {
+        record.finish_recording();
+
+        tile_record_is_dirty[i] = false;
+        tile_was_recorded[i] = true;
+      }
+    }
+  }
+
+ private:
+  Extent physical_extent_;
+  Extent tile_physical_extent_;
+};
+
+// the physical composite state of a layer, compared on every tick to
+// determine if the layer needs to be re-composited
+struct LayerCompositeState {
+  // visible area of the layer view's ancestors on the screen
+  IRect ancestors_clip_rect{};
+
+  // maps the view's space onto the screen
+  SkMatrix view_to_screen = SkMatrix::I();
+
+  // the view's extent, clipped by the effect's clip
+  IRect view_clip_rect{};
+
+  // translation of the view's content (i.e. by scrolling)
+  IOffset translation{};
+
+  float opacity = 1.0f;
+
+  bool operator==(LayerCompositeState const &other) const {
+    return ancestors_clip_rect == other.ancestors_clip_rect &&
+           view_to_screen == other.view_to_screen &&
+           view_clip_rect == other.view_clip_rect &&
+           translation == other.translation && opacity == other.opacity;
+  }
+
+  bool operator!=(LayerCompositeState const &other) const {
+    return !(*this == other);
+  }
+
+  SkMatrix content_to_screen() const {
+    return SkMatrix::Concat(view_to_screen,
+                            SkMatrix::Translate(translation.x, translation.y));
+  }
+};
+
+// an immutable copy of a frame's layers, as recorded by the tile cache on the
+// UI thread. the tiles' recordings are shared (`SkPicture`s are immutable and
+// thread-safe), so a snapshot can be rasterized and composited on another
+// thread whilst the next frame is being recorded.
+//
+// the snapshot is re-filled in-place on every frame that changed the backing
+// store, so it doesn't re-allocate in the steady state.
+struct FrameSnapshot {
+  struct Tile {
+    // `nullptr` if the tile is out of focus, its raster is then released
+    sk_sp<SkPicture> recording;
+
+    // the tile was re-recorded on this frame and needs to be re-rasterized
+    bool is_dirty = false;
+  };
+
+  struct Layer {
+    // used for matching the layers' rasters across frames
+    Widget const *widget = nullptr;
+    bool is_root = false;
+
+    Extent tile_physical_extent{};
+    Extent tiles_physical_extent{};
+
+    // sorted in row-major order, same as the tile set's
+    std::vector<Tile> tiles;
+
+    LayerCompositeState composited{};
+
+    // the area of the layer's content (physical) visible on the backing store
+    IRect visible_region{};
+  };
+
+  Dpr device_pixel_ratio;
+
+  Extent backing_store_physical_extent{};
+  IOffset backing_store_physical_offset{};
+
+  // the root layer is always the first, followed by the compositing layers in
+  // paint order
+  std::vector<Layer> layers;
+
+  // the arrival of the earliest input event the frame reflects, if any
+  bool has_input = false;
+  EventTimestamp input_timestamp{};
+};
+
+// the render stage of the tile cache. rasterizes the dirty tiles of the frame
+// snapshots and composites their layers into the backing store.
+//
+// the rasterization is deadline-aware: the stale tiles are rasterized in order
+// of priority (the ones on the layer's visible area first, then by distance
+// from its center) until the frame's budget is nearly exhausted. the remaining
+// tiles are carried over to the next render, in the meantime their previous
+// content, or the placeholder if they have none, is composited.
+//
+// it only reads the snapshot, so it can run on a separate (render) thread, as
+// long as it is the only user of the render context whilst doing so.
+struct TileRasterizer {
+  using Clock = std::chrono::steady_clock;
+
+  // all of the stale tiles are rasterized on every render
+  static constexpr std::chrono::nanoseconds kNoBudget =
+      std::chrono::nanoseconds::max();
+
+  struct Layer {
+    Layer(Widget const *layer_widget, bool is_root_layer,
+          Extent tile_physical_extent)
+        : widget{layer_widget},
+          is_root{is_root_layer},
+          cache_tiles{tile_physical_extent} {}
+
+    Widget const *widget = nullptr;
+    bool is_root = false;
+    RasterCacheTiles cache_tiles;
+
+    // the tiles whose rasters are out-of-date with their recordings
+    std::vector<bool> tile_is_stale;
+  };
+
+  // in the same order as the last rendered snapshot's layers
+  std::vector<Layer> layers;
+
+  // accumulates the cache result of all the tiles.
+  // resized on viewport resize.
+  //
+  //
+  // TODO(lamarrr): we need to render to the swapchain's images directly
+  // instead.
+  //
+  //
+  RasterCache backing_store_cache;
+
+  // the time allotted to a frame, from its beginning. at least one stale tile
+  // is rasterized per render, so the rasterization always progresses.
+  //
+  // NOTE: only the time spent issuing the rasterization is accounted for, the
+  // GPU work is not awaited
+  std::chrono::nanoseconds frame_budget = kNoBudget;
+
+  // composited in place of the in-focus tiles that were never rasterized
+  SkColor placeholder_color = SK_ColorTRANSPARENT;
+
+  bool has_stale_tiles() const { return num_stale_tiles_ != 0; }
+
+  size_t get_num_stale_tiles() const { return num_stale_tiles_; }
+
+  void render(FrameSnapshot const &snapshot, RenderContext const &context,
+              Clock::time_point frame_begin = Clock::now()) {
+    if (!backing_store_cache.is_surface_init() ||
+        backing_store_physical_extent_ !=
+            snapshot.backing_store_physical_extent) {
+      backing_store_cache.init_surface(context,
+                                       snapshot.backing_store_physical_extent);
+      backing_store_physical_extent_ = snapshot.backing_store_physical_extent;
+    }
+
+    match_layers_(snapshot);
+
+    num_stale_tiles_ = 0;
+
+    for (size_t l = 0; l < layers.size(); l++) {
+      num_stale_tiles_ += update_tiles_(layers[l], snapshot.layers[l]);
+    }
+
+    rasterize_stale_tiles_(snapshot, context, get_deadline_(frame_begin));
+
+    composite_(snapshot);
+  }
+
+  // continues rasterizing the stale tiles carried over by the last render.
+  // `snapshot` must be the last rendered one.
+  void resume(FrameSnapshot const &snapshot, RenderContext const &context,
+              Clock::time_point frame_begin = Clock::now()) {
+    VLK_ENSURE(layers.size() == snapshot.layers.size());
+
+    rasterize_stale_tiles_(snapshot, context, get_deadline_(frame_begin));
+
+    composite_(snapshot);
+  }
+
+ private:
+  struct StaleTile {
+    size_t layer = 0;
+    size_t index = 0;
+    bool is_hidden = false;
+    // squared distance from the center of the layer's visible region
+    int64_t distance = 0;
+
+    bool operator<(StaleTile const &other) const {
+      return std::tie(is_hidden, distance, layer, index) <
+             std::tie(other.is_hidden, other.distance, other.layer,
+                      other.index);
+    }
+  };
+
+  Clock::time_point get_deadline_(Clock::time_point frame_begin) const {
+    if (frame_budget == kNoBudget) return Clock::time_point::max();
+    return frame_begin +
+           std::chrono::duration_cast<Clock::duration>(frame_budget);
+  }
+
+  // the rasters of the layers that are still present are maintained (to
+  // prevent re-allocating the surfaces), the removed layers' are released
+  void match_layers_(FrameSnapshot const &snapshot) {
+    bool const layers_match =
+        layers.size() == snapshot.layers.size() &&
+        std::equal(layers.begin(), layers.end(), snapshot.layers.begin(),
+                   [](Layer const &layer, FrameSnapshot::Layer const &other) {
+                     return layer.is_root == other.is_root &&
+                            layer.widget == other.widget;
+                   });
+
+    if (layers_match) return;
+
+    std::swap(layers, previous_layers_);
+    layers.clear();
+
+    for (FrameSnapshot::Layer const &snapshot_layer : snapshot.layers) {
+      auto const previous = std::find_if(
+          previous_layers_.begin(), previous_layers_.end(),
+          [&snapshot_layer](Layer const &layer) {
+            return layer.is_root == snapshot_layer.is_root &&
+                   layer.widget == snapshot_layer.widget;
+          });
+
+      if (previous != previous_layers_.end()) {
+        layers.push_back(std::move(*previous));
+        previous_layers_.erase(previous);
+      } else {
+        layers.push_back(Layer{snapshot_layer.widget, snapshot_layer.is_root,
+                               snapshot_layer.tile_physical_extent});
+      }
+    }
+
+    previous_layers_.clear();
+  }
+
+  // marks the re-recorded tiles as stale and releases the tiles out of focus.
+  // returns the number of stale tiles.
+  static size_t update_tiles_(Layer &layer,
+                              FrameSnapshot::Layer const &snapshot_layer) {
+    RasterCacheTiles &cache_tiles = layer.cache_tiles;
+
+    // NOTE: a new layer's tiles are empty, even for a zero extent
+    if (cache_tiles.physical_extent() != snapshot_layer.tiles_physical_extent ||
+        cache_tiles.get_tiles().size() != snapshot_layer.tiles.size()) {
+      uint32_t const rows = cache_tiles.rows();
+
+      cache_tiles.resize(snapshot_layer.tiles_physical_extent);
+      layer.tile_is_stale.resize(cache_tiles.get_tiles().size());
+
+      // the tiles only remain at the same position on the grid if the number
+      // of rows didn't change, their previous content is otherwise misplaced
+      if (cache_tiles.rows() != rows) {
+        for (RasterCache &cache : cache_tiles.get_tiles()) {
+          cache.deinit_surface();
+        }
+      }
+    }
+
+    VLK_ENSURE(cache_tiles.get_tiles().size() == snapshot_layer.tiles.size());
+
+    size_t num_stale_tiles = 0;
+
+    for (size_t i = 0; i < snapshot_layer.tiles.size(); i++) {
+      RasterCache &cache = cache_tiles.get_tiles()[i];
+      FrameSnapshot::Tile const &tile = snapshot_layer.tiles[i];
+
+      if (tile.recording == nullptr) {
+        cache.deinit_surface();
+        layer.tile_is_stale[i] = false;
+        continue;
+      }
+
+      if (tile.is_dirty || !cache.is_surface_init()) {
+        layer.tile_is_stale[i] = true;
+      }
+
+      if (layer.tile_is_stale[i]) num_stale_tiles++;
+    }
+
+    return num_stale_tiles;
+  }
+
+  void rasterize_stale_tiles_(FrameSnapshot const &snapshot,
+                              RenderContext const &context,
+                              Clock::time_point deadline) {
+    if (num_stale_tiles_ == 0) return;
+
+    stale_tiles_.clear();
+
+    for (size_t l = 0; l < layers.size(); l++) {
+      Layer const &layer = layers[l];
+      IRect const &visible_region = snapshot.layers[l].visible_region;
+      uint32_t const rows = layer.cache_tiles.rows();
+      Extent const tile_extent = layer.cache_tiles.tile_physical_extent();
+
+      int64_t const center_x =
+          visible_region.x() + visible_region.width() / 2;
+      int64_t const center_y =
+          visible_region.y() + visible_region.height() / 2;
+
+      for (size_t i = 0; i < layer.tile_is_stale.size(); i++) {
+        if (!layer.tile_is_stale[i]) continue;
+
+        IRect const tile_rect{
+            IOffset{static_cast<int64_t>(i % rows) * tile_extent.width,
+                    static_cast<int64_t>(i / rows) * tile_extent.height},
+            tile_extent};
+
+        int64_t const dx = tile_rect.x() + tile_extent.width / 2 - center_x;
+        int64_t const dy = tile_rect.y() + tile_extent.height / 2 - center_y;
+
+        stale_tiles_.push_back(
+            StaleTile{l, i,
+                      !visible_region.visible() ||
+                          !tile_rect.overlaps(visible_region),
+                      dx * dx + dy * dy});
+      }
+    }
+
+    std::sort(stale_tiles_.begin(), stale_tiles_.end());
+
+    bool const is_bounded = deadline != Clock::time_point::max();
+    size_t num_rasterized = 0;
+
+    for (StaleTile const &stale : stale_tiles_) {
+      Clock::time_point const begin =
+          is_bounded ? Clock::now() : Clock::time_point{};
+
+      if (is_bounded && num_rasterized > 0 &&
+          begin + tile_raster_cost_ >= deadline) {
+        break;
+      }
+
+      Layer &layer = layers[stale.layer];
+      RasterCache &cache = layer.cache_tiles.get_tiles()[stale.index];
+
+      if (!cache.is_surface_init()) {
+        // NOTE: tiles are not initialized with a surface until they are
+        // actually in view
+        cache.init_surface(context, layer.cache_tiles.tile_physical_extent());
+      }
+
+      cache.rasterize(
+          snapshot.device_pixel_ratio,
+          *snapshot.layers[stale.layer].tiles[stale.index].recording);
+
+      layer.tile_is_stale[stale.index] = false;
+      num_stale_tiles_--;
+      num_rasterized++;
+
+      if (is_bounded) {
+        // a moving average, so a single expensive tile doesn't stall the
+        // following frames
+        tile_raster_cost_ =
+            (tile_raster_cost_ * 7 + (Clock::now() - begin)) / 8;
+      }
+    }
+  }
+
+  // writes the tiles overlapping `physical_region` to the canvas. `offset` is
+  // the position of the tile set's origin on the canvas.
+  void composite_tiles_(RasterCacheTiles &cache_tiles, SkCanvas &canvas,
+                        IRect const &physical_region, IOffset const &offset,
+                        SkBlendMode blend_mode) const {
+    int64_t const nrows = cache_tiles.rows();
+    int64_t const ncols = cache_tiles.columns();
+    Extent const tile_extent = cache_tiles.tile_physical_extent();
+
+    auto const [i_begin, i_end, j_begin, j_end] =
+        get_tiles_range(tile_extent, nrows, ncols, physical_region);
+
+    for (int64_t j = j_begin; j < j_end; j++) {
+      for (int64_t i = i_begin; i < i_end; i++) {
+        RasterCache &cache = cache_tiles.tile_at_index(i, j);
+        IOffset const tile_offset =
+            IOffset{i * tile_extent.width, j * tile_extent.height} + offset;
+
+        if (cache.is_surface_init()) {
+          cache.write_to(canvas, tile_offset, blend_mode);
+        } else if (SkColorGetA(placeholder_color) != 0) {
+          SkPaint paint;
+          paint.setColor(placeholder_color);
+          paint.setBlendMode(blend_mode);
+          canvas.drawRect(to_sk_rect(IRect{tile_offset, tile_extent}), paint);
+        }
+      }
+    }
+  }
+
+  // accumulates the layers' rasters into the backing store
+  void composite_(FrameSnapshot const &snapshot) {
+    IOffset const backing_store_physical_offset =
+        snapshot.backing_store_physical_offset;
+    IRect const backing_store_physical_rect{
+        backing_store_physical_offset, snapshot.backing_store_physical_extent};
+
+    SkCanvas *sk_canvas = backing_store_cache.get_surface_ref().getCanvas();
+    VLK_ENSURE(sk_canvas != nullptr);
+    sk_canvas->clear(SK_ColorTRANSPARENT);
+
+    for (size_t l = 0; l < layers.size(); l++) {
+      FrameSnapshot::Layer const &layer = snapshot.layers[l];
+      LayerCompositeState const &state = layer.composited;
+
+      if (!layer.visible_region.visible() || !state.view_clip_rect.visible() ||
+          !state.ancestors_clip_rect.overlaps(backing_store_physical_rect)) {
+        continue;
+      }
+
+      IRect const visible_rect =
+          state.ancestors_clip_rect.intersect(backing_store_physical_rect);
+
+      int const save_count = sk_canvas->save();
+
+      sk_canvas->clipRect(to_sk_rect(visible_rect.with_offset(
+          visible_rect.offset - backing_store_physical_offset)));
+
+      sk_canvas->translate(-backing_store_physical_offset.x,
+                           -backing_store_physical_offset.y);
+      sk_canvas->concat(state.view_to_screen);
+      sk_canvas->clipRect(to_sk_rect(state.view_clip_rect));
+
+      if (state.opacity < 1.0f) {
+        sk_canvas->saveLayerAlpha(
+            nullptr, static_cast<U8CPU>(std::round(state.opacity * 255)));
+      }
+
+      sk_canvas->translate(state.translation.x, state.translation.y);
+
+      // the root layer overwrites the backing store, the other layers are
+      // blended over it
+      composite_tiles_(
+          layers[l].cache_tiles, *sk_canvas, layer.visible_region,
+          IOffset{0, 0},
+          layer.is_root ? SkBlendMode::kSrc : SkBlendMode::kSrcOver);
+
+      sk_canvas->restoreToCount(save_count);
+    }
+  }
+
+  Extent backing_store_physical_extent_{};
+
+  size_t num_stale_tiles_ = 0;
+
+  // estimated time to rasterize a tile
+  Clock::duration tile_raster_cost_{0};
+
+  // retained across renders to avoid re-allocating
+  std::vector<Layer> previous_layers_;
+  std::vector<StaleTile> stale_tiles_;
+};
+
 //
 //
 // For zooming support, we need to decouple tiles from records.
@@ -66,8 +686,14 @@ constexpr auto get_tiles_range(Extent const &tile_extent, int64_t nrows,
 // NICE-TO-HAVE: zooming support for RTL setting
 //
 //
+// compositing layers are composited above the root layer in the order they
+// appear on the view tree (parent layers before their nested layers), with
+// their effects (opacity, transform, and clip) applied and clipped to the
+// visible area of their views' ancestors. widgets outside a layer that overlap
+// it are thus always composited below it.
 //
-//
+// NOTE: layer transforms are only applied at composite time, the screen
+// offsets and clip rects on the view tree don't account for them.
 //
 //
 struct TileCache {
@@ -82,27 +708,38 @@ struct TileCache {
     // chilren reference it?
     Widget *widget = nullptr;
 
-    IOffset const *screen_offset = nullptr;
+    // index of the entry on the view tree. the view tree's entries are
+    // referenced by index as splicing them moves them around.
+    size_t view_entry = 0;
 
-    // represents the extent of the widget
-    Extent const *extent = nullptr;
+    // index of the layer the widget is rasterized into
+    size_t layer = 0;
 
-    IRect const *clip_rect = nullptr;
+    // area on the layer's tiles the widget was last recorded into, these
+    // tiles also need to be re-recorded once the widget moves
+    IRect recorded_physical_area{};
 
-    explicit Entry(ViewTree::View::Entry const &entry) {
+    Entry(ViewTree::Entry const &entry, size_t entry_index,
+          size_t entry_layer) {
       z_index = entry.z_index;
       widget = entry.layout_node->widget;
-      screen_offset = &entry.screen_offset;
-      extent = &entry.layout_node->self_extent;
-      clip_rect = &entry.clip_rect;
+      view_entry = entry_index;
+      layer = entry_layer;
+    }
+
+    // paint order, ties are broken by the order on the view tree
+    bool operator<(Entry const &other) const {
+      return z_index < other.z_index ||
+             (z_index == other.z_index && view_entry < other.view_entry);
     }
 
     /// NOTE: all dimensions here are in the logical coordinates
-    void draw(RasterRecord &record, VRect const &tile_screen_area,
-              Dpr dpr) const {
-      // use tile index and size to determine tile position on the screen and
+    void draw(RasterRecord &record, VRect const &tile_layer_area, Dpr dpr,
+              ViewTree::Entry const &tree_entry) const {
+
+      // use tile index and size to determine tile position on the layer and
       // use that as a translation matrix relative to the objects own position
-      // on the screen
+      // on the layer
 
       // widgets need to use a clip on the provided extent if they know they
       // can't exactly use the provided extent on the canvas. with this
@@ -110,26 +747,51 @@ struct TileCache {
       // itself
 
       // points to the portion of the widget that would be visible
-      IRect widget_clip_rect = *clip_rect;
+      IRect widget_clip_rect = tree_entry.layer_clip_rect;
 
-      IRect widget_screen_area{*screen_offset, *extent};
+      IRect widget_layer_area{tree_entry.layer_offset,
+                              tree_entry.layout_node->self_extent};
 
-      VLK_ENSURE(tile_screen_area.overlaps(virtualize(widget_screen_area)));
+      VLK_ENSURE(tile_layer_area.overlaps(virtualize(widget_layer_area)));
 
       SkCanvas &sk_canvas = record.get_recording_canvas();
 
-      Canvas widget_canvas{sk_canvas, widget_screen_area.extent, dpr};
+      // the portion of the widget within the tile (and its clip), relative to
+      // the widget
+      VRect const widget_area = virtualize(widget_layer_area);
+      VRect const clip_area = virtualize(widget_clip_rect);
+
+      float const draw_area_x =
+          std::max({tile_layer_area.x(), widget_area.x(), clip_area.x()});
+      float const draw_area_y =
+          std::max({tile_layer_area.y(), widget_area.y(), clip_area.y()});
+      float const draw_area_right = std::min(
+          {tile_layer_area.x() + tile_layer_area.width(),
+           widget_area.x() + widget_area.width(),
+           clip_area.x() + clip_area.width()});
+      float const draw_area_bottom = std::min(
+          {tile_layer_area.y() + tile_layer_area.height(),
+           widget_area.y() + widget_area.height(),
+           clip_area.y() + clip_area.height()});
+
+      VRect const draw_area{
+          VOffset{draw_area_x - widget_area.x(), draw_area_y - widget_area.y()},
+          VExtent{std::max(draw_area_right - draw_area_x, 0.0f),
+                  std::max(draw_area_bottom - draw_area_y, 0.0f)}};
+
+      Canvas widget_canvas{sk_canvas, widget_layer_area.extent, dpr,
+                           draw_area};
 
       // backup transform matrix and clip state
       sk_canvas.save();
 
       VOffset translation =
-          virtualize(widget_screen_area.offset) - tile_screen_area.offset;
+          virtualize(widget_layer_area.offset) - tile_layer_area.offset;
 
       sk_canvas.translate(translation.x, translation.y);
 
       if (widget_clip_rect.visible()) {
-        if (widget_clip_rect == widget_screen_area) {
+        if (widget_clip_rect == widget_layer_area) {
           // draw without clip
           widget->draw(widget_canvas);
         } else {
@@ -139,7 +801,7 @@ struct TileCache {
           // note that this is performed relative to the widget's extent, i.e.
           // starting offset of the clip is relative to the widget's extent
           IOffset clip_start =
-              widget_clip_rect.offset - widget_screen_area.offset;
+              widget_clip_rect.offset - widget_layer_area.offset;
 
           IRect translated_clip_rect{clip_start, widget_clip_rect.extent};
 
@@ -156,6 +818,37 @@ struct TileCache {
     }
   };
 
+  // the root view's area, or a compositing layer's content
+  struct Layer {
+    Layer(ViewTree::View const &layer_view, bool is_root_layer)
+        : view{&layer_view},
+          widget{layer_view.layout_node->widget},
+          is_root{is_root_layer} {}
+
+    ViewTree::View const *view = nullptr;
+
+    // used for matching the layers across rebuilds, as the views don't
+    // outlive the view tree's rebuild
+    Widget const *widget = nullptr;
+
+    bool is_root = false;
+
+    TileSet tiles{kTilePhysicalExtent};
+
+    using CompositeState = LayerCompositeState;
+
+    CompositeState composited{};
+
+    // the area of the layer's content (physical) visible on the backing
+    // store, as of the last composite
+    IRect visible_region{};
+
+    Extent get_logical_extent() const {
+      return is_root ? view->layout_node->self_extent
+                     : view->layout_node->view_extent;
+    }
+  };
+
   STX_DEFAULT_CONSTRUCTOR(TileCache)
   STX_MAKE_PINNED(TileCache)
   STX_DEFAULT_DESTRUCTOR(TileCache)
@@ -167,9 +860,16 @@ struct TileCache {
 
   Dpr device_pixel_ratio;
 
-  // entries are sorted in ascending z-index order
+  // entries are sorted in paint order, by ascending z-index and then by their
+  // order on the view tree
   std::vector<Entry> entries;
 
+  // id of the entry of each of the view tree's entries
+  std::vector<size_t> entry_ids;
+
+  // index of the layer each view's content is rasterized into
+  std::vector<size_t> view_layers;
+
   IOffset backing_store_physical_offset;
   bool backing_store_physical_offset_changed = true;
   IOffset backing_store_logical_offset;  // front-end for
@@ -180,25 +880,19 @@ struct TileCache {
   Extent backing_store_logical_extent =
       Extent{50, 50};  // front-end for backing_store_physical_extent
 
-  // accumulates the cache result of all the tiles.
-  // resized on viewport resize.
-  //
-  //
-  // TODO(lamarrr): we need to render to the swapchain's images directly
-  // instead.
-  //
-  //
-  RasterCache backing_store_cache;
-
-  RasterCacheTiles cache_tiles{kTilePhysicalExtent};
-  bool tiles_extent_dirty = true;
+  // the layers of the last recorded frame that changed the backing store.
+  // handed over to the render stage (see `RenderThread::submit`).
+  FrameSnapshot snapshot;
 
-  RasterRecordTiles record_tiles;
-  std::vector<bool> tile_record_is_dirty;
+  // the render stage of the synchronous `tick`
+  TileRasterizer rasterizer;
 
-  std::vector<bool> tile_is_in_focus;
+  // the root layer is always the first, followed by the compositing layers
+  // in the order they appear on the view tree
+  std::vector<Layer> layers;
+  bool tiles_extent_dirty = true;
 
-  ViewTree::View *root_view = nullptr;
+  ViewTree const *view_tree = nullptr;
 
   void update_dpr(Dpr new_dpr) {
     // TODO(lamarrr): implement this function to make dirty area updating work?
@@ -227,6 +921,68 @@ struct TileCache {
     return IRect{backing_store_physical_offset, backing_store_physical_extent};
   }
 
+  IRect to_physical(IRect const &logical_rect) const {
+    return devirtualize_to_irect(
+        logical_to_physical(device_pixel_ratio, logical_rect));
+  }
+
+  IOffset to_physical(IOffset const &logical_offset) const {
+    return devirtualize_to_ioffset(
+        logical_to_physical(device_pixel_ratio, logical_offset));
+  }
+
+  // i.e. S(dpr) * transform * S(1/dpr)
+  Transform2D to_physical(Transform2D const &logical_transform) const {
+    float const x = device_pixel_ratio.x;
+    float const y = device_pixel_ratio.y;
+
+    return Transform2D{logical_transform.scale_x,
+                       logical_transform.skew_x * x / y,
+                       logical_transform.translate_x * x,
+                       logical_transform.skew_y * y / x,
+                       logical_transform.scale_y,
+                       logical_transform.translate_y * y};
+  }
+
+  Layer::CompositeState get_composite_state(Layer const &layer) const {
+    Layer::CompositeState state{};
+
+    if (layer.is_root) {
+      IRect const root_rect = to_physical(
+          IRect{IOffset{0, 0}, layer.view->layout_node->self_extent});
+      state.ancestors_clip_rect = root_rect;
+      state.view_clip_rect = root_rect;
+      return state;
+    }
+
+    ViewTree::View const &view = *layer.view;
+    LayerEffects const effects = layer.widget->get_layer_effects();
+
+    state.ancestors_clip_rect =
+        to_physical(view_tree->views[view.parent].clip_rect);
+
+    IOffset const screen_offset = to_physical(view.screen_offset);
+
+    state.view_to_screen =
+        SkMatrix::Concat(SkMatrix::Translate(screen_offset.x, screen_offset.y),
+                         to_sk_matrix(to_physical(effects.transform)));
+
+    IRect view_clip_rect{IOffset{0, 0}, view.layout_node->self_extent};
+
+    if (effects.clip.is_some()) {
+      IRect const &clip = effects.clip.value();
+      view_clip_rect = view_clip_rect.overlaps(clip)
+                           ? view_clip_rect.intersect(clip)
+                           : view_clip_rect.with_extent(Extent{0, 0});
+    }
+
+    state.view_clip_rect = to_physical(view_clip_rect);
+    state.translation = to_physical(view.translation);
+    state.opacity = std::clamp(effects.opacity, 0.0f, 1.0f);
+
+    return state;
+  }
+
   void scroll_backing_store_logical(IOffset new_logical_offset) {
     backing_store_logical_offset = new_logical_offset;
     VOffset new_virtual_physical_offset =
@@ -270,77 +1026,156 @@ struct TileCache {
   void mark_tiles_extent_dirty() { tiles_extent_dirty = true; }
 
   void mark_all_tile_records_dirty() {
-    for (size_t i = 0; i < tile_record_is_dirty.size(); i++) {
-      tile_record_is_dirty[i] = true;
+    for (Layer &layer : layers) {
+      layer.tiles.mark_all_records_dirty();
     }
   }
 
   // NOTE: view widgets are not inserted as they are not expected to have render
   // data
-  void build_entries(ViewTree::View &view) {
-    // insert by z-index order
-    for (ViewTree::View::Entry &view_entry : view.entries) {
-      auto const insert_pos =
-          std::upper_bound(entries.begin(), entries.end(), view_entry,
-                           [](ViewTree::View::Entry const &a, Entry const &b) {
-                             return a.z_index < b.z_index;
-                           });
-      entries.insert(insert_pos, Entry{view_entry});
+  void build_entries(ViewTree const &tree) {
+    view_layers.clear();
+    view_layers.resize(tree.views.size(), 0);
+
+    entries.reserve(tree.entries.size());
+
+    // the views are in depth-first order, so the layers are added in the
+    // order they appear on the view tree
+    for (size_t index = 0; index < tree.views.size(); index++) {
+      ViewTree::View const &view = tree.views[index];
+
+      if (view.content_layer == index) {
+        layers.push_back(Layer{view, false});
+        view_layers[index] = layers.size() - 1;
+      } else if (view.content_layer != ViewTree::kNoView) {
+        view_layers[index] = view_layers[view.content_layer];
+      }
+
+      for (size_t i = view.entries_begin; i < view.entries_end; i++) {
+        entries.push_back(Entry{tree.entries[i], i, view_layers[index]});
+      }
     }
 
-    for (ViewTree::View &subview : view.subviews) {
-      build_entries(subview);
+    // the entries are collected in view tree order and the ties in z-index are
+    // broken by that order, so there are no equivalent entries and the sort
+    // is stable
+    std::sort(entries.begin(), entries.end());
+  }
+
+  void bind_entry_ids() {
+    entry_ids.resize(view_tree->entries.size());
+
+    for (size_t id = 0; id < entries.size(); id++) {
+      WidgetSystemProxy::bind_entry_id(*entries[id].widget, id);
+      entry_ids[entries[id].view_entry] = id;
     }
   }
 
-  void attach_state_proxies() {
+  IRect get_physical_area(Entry const &entry) const {
+    ViewTree::Entry const &tree_entry = view_tree->entries[entry.view_entry];
+    return to_physical(
+        IRect{tree_entry.layer_offset, tree_entry.layout_node->self_extent});
+  }
+
+  void mark_entry_dirty(Entry const &entry) {
+    TileSet &tiles = layers[entry.layer].tiles;
+
+    // the widget could have moved from the tiles it was recorded into
+    tiles.mark_records_dirty(entry.recorded_physical_area);
+    tiles.mark_records_dirty(get_physical_area(entry));
+  }
+
+  // applies a splice of the view tree's entries. only the tiles the removed
+  // and inserted entries were or will be recorded into are invalidated. the
+  // splice must not add or remove any view.
+  void splice_entries(ViewTree::EntrySplice const &splice) {
+    int64_t const delta = splice.delta();
+
+    auto const removed_begin = std::stable_partition(
+        entries.begin(), entries.end(), [&](Entry const &entry) {
+          return entry.view_entry < splice.begin ||
+                 entry.view_entry >= splice.removed_end;
+        });
+
+    removed_entries_.assign(removed_begin, entries.end());
+    entries.erase(removed_begin, entries.end());
+
+    std::sort(removed_entries_.begin(), removed_entries_.end(),
+              [](Entry const &a, Entry const &b) {
+                return a.widget < b.widget;
+              });
+
     for (Entry &entry : entries) {
-      // attach proxy
-      //
-      // proxies are called before the tile_cache tick
-      //
-      // pipeline event dispatch => pipeline tick
-      //
-      //
-      WidgetSystemProxy::get_state_proxy(*entry.widget).on_render_dirty =
-          stx::fn::rc::make_functor(stx::os_allocator, [this, &entry] {
-            /// NOTE: tile binding is semi-automatic and determined by the
-            /// screen offset
-            /// NOTE: the tile's rows and columns are not actually updated until
-            /// tick, so widgets can still mark them as dirty even if a resize
-            /// is needed
-            int64_t const nrows = this->record_tiles.rows();
-            int64_t const ncols = this->record_tiles.columns();
-
-            IRect logical_widget_rect{*entry.screen_offset, *entry.extent};
-
-            VRect virtual_physical_widget_rect = logical_to_physical(
-                this->device_pixel_ratio, logical_widget_rect);
-
-            IRect physical_widget_rect =
-                devirtualize_to_irect(virtual_physical_widget_rect);
-
-            auto [i_begin, i_end, j_begin, j_end] = get_tiles_range(
-                kTilePhysicalExtent, nrows, ncols, physical_widget_rect);
-
-            VLK_LOG(
-                "marking tiles i={}, j={} and i={}, j={} OF nrows: {}, ncols: "
-                "{}",
-                i_begin, j_begin, i_end, j_end, nrows, ncols);
-
-            for (int64_t j = j_begin; j < j_end; j++) {
-              for (int64_t i = i_begin; i < i_end; i++) {
-                // this is here because it should only mark as dirty when at
-                // least one of the actual intersecting tiles is dirty
-                tile_record_is_dirty[j * nrows + i] = true;
-              }
-            }
-          }).unwrap();
-    }
-  }
-
-  void build(ViewTree::View &view_tree_root,
-             RenderContext const &render_context) {
+      if (entry.view_entry >= splice.removed_end) entry.view_entry += delta;
+    }
+
+    // the entries are inserted in view tree order, so the merge is stable
+    scratch_entries_.clear();
+
+    for (size_t i = splice.begin; i < splice.inserted_end; i++) {
+      ViewTree::Entry const &tree_entry = view_tree->entries[i];
+      Entry entry{tree_entry, i, view_layers[tree_entry.parent]};
+
+      // the widgets that persist across the splice retain their recordings
+      auto const removed = std::lower_bound(
+          removed_entries_.begin(), removed_entries_.end(), entry.widget,
+          [](Entry const &a, Widget const *widget) {
+            return a.widget < widget;
+          });
+
+      if (WidgetSystemProxy::is_bound(*entry.widget) &&
+          removed != removed_entries_.end() &&
+          removed->widget == entry.widget) {
+        entry.recorded_physical_area = removed->recorded_physical_area;
+        removed->recorded_physical_area = IRect{};
+      }
+
+      scratch_entries_.push_back(entry);
+    }
+
+    // the removed widgets' recordings are discarded
+    for (Entry const &removed : removed_entries_) {
+      layers[removed.layer].tiles.mark_records_dirty(
+          removed.recorded_physical_area);
+    }
+
+    std::stable_sort(scratch_entries_.begin(), scratch_entries_.end());
+
+    merged_entries_.clear();
+    merged_entries_.reserve(entries.size() + scratch_entries_.size());
+    std::merge(entries.begin(), entries.end(), scratch_entries_.begin(),
+               scratch_entries_.end(), std::back_inserter(merged_entries_));
+    std::swap(entries, merged_entries_);
+
+    // the new entries are recorded once the view tree is ticked and they are
+    // placed on their layer
+    bind_entry_ids();
+  }
+
+  // marks the tiles of the view tree's entries that moved on its last tick
+  void mark_moved_entries_dirty(stx::Span<size_t const> tree_entries) {
+    for (size_t tree_entry : tree_entries) {
+      mark_entry_dirty(entries[entry_ids[tree_entry]]);
+    }
+  }
+
+  // drains the ids of the entries whose render data changed. the widgets are
+  // marked dirty before the tile cache is ticked:
+  //
+  // pipeline event dispatch => pipeline tick
+  //
+  void mark_entries_render_dirty(stx::Span<size_t const> ids) {
+    for (size_t id : ids) {
+      // ids from widgets that were removed since the last build are ignored
+      if (id >= entries.size()) continue;
+
+      /// NOTE: tile binding is semi-automatic and determined by the offset on
+      /// the layer
+      mark_entry_dirty(entries[id]);
+    }
+  }
+
+  void build(ViewTree const &tree, RenderContext const &render_context) {
     context = &render_context;
 
     // dpr is maintained
@@ -355,50 +1190,77 @@ struct TileCache {
     // backing_store_physical_extent maintained, unless explicitly resized
     // backing_store_resized is maintained
 
-    // backing_store_cache maintained, will be invalidated and marked as dirty
-    // in tick()
-    // backing_store_record maintained, will be discarded and re-recorded in
-    // tick()
+    // the tiles of layers that are still present are maintained (to prevent
+    // re-recording them), they will be resized and discarded in tick as
+    // appropriate and if necessary. the render stage maintains their rasters.
 
-    // cache and record tiles are maintained, will be resized and discarded in
-    // tick as appropriate and if necessary
+    // all tiles are marked as dirty and out of focus, and resized in tick()
 
-    // tiles_extent_dirty is maintained
+    view_tree = &tree;
 
-    // tile_record_is_dirty is all marked as true
+    std::vector<Layer> previous_layers = std::move(layers);
+    layers.clear();
+    layers.push_back(Layer{tree.root_view(), true});
 
-    // tile_is_in_focus is all marked as false and resized as necessary in
-    // tick()
+    build_entries(tree);
+    bind_entry_ids();
 
-    root_view = &view_tree_root;
+    for (Layer &layer : layers) {
+      auto const previous_layer =
+          std::find_if(previous_layers.begin(), previous_layers.end(),
+                       [&layer](Layer const &previous) {
+                         return previous.is_root == layer.is_root &&
+                                previous.widget == layer.widget;
+                       });
 
-    build_entries(view_tree_root);
-    attach_state_proxies();
+      if (previous_layer != previous_layers.end()) {
+        layer.tiles = std::move(previous_layer->tiles);
+      }
+    }
 
-    for (size_t i = 0; i < tile_record_is_dirty.size(); i++) {
-      tile_record_is_dirty[i] = true;
-      tile_is_in_focus[i] = false;
+    // the tiles are only resized (and discarded) if their extent changed
+    mark_all_tile_records_dirty();
+
+    tiles_extent_dirty = true;
+  }
+
+  // records and rasterizes the frame on the calling thread
+  BackingStoreDiff tick(std::chrono::nanoseconds interval) {
+    TileRasterizer::Clock::time_point const frame_begin =
+        TileRasterizer::Clock::now();
+    return render(record(interval), frame_begin);
+  }
+
+  // the render stage of the synchronous tick. the tiles carried over from the
+  // previous frames are rasterized even if nothing was recorded.
+  BackingStoreDiff render(BackingStoreDiff recorded_diff,
+                          TileRasterizer::Clock::time_point frame_begin) {
+    if (recorded_diff == BackingStoreDiff::Some) {
+      rasterizer.render(snapshot, *context, frame_begin);
+      return BackingStoreDiff::Some;
     }
+
+    if (rasterizer.has_stale_tiles()) {
+      rasterizer.resume(snapshot, *context, frame_begin);
+      return BackingStoreDiff::Some;
+    }
+
+    return BackingStoreDiff::None;
   }
 
-  BackingStoreDiff tick(std::chrono::nanoseconds) {
-    // marks that the backing store needs updating
-    bool backing_store_dirty = false;
+  // the UI stage of the tick: re-records the dirty tiles in focus and updates
+  // `snapshot` if the backing store needs to be updated, it is then to be
+  // rendered by a `TileRasterizer`. no rasterization is performed here.
+  BackingStoreDiff record(std::chrono::nanoseconds) {
     BackingStoreDiff backing_store_diff = BackingStoreDiff::None;
 
     if (backing_store_physical_extent_changed) {
-      backing_store_cache.init_surface(*context, backing_store_physical_extent);
-
-      backing_store_dirty = true;
-
       backing_store_physical_extent_changed = false;
 
       backing_store_diff = BackingStoreDiff::Some;
     }
 
     if (backing_store_physical_offset_changed) {
-      backing_store_dirty = true;
-
       backing_store_physical_offset_changed = false;
 
       backing_store_diff = BackingStoreDiff::Some;
@@ -408,29 +1270,16 @@ struct TileCache {
       // layout changes, screen offsets are automatically updated as long as
       // view_tree is cleaned we therefore need to assume that all the tiles are
       // now dirty. and resize? them
-      Extent tiles_logical_extent = root_view->layout_node->self_extent;
-      VExtent tiles_virtual_physical_extent =
-          logical_to_physical(device_pixel_ratio, tiles_logical_extent);
-      Extent tiles_physical_extent =
-          devirtualize_to_extent(tiles_virtual_physical_extent);
-
-      cache_tiles.resize(tiles_physical_extent);
-      record_tiles.resize(cache_tiles.rows(), cache_tiles.columns());
-
-      size_t const num_tiles = record_tiles.get_tiles().size();
-
-      tile_record_is_dirty.resize(num_tiles);
-      tile_is_in_focus.resize(num_tiles);
-
-      // TODO(lamarrr): find a way to ensure we don't discard the recordings
-
-      for (size_t i = 0; i < num_tiles; i++) {
-        tile_record_is_dirty[i] = true;
-        tile_is_in_focus[i] = false;
+      for (Layer &layer : layers) {
+        Extent tiles_logical_extent = layer.get_logical_extent();
+        VExtent tiles_virtual_physical_extent =
+            logical_to_physical(device_pixel_ratio, tiles_logical_extent);
+        Extent tiles_physical_extent =
+            devirtualize_to_extent(tiles_virtual_physical_extent);
+
+        layer.tiles.resize(tiles_physical_extent);
       }
 
-      backing_store_dirty = true;
-
       backing_store_diff = BackingStoreDiff::Some;
 
       tiles_extent_dirty = false;
@@ -438,139 +1287,151 @@ struct TileCache {
 
     IRect backing_store_physical_rect = get_backing_store_physical_rect();
 
-    for (uint32_t j = 0; j < cache_tiles.columns(); j++) {
-      for (uint32_t i = 0; i < cache_tiles.rows(); i++) {
-        IOffset tile_physical_offset{i * kTilePhysicalExtent.width,
-                                     j * kTilePhysicalExtent.height};
-        IRect tile_physical_rect{tile_physical_offset, kTilePhysicalExtent};
-        tile_is_in_focus[j * cache_tiles.rows() + i] =
-            tile_physical_rect.overlaps(backing_store_physical_rect);
-      }
-    }
+    for (Layer &layer : layers) {
+      Layer::CompositeState const state = get_composite_state(layer);
 
-    // subtiles should be marked as dirty and as in focus or out of focus as
-    // necessary before entering here
-    for (size_t i = 0; i < cache_tiles.get_tiles().size(); i++) {
-      RasterCache &cache = cache_tiles.get_tiles()[i];
-      RasterRecord &record = record_tiles.get_tiles()[i];
+      // scrolling or updating the effects of a layer only requires
+      // re-compositing
+      if (layer.composited != state) {
+        layer.composited = state;
 
-      if (tile_is_in_focus[i] && !cache.is_surface_init()) {
-        // add rasterization surface if not present
-        // NOTE: tiles are not initialized with a surface or even recorded until
-        // they are actually in view.
-        cache.init_surface(*context, kTilePhysicalExtent);
+        backing_store_diff = BackingStoreDiff::Some;
       }
 
-      if (!tile_is_in_focus[i]) {
-        cache.deinit_surface();
-        record.discard();
+      IRect physical_focus_rect = backing_store_physical_rect;
+      layer.visible_region = backing_store_physical_rect;
+
+      if (!layer.is_root) {
+        // compositing layers are only in focus in their visible area, with a
+        // margin of a tile so scrolling or sliding doesn't immediately
+        // require rasterization
+        IRect const &ancestors_clip_rect = state.ancestors_clip_rect;
+        SkMatrix screen_to_content;
+
+        if (state.opacity > 0.0f && ancestors_clip_rect.visible() &&
+            ancestors_clip_rect.overlaps(backing_store_physical_rect) &&
+            state.content_to_screen().invert(&screen_to_content)) {
+          IRect const visible_rect =
+              ancestors_clip_rect.intersect(backing_store_physical_rect);
+
+          SkIRect const content_rect =
+              screen_to_content.mapRect(to_sk_rect(visible_rect)).roundOut();
+
+          layer.visible_region =
+              IRect{IOffset{content_rect.x(), content_rect.y()},
+                    Extent{static_cast<uint32_t>(content_rect.width()),
+                           static_cast<uint32_t>(content_rect.height())}};
+
+          physical_focus_rect =
+              IRect{layer.visible_region.offset -
+                        IOffset{kTilePhysicalExtent.width,
+                                kTilePhysicalExtent.height},
+                    layer.visible_region.extent +
+                        Extent{kTilePhysicalExtent.width * 2,
+                               kTilePhysicalExtent.height * 2}};
+        } else {
+          layer.visible_region = IRect{};
+          physical_focus_rect = IRect{};
+        }
       }
 
-      if (tile_is_in_focus[i] && tile_record_is_dirty[i]) {
+      layer.tiles.update_focus(physical_focus_rect);
+
+      if (layer.tiles.begin_recording(device_pixel_ratio)) {
         // mark the backing store as dirty if any of the in-focus tiles is dirty
-        backing_store_dirty = true;
         backing_store_diff = BackingStoreDiff::Some;
-
-        // prepare subtile for recording and rasterization
-        record.discard();
-
-        VRect tile_virtual_logical_rect = physical_to_logical(
-            device_pixel_ratio, IRect{IOffset{0, 0}, kTilePhysicalExtent});
-
-        record.begin_recording(tile_virtual_logical_rect);
       }
     }
 
     for (Entry &entry : entries) {
-      int64_t const nrows = record_tiles.rows();
-      int64_t const ncols = record_tiles.columns();
-
-      IRect entry_logical_area{*entry.screen_offset, *entry.extent};
+      TileSet &tiles = layers[entry.layer].tiles;
+      ViewTree::Entry const &tree_entry = view_tree->entries[entry.view_entry];
 
-      VRect entry_virtual_physical_area =
-          logical_to_physical(device_pixel_ratio, entry_logical_area);
+      int64_t const nrows = tiles.record_tiles.rows();
+      int64_t const ncols = tiles.record_tiles.columns();
 
-      IRect entry_physical_area =
-          devirtualize_to_irect(entry_virtual_physical_area);
+      IRect entry_physical_area = get_physical_area(entry);
 
       auto const [i_begin, i_end, j_begin, j_end] = get_tiles_range(
           kTilePhysicalExtent, nrows, ncols, entry_physical_area);
 
+      // widgets are no longer walked per frame by the pipeline, so their
+      // staleness is updated here
+      bool in_focus = false;
+
       for (int64_t j = j_begin; j < j_end; j++) {
         for (int64_t i = i_begin; i < i_end; i++) {
           int64_t const tile_index = j * nrows + i;
 
-          RasterRecord &record = record_tiles.get_tiles()[tile_index];
+          RasterRecord &record = tiles.record_tiles.get_tiles()[tile_index];
 
-          if (tile_is_in_focus[tile_index]) {
-            WidgetSystemProxy::mark_non_stale(*entry.widget);
-          }
+          in_focus = in_focus || tiles.tile_is_in_focus[tile_index];
 
-          if (tile_is_in_focus[tile_index] &&
-              tile_record_is_dirty[tile_index]) {
+          if (tiles.tile_is_in_focus[tile_index] &&
+              tiles.tile_record_is_dirty[tile_index]) {
             // draw to appropriate position relative to the tile size. and
             // also respect the view clipping
-            IOffset tile_physical_offset{i * kTilePhysicalExtent.width,
-                                         j * kTilePhysicalExtent.height};
-            IRect tile_physical_rect{tile_physical_offset, kTilePhysicalExtent};
+            VRect tile_virtual_logical_rect = physical_to_logical(
+                device_pixel_ratio, tiles.tile_physical_rect(i, j));
 
-            VRect tile_virtual_logical_rect =
-                physical_to_logical(device_pixel_ratio, tile_physical_rect);
+            entry.draw(record, tile_virtual_logical_rect, device_pixel_ratio,
+                       tree_entry);
 
-            entry.draw(record, tile_virtual_logical_rect, device_pixel_ratio);
+            entry.recorded_physical_area = entry_physical_area;
           }
         }
       }
-    }
 
-    for (size_t i = 0; i < cache_tiles.get_tiles().size(); i++) {
-      RasterCache &cache = cache_tiles.get_tiles()[i];
-      RasterRecord &record = record_tiles.get_tiles()[i];
-
-      if (tile_record_is_dirty[i] && tile_is_in_focus[i]) {
-        record.finish_recording();
-
-        // tile caches are only updated if the tile is in focus
-        // we need to submit
-        cache.rasterize(device_pixel_ratio, record);
-
-        tile_record_is_dirty[i] = false;
-      }
+      WidgetSystemProxy::update_visibility(*entry.widget, in_focus);
     }
 
-    // should backing store wrap a backend texture?
-    if (backing_store_dirty) {
-      // accumulate raster cache into backing store
-
-      SkCanvas *sk_canvas = backing_store_cache.get_surface_ref().getCanvas();
-      VLK_ENSURE(sk_canvas != nullptr);
-      sk_canvas->clear(SK_ColorTRANSPARENT);
-
-      int64_t const ncols = cache_tiles.columns();
-      int64_t const nrows = cache_tiles.rows();
-
-      for (int64_t j = 0; j < ncols; j++) {
-        for (int64_t i = 0; i < nrows; i++) {
-          RasterCache &cache = cache_tiles.tile_at_index(i, j);
+    for (Layer &layer : layers) {
+      layer.tiles.finish_recording();
+    }
 
-          IOffset tile_screen_physical_offset{i * kTilePhysicalExtent.width,
-                                              j * kTilePhysicalExtent.height};
+    if (backing_store_diff == BackingStoreDiff::Some) {
+      update_snapshot();
+    }
 
-          IRect tile_screen_physical_rect{tile_screen_physical_offset,
-                                          kTilePhysicalExtent};
+    return backing_store_diff;
+  }
 
-          if (tile_screen_physical_rect.overlaps(backing_store_physical_rect)) {
-            cache.write_to(*sk_canvas, tile_screen_physical_offset -
-                                           backing_store_physical_offset);
-          }
-        }
+  void update_snapshot() {
+    snapshot.device_pixel_ratio = device_pixel_ratio;
+    snapshot.backing_store_physical_extent = backing_store_physical_extent;
+    snapshot.backing_store_physical_offset = backing_store_physical_offset;
+    snapshot.layers.resize(layers.size());
+
+    for (size_t l = 0; l < layers.size(); l++) {
+      Layer const &layer = layers[l];
+      TileSet const &tiles = layer.tiles;
+      FrameSnapshot::Layer &snapshot_layer = snapshot.layers[l];
+
+      snapshot_layer.widget = layer.widget;
+      snapshot_layer.is_root = layer.is_root;
+      snapshot_layer.tile_physical_extent = tiles.tile_physical_extent();
+      snapshot_layer.tiles_physical_extent = tiles.physical_extent();
+      snapshot_layer.composited = layer.composited;
+      snapshot_layer.visible_region = layer.visible_region;
+
+      stx::Span<RasterRecord const> records = tiles.record_tiles.get_tiles();
+      snapshot_layer.tiles.resize(records.size());
+
+      for (size_t i = 0; i < records.size(); i++) {
+        FrameSnapshot::Tile &tile = snapshot_layer.tiles[i];
+        tile.recording = tiles.tile_is_in_focus[i]
+                             ? records[i].share_recording()
+                             : nullptr;
+        tile.is_dirty = tiles.tile_was_recorded[i];
       }
-
-      backing_store_dirty = false;
     }
-
-    return backing_store_diff;
   }
+
+ private:
+  // retained across splices to avoid re-allocating
+  std::vector<Entry> scratch_entries_;
+  std::vector<Entry> merged_entries_;
+  std::vector<Entry> removed_entries_;
 };
 
 }  // namespace ui
@@ -1,48 +1,115 @@
+#pragma once
 
+#include <cinttypes>
+#include <cstddef>
 
+namespace vlk {
+namespace ui {
 
-double Tween::CalculateValue(Tween::Type type, double state) {
-  DCHECK_GE(state, 0);
-  DCHECK_LE(state, 1);
+/// easing curves, mapping the progress of an animation in [0, 1] to the
+/// interpolation factor of its value
+enum class Curve : uint8_t {
+  Linear,
+  /// t^2
+  EaseIn,
+  /// t^4
+  EaseIn2,
+  /// quadratic ease in, then quadratic ease out
+  EaseInOut,
+  /// cubic, fast at the start and the end
+  FastInOut,
+  /// quadratic ease out to 95%, the value snaps to the end on completion
+  EaseOutSnap,
+  /// 1 - (1 - t)^2
+  EaseOut,
+  /// 1 - (1 - t)^3
+  EaseOut2,
+  /// 1 - (1 - t)^4
+  EaseOut3,
+  /// smoothstep: 3t^2 - 2t^3
+  SmoothInOut,
+  /// remains at the start until completion
+  Zero
+};
 
-  switch (type) {
-    case EASE_IN:
-      return pow(state, 2);
+constexpr size_t kNumCurves = static_cast<size_t>(Curve::Zero) + 1;
 
-    case EASE_IN_2:
-      return pow(state, 4);
+namespace impl {
 
-    case EASE_IN_OUT:
-      if (state < 0.5)
-        return pow(state * 2, 2) / 2.0;
-      return 1.0 - (pow((state - 1.0) * 2, 2) / 2.0);
-
-    case FAST_IN_OUT:
-      return (pow(state - 0.5, 3) + 0.125) / 0.25;
-
-    case LINEAR:
-      return state;
-
-    case EASE_OUT_SNAP:
-      state = 0.95 * (1.0 - pow(1.0 - state, 2));
-      return state;
-
-    case EASE_OUT:
-      return 1.0 - pow(1.0 - state, 2);
+// the curves are branch-free (or only use selects), so loops over them are
+// auto-vectorized
+template <Curve C>
+constexpr float ease(float t) {
+  if constexpr (C == Curve::Linear) {
+    return t;
+  } else if constexpr (C == Curve::EaseIn) {
+    return t * t;
+  } else if constexpr (C == Curve::EaseIn2) {
+    float const t2 = t * t;
+    return t2 * t2;
+  } else if constexpr (C == Curve::EaseInOut) {
+    float const u = t - 1.0f;
+    return t < 0.5f ? 2.0f * t * t : 1.0f - 2.0f * u * u;
+  } else if constexpr (C == Curve::FastInOut) {
+    float const u = t - 0.5f;
+    return (u * u * u + 0.125f) * 4.0f;
+  } else if constexpr (C == Curve::EaseOutSnap) {
+    float const u = 1.0f - t;
+    return 0.95f * (1.0f - u * u);
+  } else if constexpr (C == Curve::EaseOut) {
+    float const u = 1.0f - t;
+    return 1.0f - u * u;
+  } else if constexpr (C == Curve::EaseOut2) {
+    float const u = 1.0f - t;
+    return 1.0f - u * u * u;
+  } else if constexpr (C == Curve::EaseOut3) {
+    float const u = 1.0f - t;
+    float const u2 = u * u;
+    return 1.0f - u2 * u2;
+  } else if constexpr (C == Curve::SmoothInOut) {
+    return t * t * (3.0f - 2.0f * t);
+  } else {
+    static_assert(C == Curve::Zero);
+    return 0.0f;
+  }
+}
 
-    case EASE_OUT_2:
-      return 1.0 - pow(1.0 - state, 3);
+}  // namespace impl
 
-    case EASE_OUT_3:
-      return 1.0 - pow(1.0 - state, 4);
+/// evaluates the curve at `t` in [0, 1]
+constexpr float ease(Curve curve, float t) {
+  switch (curve) {
+    case Curve::Linear:
+      return impl::ease<Curve::Linear>(t);
+    case Curve::EaseIn:
+      return impl::ease<Curve::EaseIn>(t);
+    case Curve::EaseIn2:
+      return impl::ease<Curve::EaseIn2>(t);
+    case Curve::EaseInOut:
+      return impl::ease<Curve::EaseInOut>(t);
+    case Curve::FastInOut:
+      return impl::ease<Curve::FastInOut>(t);
+    case Curve::EaseOutSnap:
+      return impl::ease<Curve::EaseOutSnap>(t);
+    case Curve::EaseOut:
+      return impl::ease<Curve::EaseOut>(t);
+    case Curve::EaseOut2:
+      return impl::ease<Curve::EaseOut2>(t);
+    case Curve::EaseOut3:
+      return impl::ease<Curve::EaseOut3>(t);
+    case Curve::SmoothInOut:
+      return impl::ease<Curve::SmoothInOut>(t);
+    case Curve::Zero:
+      return impl::ease<Curve::Zero>(t);
+  }
 
-    case SMOOTH_IN_OUT:
-      return sin(state);
+  return t;
+}
 
-    case ZERO:
-      return 0;
-  }
+/// linearly interpolates between `from` and `to` by the curve's factor at `t`
+constexpr float tween(Curve curve, float from, float to, float t) {
+  return from + (to - from) * ease(curve, t);
+}
 
-  NOTREACHED();
-  return state;
-}
\ No newline at end of file
+}  // namespace ui
+}  // namespace vlk
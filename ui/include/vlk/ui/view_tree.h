@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <limits>
 #include <utility>
 #include <vector>
 
@@ -28,13 +31,6 @@ namespace ui {
 // what if the widget is not visible in b
 //
 
-// translates widget from its normal position on its parent view.
-template <typename T>
-constexpr void view_translate_helper_(T &entry, IOffset const &translation) {
-  entry.effective_parent_view_offset =
-      IOffset(entry.layout_node->parent_view_offset) + translation;
-}
-
 // cache invalidation sources:
 // - view offset change
 // - layout change
@@ -45,6 +41,16 @@ constexpr void view_translate_helper_(T &entry, IOffset const &translation) {
 // invalidates:
 // - tile cache
 //
+// the views and entries are stored in flat arrays and reference their parents
+// by index, so rebuilding the tree doesn't leave any dangling references.
+//
+// the views are stored in depth-first pre-order, so a view's subtree is the
+// contiguous range of views from it up to its `subtree_end`, and a view is
+// always stored after its parent. the entries are grouped by their parent view
+// in the same order. this makes it possible to update the offsets and clips of
+// any subtree in a single top-down pass, with each view and entry only having
+// to look at its direct parent view.
+//
 struct ViewTree {
   // presently we update the effective parent view offset and screen offsets
   // on-demand for each subview and child widgets primarily because we want to
@@ -52,73 +58,63 @@ struct ViewTree {
   // view clip effects are dependent on the views so we don't have to touch to
   // many places in memory to get that result in the final render stage.
 
-  struct View {
-    // all entries are positioned relative to the view
-    // we update the screen offsets
-    // for all the child widgets on scroll
+  // denotes the absence of a view, i.e. the root view's parent or the root
+  // layer
+  static constexpr size_t kNoView = std::numeric_limits<size_t>::max();
 
-    struct Entry {
-      LayoutTree::Node const *layout_node;
+  // non-view widgets
+  struct Entry {
+    LayoutTree::Node *layout_node = nullptr;
 
-      IOffset screen_offset;
+    // the layout nodes of a subtree are rebuilt before its entries are
+    // spliced, so the widget is retained to match the entries across splices
+    Widget *widget = nullptr;
 
-      // offset on the parent view after translation (i.e. by scrolling)
-      IOffset effective_parent_view_offset;
+    IOffset screen_offset;
 
-      // nullptr for root widget only
-      View const *parent;
+    // offset on the parent view after translation (i.e. by scrolling)
+    IOffset effective_parent_view_offset;
 
-      ZIndex z_index;
+    // index of the parent view
+    size_t parent = kNoView;
 
-      IRect clip_rect;
+    ZIndex z_index = 0;
 
-      void build(LayoutTree::Node &init_layout_node, View &view_parent,
-                 ZIndex init_z_index) {
-        // build child widgets, add child views to the tree.
-        // we need
-        // to avoid performing multiple counting on every depth increment.
+    // default z-index of the entry's children
+    ZIndex children_z_index = 0;
 
-        layout_node = &init_layout_node;
+    // one past the index of the last entry in this entry's subtree. the
+    // entries within a view are stored in depth-first pre-order.
+    size_t subtree_end = 0;
 
-        // not yet updated
-        screen_offset = IOffset{};
-        effective_parent_view_offset = IOffset{};
+    IRect clip_rect;
 
-        // we can't know the number of views or entries a view will have ahead
-        // of time fast enough without doing a lot of work, so we can't
-        // pre-allocate the vector for that and bind references to it. instead,
-        // we add the entries/views to the tree and add parent references later
-        // on
-        parent = nullptr;
+    // extent as of the last update
+    Extent extent;
 
-        z_index =
-            init_layout_node.widget->get_z_index().unwrap_or(init_z_index + 0);
+    // index of the view of the compositing layer the widget is rasterized
+    // into. `kNoView` for the root layer, whose content space is the screen.
+    size_t layer = kNoView;
 
-        clip_rect = IRect{};
+    // offset on the layer's content
+    IOffset layer_offset;
 
-        for (LayoutTree::Node &child : init_layout_node.children) {
-          if (child.type == WidgetType::View) {
-            view_parent.subviews.push_back(View{});
-            view_parent.subviews.back().build(child, init_z_index + 1);
-          } else {
-            view_parent.entries.push_back(View::Entry{});
-            view_parent.entries.back().build(child, view_parent,
-                                             init_z_index + 1);
-          }
-        }
-      }
-    };
+    // clip rect on the layer's content. only the views within the layer
+    // clip it, the layer's clip is applied once it is composited.
+    IRect layer_clip_rect;
+  };
 
+  struct View {
     // denotes whether the view offset from the widget is different and now
     // needs to be updated, i.e. by calculating screen_offset and
     // parent_view_offset
     bool is_dirty = true;
 
     // non-null
-    LayoutTree::Node *layout_node;
+    LayoutTree::Node *layout_node = nullptr;
 
     // pre-calculated for the tile cache
-    ZIndex z_index;
+    ZIndex z_index = 0;
 
     // position on the root widget. by screen here, we mean the resulting
     // surface of the root widget.
@@ -127,227 +123,420 @@ struct ViewTree {
     // offset on the parent view after translation (i.e. by scrolling)
     IOffset effective_parent_view_offset;
 
-    // will make processing view clips easier for the tile cache
-    View const *parent;
+    // index of the parent view, `kNoView` for the root view
+    size_t parent = kNoView;
 
-    // non-view widgets. not sorted in any particular order
-    std::vector<Entry> entries;
+    // translation of the view's content (i.e. by scrolling)
+    IOffset translation;
 
-    // view widgets. not sorted in any particular order
-    std::vector<View> subviews;
+    // index of the view of the compositing layer the view's content is
+    // rasterized into. this view's index if it is a layer, otherwise the
+    // parent's. `kNoView` for the root layer.
+    size_t content_layer = kNoView;
 
-    void recursive_mark_view_offset_dirty() {
-      is_dirty = true;
+    // the portion of the view that is visible on the screen, accumulated from
+    // all of its ancestors
+    IRect clip_rect;
 
-      for (auto &subview : subviews) {
-        subview.recursive_mark_view_offset_dirty();
-      }
-    }
+    // screen-space clip applied to the view's content on its content layer.
+    // accumulated from the views between this view and its layer.
+    IRect content_layer_clip_rect;
 
-    void build(LayoutTree::Node &init_layout_node, ZIndex init_z_index) {
-      is_dirty = true;
-      layout_node = &init_layout_node;
-      z_index =
-          init_layout_node.widget->get_z_index().unwrap_or(init_z_index + 0);
-
-      // needs to be updated after building the tree, by recursively
-      // triggering a on_view_offset dirty starting from the root view.
-      screen_offset = IOffset{};
-      effective_parent_view_offset = IOffset{};
-
-      // parents and children are not linked until the building of the whole
-      // tree is done as the addresses will not be stable until then
-      parent = nullptr;
-
-      entries.clear();
-      subviews.clear();
-
-      for (LayoutTree::Node &child : init_layout_node.children) {
-        if (child.type == WidgetType::View) {
-          subviews.push_back(View{});
-          subviews.back().build(child, z_index + 1);
-        } else {
-          entries.push_back(View::Entry{});
-          entries.back().build(child, *this, z_index + 1);
-        }
-      }
+    // one past the index of the last view in this view's subtree
+    size_t subtree_end = 0;
+
+    // range of the view's entries
+    size_t entries_begin = 0;
+    size_t entries_end = 0;
+  };
+
+  ViewTree() = default;
+
+  STX_MAKE_PINNED(ViewTree)
+
+  ~ViewTree() = default;
+
+  // the root view is always the first
+  std::vector<View> views;
+  std::vector<Entry> entries;
+  bool any_view_dirty = true;
+
+  // indices of the entries whose clip rect changed on the last tick. used for
+  // incrementally updating the hit-test index.
+  std::vector<size_t> changed_entries;
+
+  // indices of the entries whose area on their layer changed on the last
+  // tick. the tiles they were and are now recorded into need to be
+  // re-recorded.
+  std::vector<size_t> moved_entries;
+
+  // a range of entries replaced by a subtree-local rebuild
+  struct EntrySplice {
+    size_t begin = 0;
+
+    // one past the last removed entry, as indexed before the splice
+    size_t removed_end = 0;
+
+    // one past the last inserted entry
+    size_t inserted_end = 0;
+
+    int64_t delta() const {
+      return static_cast<int64_t>(inserted_end) -
+             static_cast<int64_t>(removed_end);
     }
+  };
+
+  View &root_view() { return views[0]; }
+
+  View const &root_view() const { return views[0]; }
+
+  // offset of the layer's content on the screen
+  IOffset get_layer_origin(size_t layer) const {
+    if (layer == kNoView) return IOffset{0, 0};
+    return views[layer].screen_offset + views[layer].translation;
+  }
 
-    static void update_screen_offset_helper_(View &subview,
-                                             View const &parent) {
-      subview.screen_offset =
-          parent.screen_offset + subview.effective_parent_view_offset;
-      // remember: views do not have render data so they will not invalidate
-      // any area of the tile cache
+  // intersection of `rect` with `clip`. the result has no extent (but retains
+  // `rect`'s offset) if they don't overlap.
+  static IRect clip_rect_helper_(IRect const &clip, IRect const &rect) {
+    if (!clip.visible() || !clip.overlaps(rect)) {
+      return rect.with_extent(Extent{0, 0});
     }
+    return clip.intersect(rect);
+  }
 
-    static void update_screen_offset_helper_(View::Entry &entry,
-                                             View const &parent) {
-      IOffset const new_screen_offset =
-          parent.screen_offset + entry.effective_parent_view_offset;
+  void update_entry_(size_t index, View const &parent) {
+    Entry &entry = entries[index];
 
-      IRect const previous_clip_rect = entry.clip_rect;
+    entry.effective_parent_view_offset =
+        IOffset(entry.layout_node->parent_view_offset) + parent.translation;
 
-      ViewTree::View const *ancestor = entry.parent;
+    IOffset const new_screen_offset =
+        parent.screen_offset + entry.effective_parent_view_offset;
 
-      IRect new_clip_rect =
-          IRect{new_screen_offset, entry.layout_node->self_extent};
+    IRect const screen_rect{new_screen_offset, entry.layout_node->self_extent};
 
-      while (ancestor != nullptr && new_clip_rect.visible()) {
-        IRect ancestor_view_screen_rect{ancestor->screen_offset,
-                                        ancestor->layout_node->self_extent};
+    IOffset const layer_origin = get_layer_origin(entry.layer);
 
-        if (!ancestor_view_screen_rect.overlaps(new_clip_rect)) {
-          new_clip_rect = new_clip_rect.with_extent(Extent{0, 0});
-        } else {
-          new_clip_rect = ancestor_view_screen_rect.intersect(new_clip_rect);
-        }
+    IRect new_layer_clip_rect =
+        clip_rect_helper_(parent.content_layer_clip_rect, screen_rect);
+    new_layer_clip_rect = new_layer_clip_rect.with_offset(
+        new_layer_clip_rect.offset - layer_origin);
+
+    IOffset const new_layer_offset = new_screen_offset - layer_origin;
 
-        ancestor = ancestor->parent;
+    IRect const previous_layer_clip_rect = entry.layer_clip_rect;
+    Extent const previous_extent = entry.extent;
+
+    IRect const new_clip_rect =
+        clip_rect_helper_(parent.clip_rect, screen_rect);
+
+    if (entry.clip_rect != new_clip_rect) {
+      changed_entries.push_back(index);
+    }
+
+    entry.screen_offset = new_screen_offset;
+    entry.clip_rect = new_clip_rect;
+    entry.extent = entry.layout_node->self_extent;
+
+    // the widget's rasterized content is only invalidated if it moved or was
+    // resized within its layer. moving the layer (i.e. scrolling a scroll
+    // layer) only changes where the layer is composited.
+    //
+    // only mark intersecting tiles as dirty if its clip rect is visible
+    if (entry.layer_offset != new_layer_offset ||
+        previous_layer_clip_rect != new_layer_clip_rect ||
+        previous_extent != entry.extent) {
+      entry.layer_offset = new_layer_offset;
+      entry.layer_clip_rect = new_layer_clip_rect;
+
+      // the tile cache marks both the tiles the widget was previously
+      // recorded into and its new tiles as dirty
+      if (previous_layer_clip_rect.visible() ||
+          new_layer_clip_rect.visible()) {
+        moved_entries.push_back(index);
       }
+    }
+  }
 
-      entry.clip_rect = new_clip_rect;
+  // updates the view at `index` and its entries. its parent view must have
+  // been updated.
+  void update_view_(size_t index) {
+    View &view = views[index];
 
-      // only mark intersecting tiles as dirty if its clip rect is visible
+    if (view.is_dirty) {
+      view.translation = view.layout_node->widget->get_view_offset().resolve(
+          view.layout_node->view_extent);
+      view.is_dirty = false;
+    }
 
-      if (entry.screen_offset != new_screen_offset) {
-        // call the callback so the tile cache is aware that its entries are
-        // now dirty, both before and after changing position
-        if (previous_clip_rect.visible()) {
-          entry.layout_node->widget->mark_render_dirty();
-        }
+    if (view.parent == kNoView) {
+      view.effective_parent_view_offset = IOffset{0, 0};
+      view.screen_offset = IOffset{0, 0};
+      view.clip_rect = IRect{view.screen_offset, view.layout_node->self_extent};
+      view.content_layer_clip_rect = view.clip_rect;
+    } else {
+      View const &parent = views[view.parent];
+
+      view.effective_parent_view_offset =
+          IOffset(view.layout_node->parent_view_offset) + parent.translation;
+      view.screen_offset =
+          parent.screen_offset + view.effective_parent_view_offset;
+
+      IRect const screen_rect{view.screen_offset,
+                              view.layout_node->self_extent};
+
+      view.clip_rect = clip_rect_helper_(parent.clip_rect, screen_rect);
+
+      if (view.content_layer == index) {
+        // the layer's own clip and that of its ancestors are only applied when
+        // compositing the layer. its content is only bounded by the layer's
+        // extent.
+        view.content_layer_clip_rect =
+            IRect{view.screen_offset + view.translation,
+                  view.layout_node->view_extent};
+      } else {
+        view.content_layer_clip_rect =
+            clip_rect_helper_(parent.content_layer_clip_rect, screen_rect);
+      }
+    }
 
-        entry.screen_offset = new_screen_offset;
+    for (size_t i = view.entries_begin; i < view.entries_end; i++) {
+      update_entry_(i, view);
+    }
+  }
 
-        if (new_clip_rect.visible()) {
-          entry.layout_node->widget->mark_render_dirty();
+  void clean_offsets() {
+    if (!any_view_dirty) return;
+
+    // a dirty view's descendants need to be updated irregardless of whether
+    // they are dirty, the clean views outside its subtree are skipped
+    size_t index = 0;
+    while (index < views.size()) {
+      if (views[index].is_dirty) {
+        size_t const subtree_end = views[index].subtree_end;
+        for (; index < subtree_end; index++) {
+          update_view_(index);
         }
+      } else {
+        index++;
       }
     }
 
-    static void update_screen_offset(View &child, View &parent) {
-      update_screen_offset_helper_(child, parent);
+    any_view_dirty = false;
+  }
 
-      for (View::Entry &entry : child.entries) {
-        update_screen_offset_helper_(entry, child);
-      }
+  void force_clean_offsets() {
+    for (View &view : views) {
+      view.is_dirty = true;
+    }
 
-      for (View &subview : child.subviews) {
-        update_screen_offset(subview, child);
-      }
+    any_view_dirty = true;
+    clean_offsets();
+  }
+
+  void mark_views_dirty() {
+    any_view_dirty = true;
+
+    for (View &view : views) {
+      view.is_dirty = true;
     }
+  }
 
-    void translate(IOffset const &translation) {
-      // adjust the view offset of the parent view.
-      // and shifts (translates) the children accordingly. we have to
-      // recursively perform passes to update the sceen offsets in the
-      // children.
-
-      for (View::Entry &child : entries) {
-        // translate the children's effective parent view offset by
-        // `translation`.
-        view_translate_helper_(child, translation);
-        // update the resulting screen offset to match the new view position
-        // using the parent view's
-        update_screen_offset_helper_(child, *this);
-      }
+  void build_views_(LayoutTree::Node &node, size_t parent,
+                    ZIndex init_z_index) {
+    size_t const index = views.size();
+
+    View view{};
+    view.layout_node = &node;
+    view.z_index = node.widget->get_z_index().unwrap_or(init_z_index + 0);
+    view.parent = parent;
+
+    // the root view's content is always on the root layer
+    if (parent == kNoView) {
+      view.content_layer = kNoView;
+    } else if (node.widget->is_layer()) {
+      view.content_layer = index;
+    } else {
+      view.content_layer = views[parent].content_layer;
+    }
+
+    views.push_back(view);
+
+    WidgetSystemProxy::bind_view_id(*node.widget, index);
 
-      // NOTE: that this only requires that we update this view's child views
-      // offset and no need for translating them relative to their parent view
-      for (View &subview : subviews) {
-        view_translate_helper_(subview, translation);
-        update_screen_offset(subview, *this);
+    build_subviews_(node, index, view.z_index + 1);
+
+    views[index].subtree_end = views.size();
+  }
+
+  // adds the views nested within the non-view descendants of `node`
+  void build_subviews_(LayoutTree::Node &node, size_t parent,
+                       ZIndex init_z_index) {
+    for (LayoutTree::Node &child : node.children) {
+      if (child.type == WidgetType::View) {
+        build_views_(child, parent, init_z_index);
+      } else {
+        build_subviews_(child, parent, init_z_index + 1);
       }
     }
+  }
 
-    void clean_offsets() {
-      // its offset could be correct and its children offset be incorrect so
-      // we still need to recurse to the children irregardless
-      if (is_dirty) {
-        IOffset const translation =
-            layout_node->widget->get_view_offset().resolve(
-                layout_node->view_extent);
-        translate(translation);
-        is_dirty = false;
-      }
+  // adds the non-view descendants of `node` that aren't within a subview to
+  // `out`, whose first element is to be stored at `base` on `entries`
+  void build_entries_(std::vector<Entry> &out, size_t base,
+                      LayoutTree::Node &node, size_t parent,
+                      ZIndex init_z_index) {
+    for (LayoutTree::Node &child : node.children) {
+      if (child.type == WidgetType::View) continue;
 
-      for (View &subview : subviews) {
-        subview.clean_offsets();
-      }
+      size_t const index = out.size();
+
+      Entry entry{};
+      entry.layout_node = &child;
+      entry.widget = child.widget;
+      entry.parent = parent;
+      entry.z_index = child.widget->get_z_index().unwrap_or(init_z_index + 0);
+      entry.children_z_index = init_z_index + 1;
+      entry.layer = views[parent].content_layer;
+
+      out.push_back(entry);
+
+      build_entries_(out, base, child, parent, init_z_index + 1);
+
+      out[index].subtree_end = base + out.size();
     }
+  }
 
-    void force_clean_offsets() {
-      IOffset const translation =
-          layout_node->widget->get_view_offset().resolve(
-              layout_node->view_extent);
-      translate(translation);
-      is_dirty = false;
+  // replaces the entries in [begin, end) with the non-view descendants of
+  // `node`, which must not have any view descendant. the subsequent indices
+  // are shifted accordingly.
+  EntrySplice splice_entries_(size_t view, size_t begin, size_t end,
+                              LayoutTree::Node &node, ZIndex init_z_index) {
+    scratch_entries_.clear();
+    build_entries_(scratch_entries_, begin, node, view, init_z_index);
 
-      for (View &subview : subviews) {
-        subview.force_clean_offsets();
-      }
+    // the widgets that persist across the splice retain their geometry, so
+    // they are only re-recorded if they moved
+    previous_entries_.clear();
+
+    for (size_t i = begin; i < end; i++) {
+      previous_entries_.emplace_back(entries[i].widget, i);
     }
 
-    void attach_state_proxies_and_parent_refs(bool &any_view_dirty) {
-      WidgetSystemProxy::get_state_proxy(*layout_node->widget)
-          .on_view_offset_dirty =
-          stx::fn::rc::make_functor(stx::os_allocator,
-                                    ([this, &any_view_dirty] {
-                                      this->is_dirty = true;
-                                      any_view_dirty = true;
-                                    }))
-              .unwrap();
-
-      for (View::Entry &entry : entries) {
-        entry.parent = this;
-      }
+    std::sort(previous_entries_.begin(), previous_entries_.end());
 
-      for (View &subview : subviews) {
-        subview.parent = this;
-        subview.attach_state_proxies_and_parent_refs(any_view_dirty);
+    for (Entry &entry : scratch_entries_) {
+      if (!WidgetSystemProxy::is_bound(*entry.widget)) continue;
+
+      auto const previous = std::lower_bound(
+          previous_entries_.begin(), previous_entries_.end(),
+          std::make_pair(entry.widget, size_t{0}));
+
+      if (previous == previous_entries_.end() ||
+          previous->first != entry.widget) {
+        continue;
       }
+
+      Entry const &previous_entry = entries[previous->second];
+      entry.screen_offset = previous_entry.screen_offset;
+      entry.effective_parent_view_offset =
+          previous_entry.effective_parent_view_offset;
+      entry.clip_rect = previous_entry.clip_rect;
+      entry.extent = previous_entry.extent;
+      entry.layer_offset = previous_entry.layer_offset;
+      entry.layer_clip_rect = previous_entry.layer_clip_rect;
     }
-  };
 
-  ViewTree() = default;
+    EntrySplice const splice{begin, end, begin + scratch_entries_.size()};
+    int64_t const delta = splice.delta();
 
-  STX_MAKE_PINNED(ViewTree)
+    entries.erase(entries.begin() + begin, entries.begin() + end);
+    entries.insert(entries.begin() + begin, scratch_entries_.begin(),
+                   scratch_entries_.end());
 
-  ~ViewTree() = default;
+    // the ancestors of the range within the view
+    for (size_t i = views[view].entries_begin; i < begin; i++) {
+      if (entries[i].subtree_end >= end) entries[i].subtree_end += delta;
+    }
 
-  View root_view{};
-  bool any_view_dirty = true;
+    for (size_t i = splice.inserted_end; i < entries.size(); i++) {
+      entries[i].subtree_end += delta;
+    }
 
-  void clean_offsets() {
-    if (any_view_dirty) {
-      root_view.clean_offsets();
-      any_view_dirty = false;
+    views[view].entries_end += delta;
+
+    for (size_t i = view + 1; i < views.size(); i++) {
+      views[i].entries_begin += delta;
+      views[i].entries_end += delta;
     }
+
+    // the indices are no longer valid
+    changed_entries.clear();
+    moved_entries.clear();
+
+    views[view].is_dirty = true;
+    any_view_dirty = true;
+
+    return splice;
   }
 
-  void force_clean_offsets() {
-    root_view.force_clean_offsets();
-    any_view_dirty = false;
+  // rebuilds the entries of a view, whose layout node's subtree was rebuilt
+  EntrySplice rebuild_view_entries(size_t view) {
+    View const &target = views[view];
+    return splice_entries_(view, target.entries_begin, target.entries_end,
+                           *target.layout_node, target.z_index + 1);
   }
 
-  void mark_views_dirty() {
-    any_view_dirty = true;
-    root_view.recursive_mark_view_offset_dirty();
+  // rebuilds the descendants of an entry, whose layout node's subtree was
+  // rebuilt
+  EntrySplice rebuild_entry_subtree(size_t entry) {
+    Entry const &target = entries[entry];
+    return splice_entries_(target.parent, entry + 1, target.subtree_end,
+                           *target.layout_node, target.children_z_index);
   }
 
-  void attach_state_proxies_and_parent_refs() {
-    root_view.attach_state_proxies_and_parent_refs(any_view_dirty);
+  // drains the ids of the views whose view offset changed
+  void mark_views_dirty(stx::Span<size_t const> ids) {
+    for (size_t id : ids) {
+      // ids from widgets that were removed since the last build are ignored
+      if (id >= views.size()) continue;
+      views[id].is_dirty = true;
+      any_view_dirty = true;
+    }
   }
 
   void build(LayoutTree::Node &tree_root) {
     VLK_ENSURE(tree_root.type == WidgetType::View);
 
+    // the vectors retain their capacity across rebuilds
+    views.clear();
+    entries.clear();
+    changed_entries.clear();
+    moved_entries.clear();
+
+    build_views_(tree_root, kNoView, 0);
+
+    for (size_t index = 0; index < views.size(); index++) {
+      views[index].entries_begin = entries.size();
+      build_entries_(entries, 0, *views[index].layout_node, index,
+                     views[index].z_index + 1);
+      views[index].entries_end = entries.size();
+    }
+
     any_view_dirty = true;
-    root_view.build(tree_root, 0);
-    attach_state_proxies_and_parent_refs();
   }
 
-  void tick(std::chrono::nanoseconds) { clean_offsets(); }
+  void tick(std::chrono::nanoseconds) {
+    changed_entries.clear();
+    moved_entries.clear();
+    clean_offsets();
+  }
+
+ private:
+  // retained across splices to avoid re-allocating
+  std::vector<Entry> scratch_entries_;
+  std::vector<std::pair<Widget *, size_t>> previous_entries_;
 };
 
 }  // namespace ui
@@ -4,7 +4,9 @@
 #include <chrono>
 #include <cinttypes>
 #include <functional>
+#include <limits>
 #include <string_view>
+#include <vector>
 
 #include "stx/fn.h"
 #include "stx/option.h"
@@ -13,6 +15,8 @@
 #include "stx/struct.h"
 #include "vlk/subsystem/context.h"
 #include "vlk/ui/canvas.h"
+#include "vlk/ui/event.h"
+#include "vlk/ui/layer_effects.h"
 #include "vlk/ui/layout.h"
 #include "vlk/utils.h"
 
@@ -43,31 +47,75 @@ enum class WidgetDirtiness : uint8_t {
 
 STX_DEFINE_ENUM_BIT_OPS(WidgetDirtiness)
 
+/// how a widget subscribed to ticks is ticked whilst it is off-screen, i.e. an
+/// animation scrolled out of view
+enum class OffscreenTickPolicy : uint8_t {
+  /// ticked on every frame, regardless of its visibility
+  Always,
+  /// ticked at most once every `Widget::kOffscreenTickPeriod`, with the
+  /// interval elapsed since its last tick
+  Throttle,
+  /// not ticked until it is visible again, then ticked with the interval
+  /// elapsed whilst it was paused
+  Pause
+};
+
 struct WidgetDebugInfo {
   std::string_view name = "<unnamed>";
   std::string_view type_hint = "<none>";
 };
 
-// binds to different parts of the the pipeline and its trees that we want to
-// abstract as much as possible. the callbacks also function to capture various
-// values.
-struct WidgetStateProxy {
-  /// informs the system that the widget's render data has changed
-  stx::RcFn<void()> on_render_dirty = stx::fn::rc::make_static([]() {});
-
-  /// informs the system that the widget's layout has changed
-  stx::RcFn<void()> on_layout_dirty = stx::fn::rc::make_static([]() {});
-
-  /// informs the system that a view-widgets's offset (or visible area)
-  /// has changed
-  stx::RcFn<void()> on_view_offset_dirty = stx::fn::rc::make_static([]() {});
+struct Widget;
 
-  /// informs the system that the widget's children has changed (possibly
-  /// requiring a full rebuild of the pipeline)
-  stx::RcFn<void()> on_children_changed = stx::fn::rc::make_static([]() {});
-
-  /// we need to be able to consult the tree for the widget's offset i.e. in the
-  /// scenario where we need to scroll to it
+// the pipeline's stages are informed of the widgets' dirtiness through these
+// queues. the pipeline owns them, and the widgets push onto them as they are
+// ticked, using the ids the stages assigned them on the last build. each stage
+// then drains its queue in bulk.
+//
+// the pipeline only ticks the widgets in the active set, that is, widgets that
+// subscribed to ticks or have pending dirtiness. static widgets thus cost
+// nothing per frame.
+struct WidgetDirtyQueues {
+  /// the id of a widget that isn't bound to a stage
+  static constexpr size_t kNoId = std::numeric_limits<size_t>::max();
+
+  /// a widget's children have changed, requiring a rebuild of the subtrees
+  /// of the widgets whose children changed. set as soon as the children are
+  /// updated, as the removed ones could be deleted before the next frame.
+  bool children_changed = false;
+
+  /// ids of the view tree's views whose children have changed
+  std::vector<size_t> children_dirty_views;
+
+  /// ids of the tile cache's entries whose children have changed
+  std::vector<size_t> children_dirty_entries;
+
+  /// a widget's layout has changed
+  bool layout_dirty = false;
+
+  /// ids of the view tree's views whose view offset (or visible area) has
+  /// changed
+  std::vector<size_t> view_offset_dirty;
+
+  /// ids of the tile cache's entries whose render data has changed
+  std::vector<size_t> render_dirty;
+
+  /// widgets to be processed on the next frame. the slots of widgets that are
+  /// deleted are set to `nullptr`.
+  std::vector<Widget *> active_widgets;
+
+  /// total interval ticked by the pipeline. used to resume the widgets whose
+  /// ticks were paused whilst they were off-screen.
+  std::chrono::nanoseconds time{0};
+
+  void clear() {
+    children_changed = false;
+    layout_dirty = false;
+    children_dirty_views.clear();
+    children_dirty_entries.clear();
+    view_offset_dirty.clear();
+    render_dirty.clear();
+  }
 };
 
 // important: if layout is updated multiple times in between ticks the ticked
@@ -87,6 +135,10 @@ struct Widget {
 
   STX_MAKE_PINNED(Widget)
 
+  /// the minimum interval between the ticks of throttled off-screen widgets
+  static constexpr std::chrono::nanoseconds kOffscreenTickPeriod =
+      std::chrono::milliseconds(250);
+
   Widget(WidgetType type = WidgetType::Render, bool is_flex = false,
          SelfExtent self_extent = SelfExtent{}, bool needs_trimming = false,
          Padding padding = Padding{}, Flex flex = Flex{},
@@ -108,8 +160,7 @@ struct Widget {
         view_fit_{view_fit},
         z_index_{z_index},
         debug_info_{debug_info},
-        dirtiness_{WidgetDirtiness::None},
-        state_proxy_{} {}
+        dirtiness_{WidgetDirtiness::None} {}
 
   WidgetType get_type() const { return type_; }
 
@@ -119,6 +170,12 @@ struct Widget {
 
   bool needs_trimming() const { return needs_trimming_; }
 
+  bool places_children() const { return places_children_; }
+
+  bool is_layer() const { return is_layer_; }
+
+  LayerEffects get_layer_effects() const { return layer_effects_; }
+
   Padding get_padding() const { return padding_; }
 
   Flex get_flex() const { return flex_; }
@@ -141,6 +198,14 @@ struct Widget {
 
   bool is_stale() const { return is_stale_; }
 
+  OffscreenTickPolicy get_offscreen_tick_policy() const {
+    return offscreen_tick_policy_;
+  }
+
+  /// the extent the layout system resolved for this widget on the last
+  /// layout pass. i.e. the visible extent of a view widget.
+  Extent get_layout_extent() const { return layout_extent_; }
+
   /// create draw commands
   /// NOTE: states, variables, or properties that could affect rendering must
   /// not change in the draw method until `mark_rendering_dirty()` is called,
@@ -160,12 +225,93 @@ struct Widget {
 
   virtual Extent trim(Extent extent) { return extent; }
 
-  virtual ~Widget() {}
+  /// called once the widget enters or leaves the area that is rendered (the
+  /// visible area and a margin around it), i.e. to release resources that
+  /// are only needed for drawing and re-acquire them once it is visible
+  /// again. widgets are initially not visible. only called for widgets that
+  /// are not views.
+  ///
+  /// called whilst the tiles are being recorded, the dirtiness the widget
+  /// adds here is processed on the next frame.
+  virtual void on_visibility_changed([[maybe_unused]] bool is_visible) {
+    // no-op
+  }
+
+  /// called once the layout pass resolved a different extent for the widget,
+  /// i.e. to re-subscribe to ticks if the widget's content depends on it.
+  ///
+  /// called whilst laying out, the dirtiness the widget adds here is
+  /// processed on the next frame.
+  virtual void on_layout_extent_changed([[maybe_unused]] Extent extent) {
+    // no-op
+  }
+
+  /// called with the mouse button events that hit the widget. the event's
+  /// offset is relative to the widget's top-left corner.
+  ///
+  /// returns whether the widget consumed the event. unconsumed events are
+  /// dispatched to the next widget beneath it.
+  virtual bool on_mouse_button([[maybe_unused]] MouseButtonEvent const &event) {
+    return false;
+  }
+
+  /// called with the mouse motion events that hit the widget. the event's
+  /// offset is relative to the widget's top-left corner.
+  ///
+  /// returns whether the widget consumed the event. unconsumed events are
+  /// dispatched to the next widget beneath it.
+  virtual bool on_mouse_motion([[maybe_unused]] MouseMotionEvent const &event) {
+    return false;
+  }
+
+  /// called with the mouse wheel events whose pointer is over the widget. the
+  /// event's offset is relative to the widget's top-left corner.
+  ///
+  /// returns whether the widget consumed the event. unconsumed events are
+  /// dispatched to the next widget beneath it.
+  virtual bool on_mouse_wheel([[maybe_unused]] MouseWheelEvent const &event) {
+    return false;
+  }
+
+  /// for non-flex widgets that place their children themselves (see
+  /// `init_places_children`). returns the rect the child at `index` occupies
+  /// relative to the widget's content rect (or the view's content rect for view
+  /// widgets).
+  virtual Rect get_child_rect([[maybe_unused]] size_t index,
+                              Extent content_extent) {
+    return Rect{Offset{0, 0}, content_extent};
+  }
+
+  /// for non-flex widgets that place their children themselves. returns the
+  /// extent spanned by all of the children, for view widgets this is used as
+  /// the extent of the view's content.
+  virtual Extent get_children_span(Extent content_extent) {
+    return content_extent;
+  }
+
+  virtual ~Widget() {
+    if (dirty_queues_ != nullptr && active_slot_ != WidgetDirtyQueues::kNoId) {
+      dirty_queues_->active_widgets[active_slot_] = nullptr;
+    }
+  }
 
   void init_type(WidgetType type) { type_ = type; }
 
   void init_is_flex(bool is_flex) { is_flex_ = is_flex; }
 
+  /// the widget places its children using `get_child_rect` instead of the
+  /// flex layout. this enables arithmetic layouts (i.e. grids) that don't
+  /// need a pass over their siblings.
+  void init_places_children(bool places_children) {
+    VLK_ENSURE(!is_flex(), "Flex Widgets can't place their children", *this);
+    places_children_ = places_children;
+  }
+
+  /// off-screen widgets are throttled by default
+  void init_offscreen_tick_policy(OffscreenTickPolicy policy) {
+    offscreen_tick_policy_ = policy;
+  }
+
   void update_self_extent(SelfExtent self_extent) {
     if (self_extent_ != self_extent) {
       self_extent_ = self_extent;
@@ -204,7 +350,9 @@ struct Widget {
   void update_children(stx::Span<Widget *const> children) {
     // we assume the memory has been released or the widget still uses the same
     // children span but with the child widgets pointers changed
-    VLK_ENSURE(is_flex(), "Widget is not a flex type", *this);
+    VLK_ENSURE(is_flex() || places_children(),
+               "Widget is not a flex type nor does it place its children",
+               *this);
     children_ = children;
     mark_children_dirty();
   }
@@ -236,39 +384,135 @@ struct Widget {
     }
   }
 
+  /// promotes the view's subtree to a compositing layer. the view's content
+  /// is rasterized once into its own tiles (in the view's content space).
+  /// scrolling the view or updating its layer effects only changes how the
+  /// tiles are composited, so the children are not re-recorded nor
+  /// re-rasterized. best suited for views that are frequently scrolled or
+  /// animated.
+  void init_is_layer(bool is_layer) {
+    VLK_ENSURE(get_type() == WidgetType::View, "Widget is not a view type",
+               *this);
+    is_layer_ = is_layer;
+  }
+
+  /// the tile cache picks up the new effects on its next tick, without
+  /// re-rasterizing the layer. the widget is activated so the pipeline isn't
+  /// left idle before then.
+  void update_layer_effects(LayerEffects const &layer_effects) {
+    VLK_ENSURE(is_layer(), "Widget is not a compositing layer", *this);
+    layer_effects_ = layer_effects;
+    activate();
+  }
+
   void init_z_index(stx::Option<ZIndex> z_index) { z_index_ = z_index; }
 
   void set_debug_info(WidgetDebugInfo info) { debug_info_ = info; }
 
-  void add_dirtiness(WidgetDirtiness dirtiness) { dirtiness_ |= dirtiness; }
+  void add_dirtiness(WidgetDirtiness dirtiness) {
+    dirtiness_ |= dirtiness;
 
-  void mark_children_dirty() { dirtiness_ |= WidgetDirtiness::Children; }
+    if (dirty_queues_ != nullptr &&
+        (dirtiness & WidgetDirtiness::Children) != WidgetDirtiness::None) {
+      dirty_queues_->children_changed = true;
+    }
 
-  void mark_layout_dirty() { dirtiness_ |= WidgetDirtiness::Layout; }
+    activate();
+  }
 
-  void mark_view_offset_dirty() { dirtiness_ |= WidgetDirtiness::ViewOffset; }
+  void mark_children_dirty() { add_dirtiness(WidgetDirtiness::Children); }
 
-  void mark_render_dirty() { dirtiness_ |= WidgetDirtiness::Render; }
+  void mark_layout_dirty() { add_dirtiness(WidgetDirtiness::Layout); }
 
- private:
-  void system_tick(std::chrono::nanoseconds interval,
-                   SubsystemsContext const &subsystems) {
-    tick(interval, subsystems);
+  void mark_view_offset_dirty() { add_dirtiness(WidgetDirtiness::ViewOffset); }
 
-    if ((dirtiness_ & WidgetDirtiness::Children) != WidgetDirtiness::None) {
-      state_proxy_.on_children_changed.handle();
-    }
+  void mark_render_dirty() { add_dirtiness(WidgetDirtiness::Render); }
+
+  /// requests for `tick` to be called on every frame, i.e. whilst animating or
+  /// awaiting a future. widgets are not ticked unless subscribed.
+  void subscribe_ticks() {
+    is_subscribed_to_ticks_ = true;
+    activate();
+  }
+
+  /// stops the ticks once the widget no longer has any work to do per-frame
+  void unsubscribe_ticks() { is_subscribed_to_ticks_ = false; }
+
+  bool is_subscribed_to_ticks() const { return is_subscribed_to_ticks_; }
 
-    if ((dirtiness_ & WidgetDirtiness::Layout) != WidgetDirtiness::None) {
-      state_proxy_.on_layout_dirty.handle();
+ private:
+  // adds the widget to the pipeline's active set
+  void activate() {
+    if (dirty_queues_ != nullptr && active_slot_ == WidgetDirtyQueues::kNoId) {
+      // the widget is resumed with the interval elapsed whilst it was parked
+      if (is_tick_parked_) {
+        is_tick_parked_ = false;
+        if (dirty_queues_->time > parked_time_) {
+          skipped_interval_ += dirty_queues_->time - parked_time_;
+        }
+      }
+      active_slot_ = dirty_queues_->active_widgets.size();
+      dirty_queues_->active_widgets.push_back(this);
     }
+  }
+
+  // whether the widget is off-screen and its ticks are paused until it is
+  // visible again. views are never off-screen.
+  bool is_tick_paused() const {
+    return is_stale_ && entry_id_ != WidgetDirtyQueues::kNoId &&
+           offscreen_tick_policy_ == OffscreenTickPolicy::Pause;
+  }
 
-    if ((dirtiness_ & WidgetDirtiness::Render) != WidgetDirtiness::None) {
-      state_proxy_.on_render_dirty.handle();
+  void system_tick(std::chrono::nanoseconds interval,
+                   SubsystemsContext const &subsystems) {
+    std::chrono::nanoseconds const elapsed = skipped_interval_ + interval;
+
+    // off-screen widgets are ticked at a reduced rate (or not at all) until
+    // they are visible again
+    bool const skip =
+        is_tick_paused() ||
+        (is_stale_ && entry_id_ != WidgetDirtyQueues::kNoId &&
+         offscreen_tick_policy_ == OffscreenTickPolicy::Throttle &&
+         elapsed < kOffscreenTickPeriod);
+
+    if (skip) {
+      skipped_interval_ = elapsed;
+    } else {
+      skipped_interval_ = std::chrono::nanoseconds{0};
+      tick(elapsed, subsystems);
     }
 
-    if ((dirtiness_ & WidgetDirtiness::ViewOffset) != WidgetDirtiness::None) {
-      state_proxy_.on_view_offset_dirty.handle();
+    flush_dirtiness();
+  }
+
+  void flush_dirtiness() {
+    // widgets that are not yet bound to the pipeline will be fully processed
+    // once they are bound on the next build
+    if (dirty_queues_ != nullptr && dirtiness_ != WidgetDirtiness::None) {
+      if ((dirtiness_ & WidgetDirtiness::Children) != WidgetDirtiness::None) {
+        dirty_queues_->children_changed = true;
+
+        // every widget on the trees is either a view or an entry
+        if (view_id_ != WidgetDirtyQueues::kNoId) {
+          dirty_queues_->children_dirty_views.push_back(view_id_);
+        } else if (entry_id_ != WidgetDirtyQueues::kNoId) {
+          dirty_queues_->children_dirty_entries.push_back(entry_id_);
+        }
+      }
+
+      if ((dirtiness_ & WidgetDirtiness::Layout) != WidgetDirtiness::None) {
+        dirty_queues_->layout_dirty = true;
+      }
+
+      if ((dirtiness_ & WidgetDirtiness::Render) != WidgetDirtiness::None &&
+          entry_id_ != WidgetDirtyQueues::kNoId) {
+        dirty_queues_->render_dirty.push_back(entry_id_);
+      }
+
+      if ((dirtiness_ & WidgetDirtiness::ViewOffset) != WidgetDirtiness::None &&
+          view_id_ != WidgetDirtyQueues::kNoId) {
+        dirty_queues_->view_offset_dirty.push_back(view_id_);
+      }
     }
 
     dirtiness_ = WidgetDirtiness::None;
@@ -280,21 +524,28 @@ struct Widget {
   /// constant throughout lifetime
   bool is_flex_;
 
-  /// variable throughout lifetime. communicate changes using `on_layout_dirty`.
+  /// variable throughout lifetime. communicate changes using
+  /// `mark_layout_dirty()`.
   // for view widgets, this is effectively the size that's actually visible.
   SelfExtent self_extent_;
 
-  /// variable throughout lifetime. communicate changes using `on_layout_dirty`
+  /// variable throughout lifetime. communicate changes using
+  /// `mark_layout_dirty()`
   bool needs_trimming_;
 
-  /// variable throughout lifetime. communicate changes using `on_layout_dirty`
+  /// constant throughout lifetime
+  bool places_children_ = false;
+
+  /// variable throughout lifetime. communicate changes using
+  /// `mark_layout_dirty()`
   Padding padding_;
 
-  /// variable throughout lifetime. communicate changes using `on_layout_dirty`
+  /// variable throughout lifetime. communicate changes using
+  /// `mark_layout_dirty()`
   Flex flex_;
 
   /// variable throughout lifetime. communicate changes using
-  /// `on_children_changed`
+  /// `mark_children_dirty()`
   stx::Span<Widget *const> children_;
 
   /// for view widgets (used for laying out its children).
@@ -305,14 +556,22 @@ struct Widget {
 
   /// for view widgets (used for scrolling or moving of the view)
   ///
-  /// variable throughout lifetime. communicate changes with
-  /// `on_view_offset_changed`.
+  /// variable throughout lifetime. changes are communicated with
+  /// `update_view_offset`, which queues the view on the view-offset dirty
+  /// queue (`WidgetDirtiness::ViewOffset`).
   /// resolved using the view extent.
   ViewOffset view_offset_;
 
-  // variable throughout lifetime. communicate changes using `on_layout_dirty`
+  // variable throughout lifetime. communicate changes using
+  // `mark_layout_dirty()`
   ViewFit view_fit_;
 
+  /// for view widgets. constant throughout lifetime
+  bool is_layer_ = false;
+
+  /// for layer widgets. variable throughout lifetime, polled by the tile cache
+  LayerEffects layer_effects_{};
+
   /// constant throughout lifetime
   stx::Option<ZIndex> z_index_;
 
@@ -323,12 +582,38 @@ struct Widget {
   WidgetDirtiness dirtiness_ = WidgetDirtiness::All;
 
   /// modified and used for communication of updates to the system
-  WidgetStateProxy state_proxy_;
+  WidgetDirtyQueues *dirty_queues_ = nullptr;
+
+  /// id of the widget's view on the view tree, for view widgets
+  size_t view_id_ = WidgetDirtyQueues::kNoId;
+
+  /// id of the widget's entry on the tile cache, for render widgets
+  size_t entry_id_ = WidgetDirtyQueues::kNoId;
+
+  /// slot of the widget on the pipeline's active set
+  size_t active_slot_ = WidgetDirtyQueues::kNoId;
+
+  /// variable throughout lifetime
+  bool is_subscribed_to_ticks_ = false;
+
+  /// constant throughout lifetime
+  OffscreenTickPolicy offscreen_tick_policy_ = OffscreenTickPolicy::Throttle;
+
+  /// interval accumulated whilst the off-screen widget's ticks were skipped
+  std::chrono::nanoseconds skipped_interval_{0};
+
+  /// the paused widget was moved out of the active set, at the pipeline's
+  /// `parked_time_`, until it is visible again
+  bool is_tick_parked_ = false;
+  std::chrono::nanoseconds parked_time_{0};
 
   /// updated by the widget system to inform the user that the widget is
   /// presently in use for rendering. i.e. informing the widget that it
   /// shouldn't discard its asset or rendering data
   bool is_stale_ = true;
+
+  /// updated by the layout system once the widget's extent has been resolved
+  Extent layout_extent_{};
 };
 
 std::string format(Widget const &widget);
@@ -340,13 +625,66 @@ struct WidgetSystemProxy {
     widget.system_tick(interval, context);
   }
 
-  static WidgetStateProxy &get_state_proxy(Widget &widget) {
-    return widget.state_proxy_;
+  static void bind_dirty_queues(Widget &widget, WidgetDirtyQueues *queues) {
+    widget.dirty_queues_ = queues;
+  }
+
+  /// widgets are bound once they are added to the pipeline's trees. a newly
+  /// created widget is never bound, even if it reuses the address of a
+  /// deleted one.
+  static bool is_bound(Widget const &widget) {
+    return widget.dirty_queues_ != nullptr;
+  }
+
+  static void bind_view_id(Widget &widget, size_t id) { widget.view_id_ = id; }
+
+  static void bind_entry_id(Widget &widget, size_t id) {
+    widget.entry_id_ = id;
+  }
+
+  static void flush_dirtiness(Widget &widget) { widget.flush_dirtiness(); }
+
+  static void activate(Widget &widget) { widget.activate(); }
+
+  static void update_active_slot(Widget &widget, size_t slot) {
+    widget.active_slot_ = slot;
   }
 
-  static void mark_stale(Widget &widget) { widget.is_stale_ = true; }
+  static bool is_tick_paused(Widget const &widget) {
+    return widget.is_tick_paused();
+  }
 
-  static void mark_non_stale(Widget &widget) { widget.is_stale_ = false; }
+  /// moves the paused off-screen widget out of the active set, so it doesn't
+  /// keep the pipeline busy. it is re-activated once it is visible again.
+  static void park(Widget &widget) {
+    widget.active_slot_ = WidgetDirtyQueues::kNoId;
+    widget.is_tick_parked_ = true;
+    widget.parked_time_ = widget.dirty_queues_->time;
+  }
+
+  /// updates the widget's staleness, notifying it if its visibility changed
+  static void update_visibility(Widget &widget, bool is_visible) {
+    if (widget.is_stale_ == is_visible) {
+      widget.is_stale_ = !is_visible;
+      if (is_visible && widget.is_tick_parked_ &&
+          widget.is_subscribed_to_ticks_) {
+        widget.activate();
+      }
+      widget.on_visibility_changed(is_visible);
+    }
+  }
+
+  /// the animation engine writes to the layer effects in-place
+  static LayerEffects &get_layer_effects(Widget &widget) {
+    return widget.layer_effects_;
+  }
+
+  static void update_layout_extent(Widget &widget, Extent extent) {
+    if (widget.layout_extent_ != extent) {
+      widget.layout_extent_ = extent;
+      widget.on_layout_extent_changed(extent);
+    }
+  }
 };
 
 }  // namespace ui
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
 #include <vector>
 
@@ -22,6 +23,12 @@ struct Widget;
 /// returns `nullptr`
 using WidgetBuilder = std::function<Widget *(size_t)>;
 
+/// used by lazily-built (virtualized) widgets to re-use an already built
+/// widget for the item at the specified index instead of building a new one.
+/// returns false if the widget can't be re-bound to the item, in which case
+/// the builder is used instead.
+using WidgetRecycler = std::function<bool(Widget &, size_t)>;
+
 inline std::vector<Widget *> build_children(
     stx::Span<Widget *const> const &src_children) {
   std::vector<Widget *> children;
@@ -1,7 +1,202 @@
+#pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
+#include "vlk/primitives.h"
+#include "vlk/ui/layout.h"
+#include "vlk/ui/widget.h"
+#include "vlk/ui/widget_builder.h"
+
+namespace vlk {
+namespace ui {
+
+/// number of rows and columns a grid item occupies
+struct GridSpan {
+  uint32_t rows = 1;
+  uint32_t columns = 1;
+};
+
+constexpr bool operator==(GridSpan const &a, GridSpan const &b) {
+  return a.rows == b.rows && a.columns == b.columns;
+}
+
+constexpr bool operator!=(GridSpan const &a, GridSpan const &b) {
+  return !(a == b);
+}
+
+/// returns the span of the item at the specified index
+using GridSpanProvider = std::function<GridSpan(size_t)>;
+
+struct GridProps {
+  constexpr GridProps() {}
+
+  constexpr GridProps columns(uint32_t count) const {
+    GridProps out{*this};
+    out.columns_ = count;
+    return out;
+  }
+
+  constexpr uint32_t columns() const { return columns_; }
+
+  /// extent of a single cell. items spanning multiple cells also cover the
+  /// spacing in between the cells.
+  constexpr GridProps cell_extent(Extent extent) const {
+    GridProps out{*this};
+    out.cell_extent_ = extent;
+    return out;
+  }
+
+  constexpr Extent cell_extent() const { return cell_extent_; }
+
+  /// spacing between the rows and columns
+  constexpr GridProps spacing(uint32_t value) const {
+    GridProps out{*this};
+    out.spacing_ = value;
+    return out;
+  }
+
+  constexpr uint32_t spacing() const { return spacing_; }
+
+  /// total number of items the builder can produce
+  constexpr GridProps item_count(size_t count) const {
+    GridProps out{*this};
+    out.item_count_ = count;
+    return out;
+  }
+
+  constexpr size_t item_count() const { return item_count_; }
+
+  /// extent above and below the visible area within which cells are still
+  /// materialized
+  constexpr GridProps cache_extent(uint32_t extent) const {
+    GridProps out{*this};
+    out.cache_extent_ = extent;
+    return out;
+  }
+
+  constexpr uint32_t cache_extent() const { return cache_extent_; }
+
+  constexpr GridProps extent(SelfExtent value) const {
+    GridProps out{*this};
+    out.extent_ = value;
+    return out;
+  }
+
+  constexpr SelfExtent extent() const { return extent_; }
+
+ private:
+  uint32_t columns_ = 4;
+  Extent cell_extent_{128, 128};
+  uint32_t spacing_ = 0;
+  size_t item_count_ = 0;
+  uint32_t cache_extent_ = 256;
+  SelfExtent extent_ = SelfExtent::relative(1.0f, 1.0f);
+};
+
+// a vertically scrolling grid of items.
+//
+// if no span provider is given, all items occupy a single cell and the
+// placement of any item is computed arithmetically from its index. otherwise,
+// the items are placed in order on the first free cells after the previously
+// placed item (as in sparse auto-placement) and the placement table is
+// computed once, whenever the props are updated.
 //
+// in both cases, items are placed in non-decreasing row order, so the items
+// intersecting the visible area form a contiguous index range. only those
+// (and the ones within the cache extent) are materialized.
 //
-// some grid children can span multiple columns
+// the grid owns the widgets returned by the builder and deletes them once they
+// are no longer needed. the builder must not return `nullptr` for indices
+// below the item count.
 //
-//
\ No newline at end of file
+struct Grid : public Widget {
+  Grid(WidgetBuilder builder, GridProps const &props = {},
+       GridSpanProvider span_provider = nullptr,
+       WidgetRecycler recycler = nullptr);
+
+  ~Grid() override;
+
+  GridProps get_props() const { return props_; }
+
+  void update_props(GridProps const &props);
+
+  /// scrolls the grid to the specified vertical offset
+  void scroll_to(uint32_t offset);
+
+  uint32_t get_scroll_offset() const { return scroll_offset_; }
+
+  /// rect the item at `index` occupies on the grid. O(1).
+  Rect get_cell_rect(size_t index) const;
+
+  /// total number of rows spanned by the items
+  uint32_t get_num_rows() const;
+
+  /// first index of the materialized range
+  size_t get_range_begin() const { return range_begin_; }
+
+  /// one past the last index of the materialized range
+  size_t get_range_end() const { return range_end_; }
+
+  Widget *get_item(size_t index) const {
+    if (index < range_begin_ || index >= range_end_) return nullptr;
+    return items_[index - range_begin_];
+  }
+
+  virtual Rect get_child_rect(size_t index, Extent content_extent) override;
+
+  virtual Extent get_children_span(Extent content_extent) override;
+
+  virtual void tick(std::chrono::nanoseconds,
+                    SubsystemsContext const &) override;
+
+  virtual void on_layout_extent_changed(Extent) override;
+
+ private:
+  // placement of an item, in cells
+  struct Cell {
+    uint32_t row = 0;
+    uint32_t column = 0;
+    GridSpan span{};
+  };
+
+  Cell get_cell(size_t index) const;
+
+  void compute_placement();
+
+  void materialize(size_t begin, size_t end);
+
+  void release(Widget *item);
+
+  Widget *acquire(size_t index);
+
+  WidgetBuilder builder_;
+  GridSpanProvider span_provider_;
+  WidgetRecycler recycler_;
+  GridProps props_;
+
+  uint32_t scroll_offset_ = 0;
+
+  // only used if a span provider is present
+  std::vector<Cell> cells_;
+  uint32_t num_span_rows_ = 0;
+  uint32_t max_row_span_ = 1;
+
+  size_t range_begin_ = 0;
+  size_t range_end_ = 0;
+  bool range_dirty_ = true;
+
+  // materialized items, `items_[i]` belongs to index `range_begin_ + i`
+  std::vector<Widget *> items_;
+
+  // retained across re-materializations to avoid re-allocating
+  std::vector<Widget *> scratch_;
+
+  // widgets that left the materialized range, awaiting re-use
+  std::vector<Widget *> pool_;
+};
+
+}  // namespace ui
+}  // namespace vlk
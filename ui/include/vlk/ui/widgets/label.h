@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "include/core/SkRefCnt.h"
+#include "include/core/SkTextBlob.h"
+#include "include/core/SkTypeface.h"
+#include "vlk/ui/font_collection.h"
+#include "vlk/ui/paragraph_cache.h"
+#include "vlk/ui/widget.h"
+#include "vlk/ui/widgets/text.h"
+
+namespace vlk {
+namespace ui {
+
+namespace impl {
+
+// checks if the text can be laid out glyph by glyph, without shaping: a single
+// line of left-to-right alphabetic scripts (latin, greek, cyrillic) and common
+// symbols, without combining marks, zero-width joiners or bidirectional
+// controls.
+bool is_simple_text(std::string_view utf8_text);
+
+}  // namespace impl
+
+// a single-style label.
+//
+// most labels are a single line of simple text, which doesn't need the
+// paragraph engine's shaping, font fallback, bidirectional reordering or line
+// breaking. such labels are measured with the glyph advances cached on the font
+// collection's glyph cache, and drawn with a single text blob.
+//
+// the label falls back to the paragraph engine (and is laid out exactly as a
+// `Text` with the same props would) if its text isn't simple (see
+// `impl::is_simple_text`), its font has no glyph for one of its characters, it
+// is decorated or right-to-left, or it doesn't fit on a single line.
+//
+// NOTE: kerning and ligatures aren't applied on the fast path, so the fast path
+// can be a few pixels narrower or wider than the paragraph engine's layout.
+//
+struct Label : public Widget {
+  explicit Label(std::string utf8_text,
+                 ParagraphProps props = ParagraphProps{});
+
+  void update_text(std::string utf8_text);
+
+  void update_props(ParagraphProps props);
+
+  std::string_view get_text() const { return text_; }
+
+  ParagraphProps get_props() const { return storage_.props; }
+
+  // checks if the label is laid out without the paragraph engine, unless it
+  // doesn't fit on a single line
+  bool is_fast_path() const { return is_fast_path_; }
+
+  virtual Extent trim(Extent) override;
+
+  virtual void draw(Canvas&) override;
+
+  virtual void tick(std::chrono::nanoseconds,
+                    SubsystemsContext const&) override;
+
+ private:
+  std::string text_;
+  impl::ParagraphStorage storage_;
+
+  /// the loaded font, the font collection's default typeface is used until
+  /// then
+  sk_sp<SkTypeface> typeface_;
+
+  bool is_fast_path_ = false;
+
+  /// the positioned glyphs if the label is on the fast path, null if the
+  /// label is empty
+  sk_sp<SkTextBlob> blob_;
+  float advance_ = 0.0f;
+  /// the widest word's advance, the label can't be narrower without wrapping
+  /// within a word
+  float min_advance_ = 0.0f;
+  float ascent_ = 0.0f;
+  float line_height_ = 0.0f;
+
+  /// built once the label falls back to the paragraph engine
+  std::unique_ptr<CachedParagraph> paragraph_;
+
+  /// owned by the pipeline's subsystems context, bound on the first tick
+  SharedFontCollection* font_collection_ = nullptr;
+
+  SharedFontCollection& get_font_collection() const {
+    return font_collection_ == nullptr ? SharedFontCollection::unbound()
+                                       : *font_collection_;
+  }
+
+  /// lays out the label on the fast path if possible, and updates its extent
+  void layout_label();
+
+  /// builds the paragraph if it isn't built already
+  CachedParagraph& get_paragraph();
+
+  bool fits(float width) const { return is_fast_path_ && advance_ <= width; }
+};
+
+}  // namespace ui
+}  // namespace vlk
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "vlk/primitives.h"
+#include "vlk/ui/layout.h"
+#include "vlk/ui/widget.h"
+#include "vlk/ui/widget_builder.h"
+#include "vlk/ui/widgets/spacer.h"
+
+namespace vlk {
+namespace ui {
+
+struct VirtualListProps {
+  constexpr VirtualListProps() {}
+
+  /// direction along which the items are stacked and scrolled
+  constexpr VirtualListProps direction(Direction value) const {
+    VirtualListProps out{*this};
+    out.direction_ = value;
+    return out;
+  }
+
+  constexpr Direction direction() const { return direction_; }
+
+  /// total number of items the builder can produce. the builder can end the
+  /// list earlier by returning `nullptr`.
+  constexpr VirtualListProps item_count(size_t count) const {
+    VirtualListProps out{*this};
+    out.item_count_ = count;
+    return out;
+  }
+
+  constexpr size_t item_count() const { return item_count_; }
+
+  /// main-axis extent assumed for items that haven't been laid out yet. it is
+  /// refined with the extents of the items that have been laid out.
+  constexpr VirtualListProps item_extent_estimate(uint32_t extent) const {
+    VirtualListProps out{*this};
+    out.item_extent_estimate_ = extent;
+    return out;
+  }
+
+  constexpr uint32_t item_extent_estimate() const {
+    return item_extent_estimate_;
+  }
+
+  /// extent along the main-axis before and after the visible area within
+  /// which items are still materialized. this prevents items from popping in
+  /// while scrolling.
+  constexpr VirtualListProps cache_extent(uint32_t extent) const {
+    VirtualListProps out{*this};
+    out.cache_extent_ = extent;
+    return out;
+  }
+
+  constexpr uint32_t cache_extent() const { return cache_extent_; }
+
+  constexpr VirtualListProps extent(SelfExtent value) const {
+    VirtualListProps out{*this};
+    out.extent_ = value;
+    return out;
+  }
+
+  constexpr SelfExtent extent() const { return extent_; }
+
+ private:
+  Direction direction_ = Direction::Column;
+  size_t item_count_ = 0;
+  uint32_t item_extent_estimate_ = 32;
+  uint32_t cache_extent_ = 256;
+  SelfExtent extent_ = SelfExtent::relative(1.0f, 1.0f);
+};
+
+// only the items within the visible area (and the cache extent around it) are
+// built, so the layout tree, view tree, and tile cache only ever hold entries
+// for the materialized items irregardless of the number of items in the list.
+// the extent of the items before and after the materialized range is reserved
+// using spacers sized from the estimated item extent.
+//
+// the list owns the widgets returned by the builder and deletes them once they
+// are no longer needed. widgets leaving the materialized range are kept in a
+// pool and re-bound to new items using the recycler (if any).
+//
+struct VirtualList : public Widget {
+  VirtualList(WidgetBuilder builder, VirtualListProps const &props = {},
+              WidgetRecycler recycler = nullptr);
+
+  ~VirtualList() override;
+
+  VirtualListProps get_props() const { return props_; }
+
+  void update_props(VirtualListProps const &props);
+
+  /// scrolls the list to the specified offset along its main-axis
+  void scroll_to(uint32_t offset);
+
+  uint32_t get_scroll_offset() const { return scroll_offset_; }
+
+  /// first index of the materialized range
+  size_t get_range_begin() const { return range_begin_; }
+
+  /// one past the last index of the materialized range
+  size_t get_range_end() const { return range_end_; }
+
+  /// materialized widget for the item at `index`, if it is within the
+  /// materialized range
+  Widget *get_item(size_t index) const {
+    if (index < range_begin_ || index >= range_end_) return nullptr;
+    return items_[index - range_begin_];
+  }
+
+  /// number of items in the list. this is `props.item_count()` until the
+  /// builder signals the end of the list at an earlier index.
+  size_t get_item_count() const { return materialized_count_; }
+
+  /// present estimate of the main-axis extent of a single item
+  uint32_t get_item_extent_estimate() const;
+
+  /// present estimate of the main-axis extent of the whole list
+  uint64_t get_extent_estimate() const {
+    return static_cast<uint64_t>(get_item_extent_estimate()) *
+           materialized_count_;
+  }
+
+  virtual void tick(std::chrono::nanoseconds,
+                    SubsystemsContext const &) override;
+
+  virtual void on_layout_extent_changed(Extent) override;
+
+ private:
+  void materialize(size_t begin, size_t end);
+
+  void release(Widget *item);
+
+  Widget *acquire(size_t index);
+
+  WidgetBuilder builder_;
+  WidgetRecycler recycler_;
+  VirtualListProps props_;
+
+  // the item count discovered from the builder, reset once the props are
+  // updated
+  size_t materialized_count_ = 0;
+
+  uint32_t scroll_offset_ = 0;
+
+  size_t range_begin_ = 0;
+  size_t range_end_ = 0;
+  bool range_dirty_ = true;
+
+  // materialized items, `items_[i]` belongs to index `range_begin_ + i`
+  std::vector<Widget *> items_;
+
+  // retained across re-materializations to avoid re-allocating
+  std::vector<Widget *> scratch_;
+
+  // widgets that left the materialized range, awaiting re-use
+  std::vector<Widget *> pool_;
+
+  uint64_t measured_extent_sum_ = 0;
+  uint64_t num_measured_ = 0;
+
+  Spacer leading_;
+  Spacer trailing_;
+
+  std::vector<Widget *> children_;
+};
+
+}  // namespace ui
+}  // namespace vlk
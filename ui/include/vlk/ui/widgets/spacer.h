@@ -0,0 +1,27 @@
+#pragma once
+
+#include "vlk/primitives.h"
+#include "vlk/ui/layout.h"
+#include "vlk/ui/widget.h"
+
+namespace vlk {
+namespace ui {
+
+/// occupies space on its parent and has no render data. typically used for
+/// reserving the extent of content that isn't materialized.
+struct Spacer : public Widget {
+  explicit Spacer(Extent extent = Extent{}) : Widget{WidgetType::Render} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent::absolute(extent));
+    Widget::set_debug_info(WidgetDebugInfo{"Spacer", "Spacer"});
+  }
+
+  void update_extent(Extent extent) {
+    Widget::update_self_extent(SelfExtent::absolute(extent));
+  }
+
+  ~Spacer() override {}
+};
+
+}  // namespace ui
+}  // namespace vlk
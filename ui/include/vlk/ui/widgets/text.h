@@ -17,6 +17,7 @@
 #include "vlk/font_source.h"
 #include "vlk/primitives.h"
 #include "vlk/ui/font.h"
+#include "vlk/ui/font_collection.h"
 #include "vlk/ui/future_awaiter.h"
 #include "vlk/ui/widget.h"
 
@@ -577,6 +578,18 @@ struct ParagraphStorage {
   stx::Option<FontFuture> font_future = stx::None;
 };
 
+/// the font family name the font is registered as on the font collection
+std::string_view get_source_tag(FontSource const& font_source);
+
+/// the style of the inline text, its unset properties resolved from the
+/// paragraph's
+skia::textlayout::TextStyle make_text_style(
+    InlineTextStorage const& text_storage,
+    ParagraphStorage const& paragraph_storage);
+
+skia::textlayout::ParagraphStyle make_paragraph_style(
+    ParagraphProps const& paragraph_props);
+
 enum class TextDiff : uint16_t {
   /// nothing changed in the inline text
   None = 0,
@@ -605,6 +618,48 @@ enum class TextDiff : uint16_t {
 
 STX_DEFINE_ENUM_BIT_OPS(TextDiff)
 
+/// the changes that only affect how the shaped text is painted. they are
+/// applied to the existing paragraph without reshaping or re-laying it out.
+constexpr TextDiff kPaintOnlyDiff =
+    TextDiff::Color | TextDiff::BgColor | TextDiff::Decoration |
+    TextDiff::DecorationColor | TextDiff::DecorationStyle | TextDiff::Antialias;
+
+// caches the height of the paragraph laid out at a width constraint, keyed by
+// the paragraph's content generation and the width constraint. the layout pass
+// can trim the same text several times per frame (i.e. in wrapping rows) and
+// re-laying out the paragraph for each is expensive.
+struct TextMeasurementCache {
+  static constexpr size_t kCapacity = 8;
+
+  struct Entry {
+    uint64_t generation = 0;
+    float width = 0.0f;
+    float height = 0.0f;
+  };
+
+  stx::Option<float> find(uint64_t generation, float width) const {
+    for (size_t i = 0; i < size; i++) {
+      if (entries[i].generation == generation && entries[i].width == width) {
+        return stx::Some(float{entries[i].height});
+      }
+    }
+
+    return stx::None;
+  }
+
+  void insert(uint64_t generation, float width, float height) {
+    // entries of stale generations are never hit again so we just evict the
+    // oldest entry
+    entries[next] = Entry{generation, width, height};
+    next = (next + 1) % kCapacity;
+    size = std::min(size + 1, kCapacity);
+  }
+
+  Entry entries[kCapacity];
+  size_t size = 0;
+  size_t next = 0;
+};
+
 }  // namespace impl
 
 // Requirements
@@ -631,7 +686,8 @@ struct Text : public Widget {
        ParagraphProps paragraph_props = ParagraphProps{}) {
     update_paragraph_props(std::move(paragraph_props));
     update_text(std::move(inline_texts));
-    rebuild_paragraph();
+    // the paragraph is shaped once the widget is first ticked
+    Widget::update_self_extent(estimate_extent());
   }
 
   stx::Span<impl::InlineTextStorage const> get_inline_texts() const {
@@ -651,6 +707,10 @@ struct Text : public Widget {
 
   void update_paragraph_props(ParagraphProps paragraph_props);
 
+  /// whether the paragraph is being shaped on the task scheduler. the previous
+  /// paragraph (or an estimate, if there's none) is used until it is shaped.
+  bool is_shaping() const { return shaping_.is_some(); }
+
   virtual Extent trim(Extent) override;
 
   virtual void draw(Canvas&) override;
@@ -659,13 +719,70 @@ struct Text : public Widget {
                     SubsystemsContext const&) override;
 
  private:
+  // used by the tests to simulate a failed shaping task
+  friend struct TextTestProxy;
+
   impl::ParagraphStorage paragraph_storage_;
   std::vector<impl::InlineTextStorage> inline_texts_;
 
-  std::unique_ptr<skia::textlayout::Paragraph> paragraph_ = nullptr;
+  /// shared with the other text widgets with identical content and style, via
+  /// the font collection's paragraph cache
+  std::shared_ptr<CachedParagraph> paragraph_ = nullptr;
+
+  /// the key `paragraph_` is cached by
+  std::string paragraph_key_;
+
+  /// a copy of `paragraph_` laid out at the width the widget is drawn at, if
+  /// another widget sharing it draws it at another width
+  std::shared_ptr<CachedParagraph> drawn_paragraph_ = nullptr;
+
+  /// the paragraph being shaped on the task scheduler, it replaces
+  /// `paragraph_` once shaped
+  stx::Option<FutureAwaiter<std::shared_ptr<CachedParagraph>>> shaping_ =
+      stx::None;
+  std::string shaping_key_;
+  size_t shaping_text_size_ = 0;
+
   impl::TextDiff diff_ = impl::TextDiff::All;
 
-  void rebuild_paragraph();
+  /// incremented whenever the paragraph is rebuilt, i.e. its text or style is
+  /// modified
+  uint64_t generation_ = 0;
+
+  impl::TextMeasurementCache measurement_cache_;
+
+  /// owned by the pipeline's subsystems context, bound on the first tick. the
+  /// paragraph is first built on the first tick.
+  SharedFontCollection* font_collection_ = nullptr;
+
+  /// shapes the paragraph on the task scheduler, unless the font collection
+  /// shapes synchronously or `synchronous` is set
+  void rebuild_paragraph(bool synchronous = false);
+
+  /// applies a paint-only diff to the paragraph
+  void repaint_paragraph();
+
+  /// adopts the shaped paragraph. if the shaping task failed, the paragraph
+  /// is shaped synchronously instead.
+  void finish_shaping();
+
+  void adopt_paragraph(std::string key,
+                       std::shared_ptr<CachedParagraph> paragraph);
+
+  SelfExtent estimate_extent() const;
+
+  /// lays out the paragraph at `width`, only if it isn't already laid out at
+  /// it. returns the paragraph's height.
+  float layout_paragraph(float width);
+
+  /// the paragraph to draw at `width`: the shared paragraph, unless another
+  /// widget sharing it claimed it at another width
+  CachedParagraph& get_drawn_paragraph(float width);
+
+  SharedFontCollection& get_font_collection() const {
+    return font_collection_ == nullptr ? SharedFontCollection::unbound()
+                                       : *font_collection_;
+  }
 };
 
 }  // namespace ui
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "modules/skparagraph/include/Paragraph.h"
+#include "stx/option.h"
+#include "vlk/ui/font_collection.h"
+#include "vlk/ui/widget.h"
+#include "vlk/ui/widgets/text.h"
+
+namespace vlk {
+namespace ui {
+
+namespace impl {
+
+// a run of consecutive lines of a text document, shaped and measured
+// independently of the rest of the document
+struct TextBlock {
+  // the lines, separated by (but not ending with) a line break
+  std::string text;
+  size_t num_lines = 0;
+
+  // shaped once the block is first drawn, released once it hasn't been drawn
+  // for long
+  std::unique_ptr<skia::textlayout::Paragraph> paragraph = nullptr;
+
+  // width constraint the paragraph is presently laid out at
+  stx::Option<float> laid_out_width = stx::None;
+
+  // measured at the document's width once shaped, otherwise estimated from the
+  // number of lines
+  float height = 0.0f;
+  bool is_measured = false;
+
+  // the draw the block was last drawn by
+  uint64_t last_drawn = 0;
+};
+
+}  // namespace impl
+
+// displays a large text document, i.e. a log.
+//
+// a single paragraph would have to be reshaped entirely on every edit, and
+// painted entirely into every tile it overlaps. the document is instead split
+// into blocks of up to `kLinesPerBlock` lines, shaped lazily and independently
+// of each other. only the blocks intersecting the area being drawn are shaped
+// and painted, so the cost tracks the visible lines, and an edit only
+// invalidates the blocks it touches.
+//
+// the heights of the blocks that haven't been shaped yet are estimated from the
+// average line height measured so far. they are corrected (and the document
+// reflowed) on the tick that follows their shaping.
+//
+// NOTE: all of the document is styled by its paragraph props
+//
+struct TextDocument : public Widget {
+  static constexpr size_t kLinesPerBlock = 64;
+
+  // maximum number of blocks retained shaped, the least recently drawn ones
+  // are released once exceeded
+  static constexpr size_t kMaxShapedBlocks = 64;
+
+  explicit TextDocument(std::string_view text = {},
+                        ParagraphProps paragraph_props = ParagraphProps{});
+
+  // replaces the document's text, all of the blocks are invalidated
+  void update_text(std::string_view text);
+
+  // appends to the document's last line, only the last block is invalidated
+  void append_text(std::string_view text);
+
+  void update_paragraph_props(ParagraphProps paragraph_props);
+
+  ParagraphProps get_paragraph_props() const {
+    return paragraph_storage_.props;
+  }
+
+  size_t get_num_blocks() const { return blocks_.size(); }
+
+  size_t get_num_shaped_blocks() const { return num_shaped_blocks_; }
+
+  size_t get_num_lines() const;
+
+  virtual Extent trim(Extent) override;
+
+  virtual void draw(Canvas&) override;
+
+  virtual void tick(std::chrono::nanoseconds,
+                    SubsystemsContext const&) override;
+
+ private:
+  impl::ParagraphStorage paragraph_storage_;
+  std::vector<impl::TextBlock> blocks_;
+
+  /// offsets of the blocks from the document's top, the last element is the
+  /// document's height
+  std::vector<float> block_offsets_;
+
+  /// width the document is presently laid out at
+  stx::Option<float> width_ = stx::None;
+
+  size_t num_shaped_blocks_ = 0;
+  uint64_t num_draws_ = 0;
+
+  /// the measured height of a block differs from its estimate
+  bool needs_reflow_ = false;
+
+  /// owned by the pipeline's subsystems context, bound on the first tick
+  SharedFontCollection* font_collection_ = nullptr;
+
+  SharedFontCollection& get_font_collection() const {
+    return font_collection_ == nullptr ? SharedFontCollection::unbound()
+                                       : *font_collection_;
+  }
+
+  /// splits the text into blocks appended to the document
+  void split_into_blocks(std::string_view text);
+
+  /// releases the shaped blocks, i.e. once the style or font changes
+  void release_blocks();
+
+  void shape_block(impl::TextBlock& block);
+
+  float layout_block(impl::TextBlock& block, float width);
+
+  float estimate_line_height() const;
+
+  void update_block_offsets();
+};
+
+}  // namespace ui
+}  // namespace vlk
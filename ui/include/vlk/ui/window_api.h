@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include "stx/option.h"
@@ -18,6 +19,13 @@ struct WindowApi {
 
   bool poll_events() const;
 
+  /// blocks until an event is received, `wake` is called, or the timeout
+  /// elapses. returns true if an event was received.
+  bool wait_events(std::chrono::milliseconds timeout) const;
+
+  /// wakes the event loop up from `wait_events`. thread-safe.
+  static void wake();
+
   std::shared_ptr<WindowApiHandle> handle;
 };
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cinttypes>
 #include <map>
 
@@ -67,8 +69,31 @@ struct WindowApiHandle {
     VLK_SDL_ENSURE(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) == 0,
                    "Unable to initialize SDL");
     is_initialized = true;
+    register_wake_event();
   }
 
+  /// registers the event that wakes the event loop up. requires SDL's events
+  /// subsystem to be initialized.
+  static void register_wake_event() {
+    uint32_t const type = SDL_RegisterEvents(1);
+    VLK_SDL_ENSURE(type != static_cast<uint32_t>(-1),
+                   "Unable to register the wake event");
+    wake_event_type.store(type, std::memory_order_release);
+  }
+
+  /// wakes the event loop up if it is blocked in `wait_events`. thread-safe.
+  static void wake() {
+    uint32_t const type = wake_event_type.load(std::memory_order_acquire);
+    if (type == 0) return;
+
+    SDL_Event event{};
+    event.type = type;
+    SDL_PushEvent(&event);
+  }
+
+  /// zero until registered, SDL's registered event types are never zero
+  static inline std::atomic<uint32_t> wake_event_type{0};
+
   ~WindowApiHandle() {
     if (is_initialized) {
       SDL_Quit();
@@ -106,59 +131,132 @@ struct WindowApiHandle {
     SDL_Event event{};
 
     if (SDL_PollEvent(&event) == 1) {
-      switch (event.type) {
-        case SDL_WINDOWEVENT: {
-          get_window(WindowID{event.window.windowID})
-              .queue->add_raw(sdl_window_event_to_vlk(event.window.event));
-          return true;
+      handle_event(event);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  // blocks until an event is received, the event loop is woken up, or the
+  // timeout elapses. returns true if an event was received.
+  bool wait_events(std::chrono::milliseconds timeout) {
+    SDL_Event event{};
+
+    if (SDL_WaitEventTimeout(&event, static_cast<int>(timeout.count())) == 1) {
+      handle_event(event);
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  // maps an SDL event's timestamp (in milliseconds since SDL's initialization)
+  // onto the steady clock
+  static EventTimestamp to_timestamp(uint32_t sdl_timestamp) {
+    EventTimestamp const now = std::chrono::steady_clock::now();
+    uint32_t const ticks = SDL_GetTicks();
+    return ticks >= sdl_timestamp
+               ? now - std::chrono::milliseconds(ticks - sdl_timestamp)
+               : now;
+  }
+
+  // the wake event only ends the wait, it is dropped here
+  void handle_event(SDL_Event const& event) {
+    switch (event.type) {
+      case SDL_WINDOWEVENT: {
+        get_window(WindowID{event.window.windowID})
+            .queue->add_raw(sdl_window_event_to_vlk(event.window.event));
+        return;
+      }
+
+      case SDL_MOUSEMOTION: {
+        MouseMotionEvent motion_event;
+        motion_event.mouse_id = MouseID{event.motion.which};
+        motion_event.offset = IOffset{event.motion.x, event.motion.y};
+        motion_event.translation =
+            IOffset{event.motion.xrel, event.motion.yrel};
+        motion_event.timestamp = to_timestamp(event.motion.timestamp);
+        get_window(WindowID{event.motion.windowID})
+            .queue->add_raw(motion_event);
+        return;
+      }
+
+      case SDL_MOUSEBUTTONDOWN:
+      case SDL_MOUSEBUTTONUP: {
+        MouseButtonEvent mouse_event;
+        mouse_event.mouse_id = MouseID{event.button.which};
+        mouse_event.offset = IOffset{event.button.x, event.button.y};
+        mouse_event.clicks = event.button.clicks;
+        mouse_event.timestamp = to_timestamp(event.button.timestamp);
+
+        switch (event.button.button) {
+          case SDL_BUTTON_LEFT:
+            mouse_event.button = MouseButton::Primary;
+            break;
+          case SDL_BUTTON_RIGHT:
+            mouse_event.button = MouseButton::Secondary;
+            break;
+          case SDL_BUTTON_MIDDLE:
+            mouse_event.button = MouseButton::Middle;
+            break;
+          default:
+            return;
+        }
+
+        switch (event.type) {
+          case SDL_MOUSEBUTTONDOWN:
+            mouse_event.action = MouseAction::Press;
+            break;
+
+          case SDL_MOUSEBUTTONUP:
+            mouse_event.action = MouseAction::Release;
+            break;
+
+          default:
+            return;
         }
+        // SDL_StartTextInput()
+        get_window(WindowID{event.button.windowID})
+            .queue->add_raw(mouse_event);
+        return;
+      }
 
-        case SDL_MOUSEBUTTONDOWN:
-        case SDL_MOUSEBUTTONUP: {
-          MouseButtonEvent mouse_event;
-          mouse_event.mouse_id = MouseID{event.button.which};
-          mouse_event.offset = IOffset{event.button.x, event.button.y};
-          mouse_event.clicks = event.button.clicks;
-
-          switch (event.button.button) {
-            case SDL_BUTTON_LEFT:
-              mouse_event.button = MouseButton::Primary;
-              break;
-            case SDL_BUTTON_RIGHT:
-              mouse_event.button = MouseButton::Secondary;
-              break;
-            case SDL_BUTTON_MIDDLE:
-              mouse_event.button = MouseButton::Middle;
-              break;
-            default:
-              return true;
-          }
-
-          switch (event.type) {
-            case SDL_MOUSEBUTTONDOWN:
-              mouse_event.action = MouseAction::Press;
-              break;
-
-            case SDL_MOUSEBUTTONUP:
-              mouse_event.action = MouseAction::Release;
-              break;
-
-            default:
-              return true;
-          }
-          // SDL_StartTextInput()
-          VLK_LOG("timestamp: {}", event.button.timestamp);
-          get_window(WindowID{event.button.windowID})
-              .queue->add_raw(mouse_event);
-        };
-
-        default: {
-          return true;
+      case SDL_MOUSEWHEEL: {
+        MouseWheelEvent wheel_event;
+        wheel_event.mouse_id = MouseID{event.wheel.which};
+        int x = 0, y = 0;
+        SDL_GetMouseState(&x, &y);
+        wheel_event.offset = IOffset{x, y};
+        wheel_event.translation = IOffset{event.wheel.x, event.wheel.y};
+        if (event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED) {
+          wheel_event.translation = IOffset{-event.wheel.x, -event.wheel.y};
         }
+        wheel_event.timestamp = to_timestamp(event.wheel.timestamp);
+        get_window(WindowID{event.wheel.windowID})
+            .queue->add_raw(wheel_event);
+        return;
       }
 
-    } else {
-      return false;
+      case SDL_KEYDOWN:
+      case SDL_KEYUP: {
+        KeyEvent key_event;
+        key_event.keyboard.scan_code = event.key.keysym.scancode;
+        key_event.keyboard.key_code = event.key.keysym.sym;
+        key_event.keyboard.modifier =
+            static_cast<SDL_Keymod>(event.key.keysym.mod);
+        key_event.keyboard.repeated = event.key.repeat != 0;
+        key_event.keyboard.state = event.key.state == SDL_PRESSED
+                                       ? KeyboardEvent::State::Pressed
+                                       : KeyboardEvent::State::Released;
+        key_event.timestamp = to_timestamp(event.key.timestamp);
+        get_window(WindowID{event.key.windowID}).queue->add_raw(key_event);
+        return;
+      }
+
+      default: {
+        return;
+      }
     }
   }
 };
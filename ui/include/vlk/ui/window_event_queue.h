@@ -1,23 +1,141 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
+#include <variant>
 #include <vector>
 
+#include "vlk/subsystems/keyboard.h"
 #include "vlk/ui/event.h"
+#include "vlk/ui/ring_buffer.h"
 
 namespace vlk {
 namespace ui {
 
+struct KeyEvent {
+  KeyboardEvent keyboard;
+  EventTimestamp timestamp{};
+};
+
+using InputEvent =
+    std::variant<MouseButtonEvent, MouseMotionEvent, MouseWheelEvent, KeyEvent>;
+
+inline EventTimestamp get_timestamp(InputEvent const &event) {
+  return std::visit([](auto const &input) { return input.timestamp; }, event);
+}
+
+// the window's events received since the last frame.
+//
+// the input events are queued in their order of arrival on a fixed-capacity
+// ring buffer, so bursts of input don't allocate. consecutive motion (or
+// wheel) events of the same mouse are coalesced as they are received, the
+// widgets thus see at most one of them between any two other input events.
+// the coalesced events keep the timestamp of the earliest event they merged,
+// so the latency is measured from the first input the frame reflects.
+//
+// the raw motion events are additionally kept at full resolution on the
+// motion history, which persists across frames, for velocity tracking.
+//
 struct WindowEventQueue {
-  std::vector<MouseButtonEvent> mouse_button_events;
+  static constexpr size_t kInputCapacity = 256;
+  static constexpr size_t kMotionHistoryCapacity = 64;
+
+  RingBuffer<InputEvent, kInputCapacity> input_events;
+  RingBuffer<MouseMotionEvent, kMotionHistoryCapacity> motion_history;
   std::vector<WindowEvent> window_events;
 
-  void add_raw(MouseButtonEvent event) { mouse_button_events.push_back(event); }
+  // number of input events merged into a previous one
+  size_t num_coalesced = 0;
+
+  // number of input events overwritten because the queue overflowed
+  size_t num_dropped = 0;
+
+  void add_raw(MouseButtonEvent event) { add_input(event); }
+
+  void add_raw(MouseMotionEvent event) {
+    motion_history.push(event);
+
+    if (!input_events.empty()) {
+      if (auto *last = std::get_if<MouseMotionEvent>(&input_events.back());
+          last != nullptr && last->mouse_id == event.mouse_id) {
+        last->offset = event.offset;
+        last->translation = last->translation + event.translation;
+        num_coalesced++;
+        return;
+      }
+    }
+
+    add_input(event);
+  }
+
+  void add_raw(MouseWheelEvent event) {
+    if (!input_events.empty()) {
+      if (auto *last = std::get_if<MouseWheelEvent>(&input_events.back());
+          last != nullptr && last->mouse_id == event.mouse_id) {
+        last->offset = event.offset;
+        last->translation = last->translation + event.translation;
+        num_coalesced++;
+        return;
+      }
+    }
+
+    add_input(event);
+  }
+
+  void add_raw(KeyEvent event) { add_input(event); }
+
   void add_raw(WindowEvent event) { window_events.push_back(event); }
 
+  bool empty() const { return input_events.empty() && window_events.empty(); }
+
+  // the motion history is retained
   void clear() {
-    mouse_button_events.clear();
+    input_events.clear();
     window_events.clear();
   }
+
+  // the mouse's velocity in pixels per second, estimated from its motion over
+  // the `window` preceding its most recent motion event
+  VOffset get_pointer_velocity(
+      MouseID mouse_id,
+      std::chrono::nanoseconds window = std::chrono::milliseconds(100)) const {
+    size_t newest = motion_history.size();
+
+    while (newest > 0 && motion_history[newest - 1].mouse_id != mouse_id) {
+      newest--;
+    }
+
+    if (newest == 0) return VOffset{0.0f, 0.0f};
+
+    EventTimestamp const end = motion_history[newest - 1].timestamp;
+    EventTimestamp begin = end;
+    IOffset translation{0, 0};
+
+    // the translation of the oldest event in the window happened before it
+    // begins, so it is excluded
+    size_t later = newest - 1;
+
+    for (size_t i = later; i > 0; i--) {
+      MouseMotionEvent const &previous = motion_history[i - 1];
+      if (previous.mouse_id != mouse_id) continue;
+      if (end - previous.timestamp > window) break;
+
+      translation = translation + motion_history[later].translation;
+      begin = previous.timestamp;
+      later = i - 1;
+    }
+
+    float const seconds = std::chrono::duration<float>(end - begin).count();
+
+    if (seconds <= 0.0f) return VOffset{0.0f, 0.0f};
+
+    return VOffset{translation.x / seconds, translation.y / seconds};
+  }
+
+ private:
+  void add_input(InputEvent const &event) {
+    if (!input_events.push(event)) num_dropped++;
+  }
 };
 
 }  // namespace ui
@@ -7,6 +7,7 @@
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
 #include "vlk/ui/pipeline.h"
+#include "vlk/ui/render_thread.h"
 #include "vlk/ui/vk_render_context.h"
 #include "vlk/ui/vulkan.h"
 #include "vlk/ui/window.h"
@@ -189,6 +190,27 @@ void App::init() {
   // TODO(lamarrr): initial extent?, RenderContext
   pipeline = std::unique_ptr<Pipeline>{
       new Pipeline{*root_widget, vk_render_context->render_context}};
+
+  // background tasks wake the event loop up once they complete
+  pipeline->context.get_waker()->__bind(&WindowApi::wake);
+
+  render_thread = std::unique_ptr<RenderThread>{new RenderThread{
+      vk_render_context->render_context, [this](RasterCache& backing_store) {
+        // TODO(lamarrr): we don't need another backing store on the pipeline
+        // side
+        WindowSwapchainDiff swapchain_diff =
+            window.handle->present_backing_store(
+                backing_store.get_surface_ref());
+
+        while (swapchain_diff != WindowSwapchainDiff::None) {
+          window.handle->recreate_swapchain(vk_render_context);
+          swapchain_recreated = true;
+          swapchain_diff = window.handle->present_backing_store(
+              backing_store.get_surface_ref());
+        }
+      }}};
+
+  last_tick_begin = std::chrono::steady_clock::now();
 }
 
 // TODO(lamarrr): handle should_quit
@@ -197,44 +219,17 @@ void App::tick() {
   auto begin = std::chrono::steady_clock::now();
   auto total_used = std::chrono::steady_clock::duration(0);
 
-  // TODO(lamarrr): add actual tick
-  BackingStoreDiff backing_store_diff = BackingStoreDiff::None;
-
-  {
-    // VLK_TRACE(trace_context, "Swapchain", "Pipeline Tick");
-    backing_store_diff = pipeline->tick({});
-  }
-
-  // only try to present if the pipeline has new changes or window was
-  // resized
-  if (backing_store_diff != BackingStoreDiff::None || window_extent_changed) {
-    // TODO(lamarrr): make presentation happen after recreation, for the first
-    // iteration. and remove the created swapchain in the init method
+  // the swapchain and the viewport are only updated once the render thread
+  // is done with the frames in flight. it is kept from presenting their stale
+  // tiles (and possibly recreating the swapchain itself) meanwhile.
+  if (window_extent_changed || swapchain_recreated.exchange(false)) {
+    render_thread->pause();
 
-    // only try to recreate swapchain if the present swapchain can't be used for
-    // presentation
     if (window_extent_changed) {
       // VLK_TRACE(trace_context, "Swapchain", "Recreation");
       window.handle->recreate_swapchain(vk_render_context);
     }
 
-    // TODO(lamarrr): we don't need another backing store on the pipeline side
-    WindowSwapchainDiff swapchain_diff = window.handle->present_backing_store(
-        pipeline->tile_cache.backing_store_cache.get_surface_ref());
-
-    while (swapchain_diff != WindowSwapchainDiff::None) {
-      {
-        // VLK_TRACE(trace_context, "Swapchain", "Recreation");
-        window.handle->recreate_swapchain(vk_render_context);
-      }
-
-      {
-        //   VLK_TRACE(trace_context, "Swapchain", "Presentation");
-        swapchain_diff = window.handle->present_backing_store(
-            pipeline->tile_cache.backing_store_cache.get_surface_ref());
-      }
-    }
-
     // we need to update viewport in case it changed
     pipeline->viewport.resize(
         window.handle->extent,
@@ -252,13 +247,28 @@ void App::tick() {
 
     // TODO(lamarrr): log refresh rate
     present_refresh_rate_hz = static_cast<uint32_t>(display_mode.refresh_rate);
+    frame_budget = frequency_to_period(present_refresh_rate_hz);
+    render_thread->set_frame_budget(frame_budget);
 
     window_extent_changed = false;
 
-    auto render_end = std::chrono::steady_clock::now();
+    render_thread->resume();
+  }
 
-    total_used = render_end - begin;
-    // we can save power on minimized and not have to update the buffer
+  BackingStoreDiff backing_store_diff = BackingStoreDiff::None;
+
+  {
+    // VLK_TRACE(trace_context, "Swapchain", "Pipeline Tick");
+    backing_store_diff = pipeline->record(begin - last_tick_begin);
+  }
+
+  last_tick_begin = begin;
+
+  // frame N is rasterized and presented on the render thread whilst frame N+1
+  // is recorded. this only blocks if the render thread is more than a frame
+  // behind.
+  if (backing_store_diff != BackingStoreDiff::None) {
+    render_thread->submit(pipeline->tile_cache.snapshot);
   }
 
   // poll events to make the window not be marked as unresponsive.
@@ -268,14 +278,23 @@ void App::tick() {
   do {
   } while (window_api.poll_events());
 
-  total_used = std::chrono::steady_clock::now() - begin;
+  // nothing changes on-screen until an event is received or a background
+  // task completes, so we block instead of ticking at the refresh rate
+  if (pipeline->is_idle() && !window_extent_changed &&
+      window.handle->event_queue.empty()) {
+    if (window_api.wait_events(kIdleWaitTimeout)) {
+      do {
+      } while (window_api.poll_events());
+    }
+  } else {
+    total_used = std::chrono::steady_clock::now() - begin;
 
-  if (total_used < frame_budget) {
-    std::this_thread::sleep_for(frame_budget - total_used);
+    if (total_used < frame_budget) {
+      std::this_thread::sleep_for(frame_budget - total_used);
+    }
   }
 
-  pipeline->dispatch_events(window.handle->event_queue.mouse_button_events,
-                            window.handle->event_queue.window_events);
+  pipeline->dispatch_events(window.handle->event_queue);
 
   window_extent_changed = any_eq(window.handle->event_queue.window_events,
                                  WindowEvent::SizeChanged);
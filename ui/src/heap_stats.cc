@@ -0,0 +1,63 @@
+#include "vlk/ui/heap_stats.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// replaces the global allocation functions. the array, nothrow, and sized
+// variants forward to these.
+
+namespace {
+
+std::atomic<uint64_t> num_allocations{0};
+std::atomic<uint64_t> num_deallocations{0};
+std::atomic<uint64_t> bytes_allocated{0};
+
+void *counted_allocate(std::size_t size, std::size_t alignment) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+
+  if (size == 0) size = 1;
+
+  void *memory = nullptr;
+
+  if (alignment <= alignof(std::max_align_t)) {
+    memory = std::malloc(size);
+  } else {
+    // aligned_alloc requires the size to be a multiple of the alignment
+    std::size_t const aligned_size = (size + alignment - 1) & ~(alignment - 1);
+    memory = std::aligned_alloc(alignment, aligned_size);
+  }
+
+  if (memory == nullptr) throw std::bad_alloc{};
+
+  return memory;
+}
+
+void counted_deallocate(void *memory) {
+  if (memory == nullptr) return;
+  num_deallocations.fetch_add(1, std::memory_order_relaxed);
+  std::free(memory);
+}
+
+}  // namespace
+
+vlk::ui::HeapStats vlk::ui::get_heap_stats() {
+  return HeapStats{num_allocations.load(std::memory_order_relaxed),
+                   num_deallocations.load(std::memory_order_relaxed),
+                   bytes_allocated.load(std::memory_order_relaxed)};
+}
+
+void *operator new(std::size_t size) {
+  return counted_allocate(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+  return counted_allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *memory) noexcept { counted_deallocate(memory); }
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+  counted_deallocate(memory);
+}
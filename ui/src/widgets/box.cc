@@ -115,7 +115,9 @@ void Box::update_props(BoxProps new_props) {
   diff_ |= impl::box_props_diff(storage_.props, new_props);
 
   storage_.props = std::move(new_props);
-  // actually update
+
+  // the props are applied and the background image is loaded on tick
+  Widget::subscribe_ticks();
 }
 
 void Box::draw(Canvas &canvas) {
@@ -304,6 +306,13 @@ void Box::tick(std::chrono::nanoseconds interval,
     Widget::add_dirtiness(dirtiness);
     diff_ = impl::BoxDiff::None;
   }
+
+  bool const is_loading = storage_.background.is_some() &&
+                          storage_.background.value().future.is_pending();
+
+  if (!is_loading) {
+    Widget::unsubscribe_ticks();
+  }
 }
 
 }  // namespace ui
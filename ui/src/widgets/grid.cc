@@ -0,0 +1,261 @@
+#include "vlk/ui/widgets/grid.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace vlk {
+namespace ui {
+
+Grid::Grid(WidgetBuilder builder, GridProps const &props,
+           GridSpanProvider span_provider, WidgetRecycler recycler)
+    : Widget{WidgetType::View},
+      builder_{std::move(builder)},
+      span_provider_{std::move(span_provider)},
+      recycler_{std::move(recycler)} {
+  Widget::init_places_children(true);
+  Widget::set_debug_info(WidgetDebugInfo{"Grid", "Grid"});
+  // the grid's content is only scrolled vertically
+  Widget::update_view_extent(ViewExtent{Constrain::relative(1.0f),
+                                        Constrain::unbounded(stx::u32_max)});
+  update_props(props);
+}
+
+Grid::~Grid() {
+  for (Widget *item : items_) {
+    delete item;
+  }
+
+  for (Widget *item : pool_) {
+    delete item;
+  }
+}
+
+void Grid::update_props(GridProps const &props) {
+  VLK_ENSURE(props.columns() != 0, "Grid must have at least one column",
+             *this);
+  VLK_ENSURE(props.cell_extent().height != 0,
+             "Grid's cell height must be non-zero", *this);
+
+  props_ = props;
+
+  Widget::update_self_extent(props.extent());
+
+  compute_placement();
+
+  // the cells could have been moved
+  Widget::mark_layout_dirty();
+  range_dirty_ = true;
+
+  // the materialized range is only re-computed whilst it could move
+  Widget::subscribe_ticks();
+}
+
+void Grid::scroll_to(uint32_t offset) {
+  scroll_offset_ = offset;
+  Widget::update_view_offset(ViewOffset::scroll(0, offset));
+  Widget::subscribe_ticks();
+}
+
+void Grid::compute_placement() {
+  cells_.clear();
+  num_span_rows_ = 0;
+  max_row_span_ = 1;
+
+  if (!span_provider_) return;
+
+  uint32_t const columns = props_.columns();
+  size_t const item_count = props_.item_count();
+
+  cells_.resize(item_count);
+
+  // first free row on each column, at or after the cursor's row. since items
+  // are placed in order and never before the cursor, the occupied cells of a
+  // column at or after the cursor's row are always contiguous.
+  std::vector<uint32_t> column_tops;
+  column_tops.resize(columns, 0);
+
+  uint32_t row = 0;
+  uint32_t column = 0;
+
+  for (size_t i = 0; i < item_count; i++) {
+    GridSpan span = span_provider_(i);
+    span.rows = std::max<uint32_t>(span.rows, 1);
+    span.columns = std::clamp<uint32_t>(span.columns, 1, columns);
+
+    while (true) {
+      if (column + span.columns > columns) {
+        row++;
+        column = 0;
+        continue;
+      }
+
+      if (std::all_of(column_tops.begin() + column,
+                      column_tops.begin() + column + span.columns,
+                      [row](uint32_t top) { return top <= row; })) {
+        break;
+      }
+
+      column++;
+    }
+
+    cells_[i] = Cell{row, column, span};
+
+    std::fill(column_tops.begin() + column,
+              column_tops.begin() + column + span.columns, row + span.rows);
+
+    column += span.columns;
+    num_span_rows_ = std::max(num_span_rows_, row + span.rows);
+    max_row_span_ = std::max(max_row_span_, span.rows);
+  }
+}
+
+Grid::Cell Grid::get_cell(size_t index) const {
+  if (span_provider_) return cells_[index];
+
+  uint32_t const columns = props_.columns();
+
+  return Cell{static_cast<uint32_t>(index / columns),
+              static_cast<uint32_t>(index % columns), GridSpan{}};
+}
+
+uint32_t Grid::get_num_rows() const {
+  if (span_provider_) return num_span_rows_;
+
+  uint32_t const columns = props_.columns();
+
+  return static_cast<uint32_t>((props_.item_count() + columns - 1) / columns);
+}
+
+Rect Grid::get_cell_rect(size_t index) const {
+  Cell const cell = get_cell(index);
+  Extent const cell_extent = props_.cell_extent();
+  uint32_t const spacing = props_.spacing();
+
+  return Rect{Offset{cell.column * (cell_extent.width + spacing),
+                     cell.row * (cell_extent.height + spacing)},
+              Extent{cell.span.columns * cell_extent.width +
+                         (cell.span.columns - 1) * spacing,
+                     cell.span.rows * cell_extent.height +
+                         (cell.span.rows - 1) * spacing}};
+}
+
+Rect Grid::get_child_rect(size_t index, Extent) {
+  return get_cell_rect(range_begin_ + index);
+}
+
+Extent Grid::get_children_span(Extent) {
+  Extent const cell_extent = props_.cell_extent();
+  uint32_t const spacing = props_.spacing();
+  uint32_t const columns = props_.columns();
+  uint32_t const rows = get_num_rows();
+
+  uint32_t const width = columns * (cell_extent.width + spacing) - spacing;
+  uint32_t const height =
+      rows == 0 ? 0 : (rows * (cell_extent.height + spacing) - spacing);
+
+  return Extent{width, height};
+}
+
+void Grid::release(Widget *item) {
+  if (recycler_ && pool_.size() < items_.size()) {
+    pool_.push_back(item);
+  } else {
+    delete item;
+  }
+}
+
+Widget *Grid::acquire(size_t index) {
+  if (recycler_ && !pool_.empty()) {
+    Widget *item = pool_.back();
+    if (recycler_(*item, index)) {
+      pool_.pop_back();
+      return item;
+    }
+  }
+
+  Widget *item = builder_(index);
+
+  VLK_ENSURE(item != nullptr, "Grid's builder returned a null widget", *this);
+
+  return item;
+}
+
+void Grid::materialize(size_t begin, size_t end) {
+  scratch_.clear();
+  scratch_.resize(end - begin, nullptr);
+
+  // retain the items that are still within the range
+  for (size_t index = std::max(begin, range_begin_);
+       index < std::min(end, range_end_); index++) {
+    scratch_[index - begin] = items_[index - range_begin_];
+    items_[index - range_begin_] = nullptr;
+  }
+
+  for (Widget *item : items_) {
+    if (item != nullptr) release(item);
+  }
+
+  for (size_t index = begin; index < end; index++) {
+    if (scratch_[index - begin] == nullptr) {
+      scratch_[index - begin] = acquire(index);
+    }
+  }
+
+  std::swap(items_, scratch_);
+  range_begin_ = begin;
+  range_end_ = end;
+  range_dirty_ = false;
+
+  Widget::update_children(items_);
+}
+
+void Grid::tick(std::chrono::nanoseconds, SubsystemsContext const &) {
+  uint64_t const viewport_extent = Widget::get_layout_extent().height;
+  uint64_t const row_extent =
+      static_cast<uint64_t>(props_.cell_extent().height) + props_.spacing();
+  uint64_t const cache_extent = props_.cache_extent();
+  size_t const item_count = props_.item_count();
+
+  uint64_t const begin_offset =
+      scroll_offset_ > cache_extent ? scroll_offset_ - cache_extent : 0;
+  uint64_t const end_offset = scroll_offset_ + viewport_extent + cache_extent;
+
+  uint64_t const begin_row = begin_offset / row_extent;
+  uint64_t const end_row = (end_offset + row_extent - 1) / row_extent;
+
+  size_t begin = 0;
+  size_t end = 0;
+
+  if (span_provider_) {
+    // items starting up to `max_row_span_ - 1` rows above the first visible
+    // row could still be intersecting it
+    uint64_t const first_row =
+        begin_row >= max_row_span_ ? begin_row - (max_row_span_ - 1) : 0;
+
+    auto const row_less = [](Cell const &cell, uint64_t row) {
+      return cell.row < row;
+    };
+
+    begin = std::lower_bound(cells_.begin(), cells_.end(), first_row,
+                             row_less) -
+            cells_.begin();
+    end = std::lower_bound(cells_.begin(), cells_.end(), end_row, row_less) -
+          cells_.begin();
+  } else {
+    uint64_t const columns = props_.columns();
+    begin = std::min<uint64_t>(item_count, begin_row * columns);
+    end = std::min<uint64_t>(item_count, end_row * columns);
+  }
+
+  if (range_dirty_ || begin != range_begin_ || end != range_end_) {
+    materialize(begin, end);
+  } else {
+    // settled until scrolled, resized, or its props are updated
+    Widget::unsubscribe_ticks();
+  }
+}
+
+void Grid::on_layout_extent_changed(Extent) { Widget::subscribe_ticks(); }
+
+}  // namespace ui
+}  // namespace vlk
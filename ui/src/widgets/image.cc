@@ -73,6 +73,9 @@ void Image::update_props(ImageProps props) {
   diff_ |= impl::image_props_diff(storage_.props, props);
 
   storage_ = impl::ImageStorage{std::move(props)};
+
+  // the props are applied and the image is loaded on tick
+  Widget::subscribe_ticks();
 }
 // TODO(lamarrr): once the asset is discarded, the tick calls marK_render_dirty
 // which then triggers another draw call, we should wait for another draw call
@@ -239,6 +242,10 @@ void Image::tick(std::chrono::nanoseconds interval,
     Widget::add_dirtiness(dirtiness);
     diff_ = impl::ImageDiff::None;
   }
+
+  if (!storage_.image.value().image.is_pending()) {
+    Widget::unsubscribe_ticks();
+  }
 }
 
 }  // namespace ui
@@ -0,0 +1,387 @@
+#include "vlk/ui/widgets/label.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPaint.h"
+#include "include/core/SkTextBlob.h"
+#include "modules/skparagraph/include/ParagraphBuilder.h"
+#include "modules/skparagraph/include/TextStyle.h"
+#include "vlk/subsystems/asset_loader.h"
+#include "vlk/utils.h"
+
+namespace sktext = skia::textlayout;
+
+namespace vlk {
+namespace ui {
+
+namespace impl {
+
+// decodes the code point at `iter` and advances past it. returns -1 if the
+// text isn't valid UTF-8.
+inline SkUnichar next_code_point(char const*& iter, char const* end) {
+  auto const lead = static_cast<uint8_t>(*iter);
+
+  size_t num_bytes = 0;
+  SkUnichar code_point = 0;
+
+  if (lead < 0x80) {
+    num_bytes = 1;
+    code_point = lead;
+  } else if ((lead & 0xE0) == 0xC0) {
+    num_bytes = 2;
+    code_point = lead & 0x1F;
+  } else if ((lead & 0xF0) == 0xE0) {
+    num_bytes = 3;
+    code_point = lead & 0x0F;
+  } else if ((lead & 0xF8) == 0xF0) {
+    num_bytes = 4;
+    code_point = lead & 0x07;
+  } else {
+    return -1;
+  }
+
+  if (static_cast<size_t>(end - iter) < num_bytes) return -1;
+
+  for (size_t i = 1; i < num_bytes; i++) {
+    auto const continuation = static_cast<uint8_t>(iter[i]);
+    if ((continuation & 0xC0) != 0x80) return -1;
+    code_point = (code_point << 6) | (continuation & 0x3F);
+  }
+
+  iter += num_bytes;
+
+  return code_point;
+}
+
+// the code points whose glyphs are positioned by their advances alone
+constexpr bool is_simple_code_point(SkUnichar code_point) {
+  // printable ascii, control characters (i.e. line breaks and tabs) excluded
+  if (code_point >= 0x20 && code_point <= 0x7E) return true;
+
+  // latin-1 supplement, latin extended-a and b, ipa extensions and spacing
+  // modifiers. the soft hyphen is a line breaking opportunity.
+  if (code_point >= 0xA0 && code_point <= 0x2FF) return code_point != 0xAD;
+
+  // greek and cyrillic, the cyrillic combining marks excluded
+  if (code_point >= 0x370 && code_point <= 0x482) return true;
+  if (code_point >= 0x48A && code_point <= 0x52F) return true;
+
+  // latin extended additional and greek extended
+  if (code_point >= 0x1E00 && code_point <= 0x1FFF) return true;
+
+  // dashes, quotes and punctuation, the zero-width and bidirectional controls
+  // and line separators excluded
+  if (code_point >= 0x2010 && code_point <= 0x2027) return true;
+  if (code_point >= 0x2030 && code_point <= 0x205E) return true;
+
+  // currency symbols, letterlike symbols, number forms, arrows and
+  // mathematical operators
+  if (code_point >= 0x20A0 && code_point <= 0x20C0) return true;
+  if (code_point >= 0x2100 && code_point <= 0x22FF) return true;
+
+  return false;
+}
+
+bool is_simple_text(std::string_view utf8_text) {
+  char const* iter = utf8_text.data();
+  char const* const end = utf8_text.data() + utf8_text.size();
+
+  while (iter < end) {
+    SkUnichar const code_point = next_code_point(iter, end);
+    if (code_point == -1 || !is_simple_code_point(code_point)) return false;
+  }
+
+  return true;
+}
+
+inline size_t count_code_points(std::string_view utf8_text) {
+  return std::count_if(utf8_text.begin(), utf8_text.end(), [](char c) {
+    return (static_cast<uint8_t>(c) & 0xC0) != 0x80;
+  });
+}
+
+}  // namespace impl
+
+Label::Label(std::string utf8_text, ParagraphProps props)
+    : text_{std::move(utf8_text)}, storage_{std::move(props), stx::None} {
+  typeface_ = get_font_collection().get_default_typeface();
+  Widget::update_needs_trimming(true);
+  // laid out with the default typeface until the font is loaded on tick
+  layout_label();
+  Widget::subscribe_ticks();
+}
+
+void Label::update_text(std::string utf8_text) {
+  if (utf8_text == text_) return;
+  text_ = std::move(utf8_text);
+  layout_label();
+}
+
+void Label::update_props(ParagraphProps props) {
+  FontSource const previous_font = storage_.props.font();
+
+  storage_.props = std::move(props);
+
+  if (storage_.props.font() != previous_font) {
+    storage_.font_future = stx::None;
+    typeface_ = get_font_collection().get_default_typeface();
+    // the font is loaded on tick
+    Widget::subscribe_ticks();
+  }
+
+  layout_label();
+}
+
+Extent Label::trim(Extent extent) {
+  float const width = static_cast<float>(extent.width);
+
+  if (fits(width)) {
+    return Extent{extent.width, static_cast<uint32_t>(std::ceil(line_height_))};
+  }
+
+  // the label wraps, or isn't simple
+  float const height = get_paragraph().layout(width);
+
+  return Extent{extent.width, static_cast<uint32_t>(std::ceil(height))};
+}
+
+void Label::draw(Canvas& canvas) {
+  SkCanvas& sk_canvas = canvas.to_skia();
+  Extent const widget_extent = canvas.extent();
+  float const width = static_cast<float>(widget_extent.width);
+
+  sk_canvas.save();
+  sk_canvas.clipRect(SkRect::MakeWH(widget_extent.width, widget_extent.height));
+
+  if (fits(width)) {
+    ParagraphProps const& props = storage_.props;
+
+    float x = 0.0f;
+
+    switch (props.align()) {
+      case TextAlign::Center:
+        x = (width - advance_) / 2.0f;
+        break;
+      case TextAlign::Right:
+      case TextAlign::End:
+        x = width - advance_;
+        break;
+      default:
+        break;
+    }
+
+    if (props.background_color() != colors::Transparent) {
+      SkPaint background_paint;
+      background_paint.setAntiAlias(props.antialias());
+      background_paint.setColor(props.background_color().to_argb());
+      sk_canvas.drawRect(SkRect::MakeXYWH(x, 0.0f, advance_, line_height_),
+                         background_paint);
+    }
+
+    if (blob_ != nullptr) {
+      SkPaint paint;
+      paint.setAntiAlias(props.antialias());
+      paint.setColor(props.color().to_argb());
+      sk_canvas.drawTextBlob(blob_, x, ascent_, paint);
+    }
+  } else {
+    CachedParagraph& paragraph = get_paragraph();
+    paragraph.layout(width);
+    paragraph.paragraph->paint(&sk_canvas, 0.0f, 0.0f);
+  }
+
+  sk_canvas.restore();
+}
+
+void Label::tick(std::chrono::nanoseconds interval,
+                 SubsystemsContext const& context) {
+  if (font_collection_ == nullptr) {
+    font_collection_ = context.get("VLK_FontCollection")
+                           .unwrap()
+                           .handle->as<SharedFontCollection>()
+                           .unwrap();
+    // the paragraph was built with the unbound collection
+    paragraph_ = nullptr;
+  }
+
+  auto tmp = context.get("VLK_AssetLoader").unwrap();
+  auto asset_loader = tmp.handle->as<AssetLoader>().unwrap();
+
+  storage_.font_future.match(
+      [interval](impl::FontFuture& future) { future.awaiter.tick(interval); },
+      []() {});
+
+  if (storage_.font_future.is_none()) {
+    FontSource const source = storage_.props.font();
+
+    auto on_loaded =
+        stx::fn::rc::make_functor(stx::os_allocator, [this]() {
+          storage_.font_future.value().awaiter.future_.ref().match(
+              [&](stx::Result<FontAsset, FontLoadError>* result) {
+                result->match(
+                    [&](FontAsset const& asset) {
+                      // registered for the paragraph engine's fallback
+                      get_font_collection().register_typeface(
+                          impl::get_source_tag(storage_.props.font()),
+                          asset.get_raw());
+                      typeface_ = asset.get_raw();
+                    },
+                    [](FontLoadError) {});
+              },
+              [](stx::FutureError) {});
+
+          layout_label();
+        }).unwrap();
+
+    if (std::holds_alternative<SystemFont>(source)) {
+      storage_.font_future = stx::Some(impl::FontFuture{
+          source,
+          FutureAwaiter{asset_loader->load_font(std::get<SystemFont>(source)),
+                        std::move(on_loaded)}});
+    } else if (std::holds_alternative<FileTypefaceSource>(source)) {
+      storage_.font_future = stx::Some(impl::FontFuture{
+          source,
+          FutureAwaiter{
+              asset_loader->load_font(std::get<FileTypefaceSource>(source)),
+              std::move(on_loaded)}});
+    } else if (std::holds_alternative<MemoryTypefaceSource>(source)) {
+      storage_.font_future = stx::Some(impl::FontFuture{
+          source,
+          FutureAwaiter{
+              asset_loader->load_font(std::get<MemoryTypefaceSource>(source)),
+              std::move(on_loaded)}});
+    } else {
+      VLK_PANIC("UNSUPPORTED");
+    }
+  }
+
+  bool const is_loading = storage_.font_future.is_some() &&
+                          storage_.font_future.value().awaiter.is_pending();
+
+  if (!is_loading) Widget::unsubscribe_ticks();
+}
+
+void Label::layout_label() {
+  ParagraphProps const& props = storage_.props;
+
+  is_fast_path_ = false;
+  blob_ = nullptr;
+  paragraph_ = nullptr;
+
+  if (props.direction() == TextDirection::Ltr &&
+      props.decoration() == TextDecoration::None &&
+      impl::is_simple_text(text_)) {
+    FontGlyphs& glyphs = get_font_collection().get_glyph_cache().get(
+        typeface_, props.font_size());
+
+    size_t const num_glyphs = impl::count_code_points(text_);
+
+    SkTextBlobBuilder builder;
+    SkTextBlobBuilder::RunBuffer const run =
+        builder.allocRunPosH(glyphs.font, static_cast<int>(num_glyphs), 0.0f);
+
+    char const* iter = text_.data();
+    char const* const end = text_.data() + text_.size();
+
+    float advance = 0.0f;
+    float word_advance = 0.0f;
+    float min_advance = 0.0f;
+    bool has_all_glyphs = true;
+
+    for (size_t i = 0; i < num_glyphs && has_all_glyphs; i++) {
+      SkUnichar const code_point = impl::next_code_point(iter, end);
+      Glyph const glyph = glyphs.get(code_point);
+
+      // the typeface doesn't cover the text, the paragraph engine resolves a
+      // fallback typeface for it
+      has_all_glyphs = glyph.id != 0;
+
+      run.glyphs[i] = glyph.id;
+      run.pos[i] = advance;
+
+      float glyph_advance = glyph.advance + props.letter_spacing();
+
+      if (code_point == ' ') {
+        glyph_advance += props.word_spacing();
+        word_advance = 0.0f;
+      } else {
+        word_advance += glyph_advance;
+        min_advance = std::max(min_advance, word_advance);
+      }
+
+      advance += glyph_advance;
+    }
+
+    if (has_all_glyphs) {
+      is_fast_path_ = true;
+      blob_ = builder.make();
+      advance_ = advance;
+      min_advance_ = min_advance;
+      ascent_ = -glyphs.metrics.fAscent;
+      line_height_ = glyphs.metrics.fDescent - glyphs.metrics.fAscent +
+                     glyphs.metrics.fLeading;
+    }
+  }
+
+  if (is_fast_path_) {
+    SelfExtent extent{};
+    extent.width.min = static_cast<int64_t>(std::ceil(min_advance_));
+    extent.width.max = static_cast<int64_t>(std::ceil(advance_));
+    extent.width.bias = extent.width.max;
+
+    extent.height.min = static_cast<int64_t>(std::ceil(line_height_));
+    extent.height.max = extent.height.min;
+    extent.height.bias = extent.height.min;
+
+    Widget::update_self_extent(extent);
+  } else {
+    Widget::update_self_extent(get_paragraph().intrinsic_extent.value());
+  }
+
+  Widget::mark_layout_dirty();
+  Widget::mark_render_dirty();
+}
+
+CachedParagraph& Label::get_paragraph() {
+  if (paragraph_ != nullptr) return *paragraph_;
+
+  std::shared_ptr<ShapingContext> const& shaping_context =
+      get_font_collection().get_shaping_context();
+
+  sktext::TextStyle const text_style =
+      impl::make_text_style(impl::InlineTextStorage{text_}, storage_);
+
+  paragraph_ = std::make_unique<CachedParagraph>();
+  paragraph_->shaping_context = shaping_context;
+
+  {
+    std::lock_guard lock{shaping_context->mutex};
+
+    std::unique_ptr<sktext::ParagraphBuilder> builder =
+        shaping_context->make_paragraph_builder(
+            impl::make_paragraph_style(storage_.props));
+
+    builder->pushStyle(text_style);
+    builder->addText(text_.data(), text_.size());
+    builder->pop();
+
+    paragraph_->paragraph = builder->Build();
+  }
+
+  VLK_ENSURE(paragraph_->paragraph != nullptr);
+
+  paragraph_->intrinsic_extent = stx::Some(paragraph_->measure());
+
+  return *paragraph_;
+}
+
+}  // namespace ui
+}  // namespace vlk
@@ -0,0 +1,214 @@
+#include "vlk/ui/widgets/list.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "vlk/utils.h"
+
+namespace vlk {
+namespace ui {
+
+namespace impl {
+
+constexpr uint32_t main_axis(Direction direction, Extent const &extent) {
+  return direction == Direction::Row ? extent.width : extent.height;
+}
+
+inline Extent main_axis_extent(Direction direction, uint64_t extent) {
+  uint32_t const clamped = u32_clamp(static_cast<int64_t>(extent));
+  return direction == Direction::Row ? Extent{clamped, 0} : Extent{0, clamped};
+}
+
+}  // namespace impl
+
+VirtualList::VirtualList(WidgetBuilder builder, VirtualListProps const &props,
+                         WidgetRecycler recycler)
+    : Widget{WidgetType::View},
+      builder_{std::move(builder)},
+      recycler_{std::move(recycler)} {
+  Widget::init_is_flex(true);
+  Widget::set_debug_info(WidgetDebugInfo{"VirtualList", "VirtualList"});
+  update_props(props);
+  children_ = {&leading_, &trailing_};
+  Widget::update_children(children_);
+}
+
+VirtualList::~VirtualList() {
+  for (Widget *item : items_) {
+    delete item;
+  }
+
+  for (Widget *item : pool_) {
+    delete item;
+  }
+}
+
+void VirtualList::update_props(VirtualListProps const &props) {
+  VLK_ENSURE(props.item_extent_estimate() != 0,
+             "VirtualList's item extent estimate must be non-zero", *this);
+
+  props_ = props;
+  materialized_count_ = props.item_count();
+
+  Flex flex{};
+  flex.direction = props.direction();
+  flex.wrap = Wrap::None;
+  flex.main_align = MainAlign::Start;
+  flex.cross_align = CrossAlign::Start;
+  flex.main_fit = Fit::Shrink;
+  flex.cross_fit = Fit::Expand;
+
+  Widget::update_flex(flex);
+  Widget::update_self_extent(props.extent());
+
+  // the view is unconstrained along the main-axis
+  if (props.direction() == Direction::Row) {
+    Widget::update_view_extent(ViewExtent{
+        Constrain::unbounded(stx::u32_max), Constrain::relative(1.0f)});
+  } else {
+    Widget::update_view_extent(ViewExtent{
+        Constrain::relative(1.0f), Constrain::unbounded(stx::u32_max)});
+  }
+
+  // the number of items or the cache extent could have changed
+  range_dirty_ = true;
+
+  scroll_to(scroll_offset_);
+}
+
+void VirtualList::scroll_to(uint32_t offset) {
+  scroll_offset_ = offset;
+
+  // the materialized range is only re-computed whilst it could move
+  Widget::subscribe_ticks();
+
+  if (props_.direction() == Direction::Row) {
+    Widget::update_view_offset(ViewOffset::scroll(offset, 0));
+  } else {
+    Widget::update_view_offset(ViewOffset::scroll(0, offset));
+  }
+}
+
+uint32_t VirtualList::get_item_extent_estimate() const {
+  if (num_measured_ == 0) return props_.item_extent_estimate();
+
+  return std::max<uint32_t>(
+      1, static_cast<uint32_t>(measured_extent_sum_ / num_measured_));
+}
+
+void VirtualList::release(Widget *item) {
+  uint32_t const measured_extent =
+      impl::main_axis(props_.direction(), item->get_layout_extent());
+
+  // items that were never laid out don't contribute to the estimate
+  if (measured_extent != 0) {
+    measured_extent_sum_ += measured_extent;
+    num_measured_++;
+  }
+
+  if (recycler_ && pool_.size() < items_.size()) {
+    pool_.push_back(item);
+  } else {
+    delete item;
+  }
+}
+
+Widget *VirtualList::acquire(size_t index) {
+  if (recycler_ && !pool_.empty()) {
+    Widget *item = pool_.back();
+    if (recycler_(*item, index)) {
+      pool_.pop_back();
+      return item;
+    }
+  }
+
+  return builder_(index);
+}
+
+void VirtualList::materialize(size_t begin, size_t end) {
+  scratch_.clear();
+  scratch_.resize(end - begin, nullptr);
+
+  // retain the items that are still within the range
+  for (size_t index = std::max(begin, range_begin_);
+       index < std::min(end, range_end_); index++) {
+    scratch_[index - begin] = items_[index - range_begin_];
+    items_[index - range_begin_] = nullptr;
+  }
+
+  for (Widget *item : items_) {
+    if (item != nullptr) release(item);
+  }
+
+  for (size_t index = begin; index < end; index++) {
+    if (scratch_[index - begin] != nullptr) continue;
+
+    Widget *item = acquire(index);
+
+    if (item == nullptr) {
+      // the builder signals the end of the list. no item after this index can
+      // be materialized
+      for (size_t i = index + 1; i < end; i++) {
+        if (scratch_[i - begin] != nullptr) release(scratch_[i - begin]);
+      }
+      scratch_.resize(index - begin);
+      end = index;
+      materialized_count_ = index;
+      break;
+    }
+
+    scratch_[index - begin] = item;
+  }
+
+  std::swap(items_, scratch_);
+  range_begin_ = begin;
+  range_end_ = end;
+  range_dirty_ = false;
+
+  uint64_t const item_extent = get_item_extent_estimate();
+
+  leading_.update_extent(
+      impl::main_axis_extent(props_.direction(), item_extent * begin));
+  trailing_.update_extent(impl::main_axis_extent(
+      props_.direction(), item_extent * (materialized_count_ - end)));
+
+  children_.clear();
+  children_.push_back(&leading_);
+  children_.insert(children_.end(), items_.begin(), items_.end());
+  children_.push_back(&trailing_);
+
+  Widget::update_children(children_);
+}
+
+void VirtualList::tick(std::chrono::nanoseconds, SubsystemsContext const &) {
+  uint64_t const viewport_extent =
+      impl::main_axis(props_.direction(), Widget::get_layout_extent());
+  uint64_t const item_extent = get_item_extent_estimate();
+  uint64_t const cache_extent = props_.cache_extent();
+  size_t const item_count = materialized_count_;
+
+  uint64_t const begin_offset =
+      scroll_offset_ > cache_extent ? scroll_offset_ - cache_extent : 0;
+  uint64_t const end_offset = scroll_offset_ + viewport_extent + cache_extent;
+
+  size_t const begin =
+      std::min<size_t>(item_count, begin_offset / item_extent);
+  size_t const end = std::min<size_t>(
+      item_count, (end_offset + item_extent - 1) / item_extent);
+
+  if (range_dirty_ || begin != range_begin_ || end != range_end_) {
+    // the materialized items' extents refine the estimate, the range is
+    // checked again on the next frame
+    materialize(begin, end);
+  } else {
+    // settled until scrolled, resized, or its props are updated
+    Widget::unsubscribe_ticks();
+  }
+}
+
+void VirtualList::on_layout_extent_changed(Extent) {
+  Widget::subscribe_ticks();
+}
+
+}  // namespace ui
+}  // namespace vlk
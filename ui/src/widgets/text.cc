@@ -2,19 +2,20 @@
 
 #include "vlk/ui/widgets/text.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "include/core/SkCanvas.h"
-#include "include/core/SkFontMgr.h"
 #include "modules/skparagraph/include/Paragraph.h"
 #include "modules/skparagraph/include/ParagraphBuilder.h"
 #include "modules/skparagraph/include/TextStyle.h"
-#include "modules/skparagraph/include/TypefaceFontProvider.h"
-#include "modules/skparagraph/src/ParagraphBuilderImpl.h"
 #include "modules/skparagraph/src/ParagraphImpl.h"
 #include "vlk/subsystems/asset_loader.h"
 #include "vlk/utils.h"
@@ -185,7 +186,7 @@ inline TextDiff inline_texts_diff(stx::Span<InlineTextStorage const> a,
   return diff;
 }
 
-inline std::string_view get_source_tag(FontSource const& font_source) {
+std::string_view get_source_tag(FontSource const& font_source) {
   if (std::holds_alternative<SystemFont>(font_source)) {
     return std::get<SystemFont>(font_source).data.handle->tag;
   } else if (std::holds_alternative<FileTypefaceSource>(font_source)) {
@@ -197,7 +198,7 @@ inline std::string_view get_source_tag(FontSource const& font_source) {
   }
 }
 
-inline sktext::TextStyle make_text_style(
+sktext::TextStyle make_text_style(
     impl::InlineTextStorage const& text_storage,
     impl::ParagraphStorage const& paragraph_storage) {
   sktext::TextStyle text_style;
@@ -333,7 +334,7 @@ inline sktext::TextStyle make_text_style(
   return text_style;
 }
 
-inline sktext::ParagraphStyle make_paragraph_style(
+sktext::ParagraphStyle make_paragraph_style(
     ParagraphProps const& paragraph_props) {
   sktext::ParagraphStyle paragraph_style;
 
@@ -379,9 +380,98 @@ inline sktext::ParagraphStyle make_paragraph_style(
   return paragraph_style;
 }
 
-inline std::unique_ptr<sktext::Paragraph> build_paragraph(
+template <typename T>
+inline void append_key(std::string& key, T const& value) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  key.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+inline void append_key(std::string& key, std::string_view str) {
+  append_key(key, str.size());
+  key.append(str.data(), str.size());
+}
+
+inline bool is_font_loaded(stx::Option<FontFuture> const& font_future) {
+  if (font_future.is_none()) return false;
+
+  bool is_loaded = false;
+
+  font_future.value().awaiter.future_.ref().match(
+      [&](stx::Result<FontAsset, FontLoadError>* result) {
+        is_loaded = result->is_ok();
+      },
+      [](stx::FutureError) {});
+
+  return is_loaded;
+}
+
+// serializes everything the paragraph is built from, as resolved by
+// `make_text_style` and `make_paragraph_style`. the font is identified by its
+// source tag and whether it is loaded, as it is only used once it is.
+inline std::string make_paragraph_key(
     stx::Span<impl::InlineTextStorage const> inline_texts,
     impl::ParagraphStorage const& paragraph_storage) {
+  auto const& default_props = paragraph_storage.props;
+
+  std::string key;
+
+  append_key(key, default_props.direction());
+  append_key(key, default_props.align());
+  append_key(key, default_props.line_limit());
+
+  for (auto const& inline_text : inline_texts) {
+    auto const& props = inline_text.props;
+
+    append_key(key, std::string_view{inline_text.text});
+    append_key(key, props.antialias().unwrap_or(default_props.antialias()));
+    append_key(key,
+               props.color().unwrap_or(default_props.color()).to_argb());
+    append_key(key, props.background_color()
+                        .unwrap_or(default_props.background_color())
+                        .to_argb());
+    append_key(key, props.decoration().unwrap_or(default_props.decoration()));
+    append_key(key, props.decoration_color()
+                        .unwrap_or(default_props.decoration_color())
+                        .to_argb());
+    append_key(key, props.decoration_style().unwrap_or(
+                        default_props.decoration_style()));
+    append_key(key, props.font_size().unwrap_or(default_props.font_size()));
+    append_key(key, props.letter_spacing().unwrap_or(
+                        default_props.letter_spacing()));
+    append_key(key,
+               props.word_spacing().unwrap_or(default_props.word_spacing()));
+    append_key(key, std::string_view{
+                        props.locale().unwrap_or(default_props.locale())});
+
+    if (props.font_ref().is_some()) {
+      append_key(key, get_source_tag(props.font_ref().value()));
+      append_key(key, is_font_loaded(inline_text.font_future));
+    } else {
+      append_key(key, get_source_tag(default_props.font_ref()));
+      append_key(key, is_font_loaded(paragraph_storage.font_future));
+    }
+  }
+
+  return key;
+}
+
+struct StyledText {
+  sktext::TextStyle style;
+  std::string text;
+};
+
+// everything the paragraph is built from, resolved on the UI thread so the
+// paragraph can be shaped on another
+struct ParagraphContent {
+  sktext::ParagraphStyle paragraph_style;
+  std::vector<StyledText> texts;
+  size_t text_size = 0;
+};
+
+inline ParagraphContent make_paragraph_content(
+    stx::Span<impl::InlineTextStorage const> inline_texts,
+    impl::ParagraphStorage const& paragraph_storage,
+    SharedFontCollection& font_collection) {
   // Skia's Font collection contains several font managers. one can be the
   // default system font manager that loads fonts that belongs to the system,
   // and the others can be custom font managers that load fonts from other paths
@@ -392,16 +482,11 @@ inline std::unique_ptr<sktext::Paragraph> build_paragraph(
   // Typeface is a variant of the Font. Example is Arial Bold Ultracondensed.
   // Typefaces are typically stored into files (i.e. .ttf, .woff files)
   //
+  // the collection is shared across the paragraphs so the font families are
+  // only resolved once, the loaded fonts are registered on it once.
 
-  sktext::ParagraphStyle paragraph_style =
-      make_paragraph_style(paragraph_storage.props);
-
-  sk_sp<sktext::FontCollection> font_collection =
-      sk_make_sp<sktext::FontCollection>();
-
-  font_collection->getParagraphCache()->turnOn(false);
-
-  sk_sp font_provider = sk_make_sp<sktext::TypefaceFontProvider>();
+  ParagraphContent content;
+  content.paragraph_style = make_paragraph_style(paragraph_storage.props);
 
   for (auto const& inline_text : inline_texts) {
     inline_text.font_future.as_ref().match(
@@ -416,9 +501,8 @@ inline std::unique_ptr<sktext::Paragraph> build_paragraph(
                           inline_text.props.font_ref().as_cref().unwrap_or(
                               paragraph_storage.props.font_ref());
                       std::string_view identifier = get_source_tag(font);
-                      font_provider->registerTypeface(
-                          asset.get_raw(),
-                          SkString{identifier.data(), identifier.size()});
+                      font_collection.register_typeface(identifier,
+                                                        asset.get_raw());
                     },
                     [](FontLoadError) {});
               },
@@ -427,77 +511,333 @@ inline std::unique_ptr<sktext::Paragraph> build_paragraph(
         []() {});
   }
 
-  font_collection->setAssetFontManager(font_provider);
+  for (auto const& inline_text : inline_texts) {
+    content.texts.push_back(StyledText{
+        make_text_style(inline_text, paragraph_storage), inline_text.text});
+    content.text_size += inline_text.text.size();
+  }
+
+  return content;
+}
+
+// builds the paragraph, it is shaped once first laid out. thread-safe.
+inline std::shared_ptr<CachedParagraph> build_paragraph(
+    ParagraphContent const& content,
+    std::shared_ptr<ShapingContext> const& shaping_context) {
+  std::shared_ptr paragraph = std::make_shared<CachedParagraph>();
+  paragraph->shaping_context = shaping_context;
+
+  {
+    std::lock_guard lock{shaping_context->mutex};
+
+    std::unique_ptr<sktext::ParagraphBuilder> paragraph_builder =
+        shaping_context->make_paragraph_builder(content.paragraph_style);
+
+    for (StyledText const& styled_text : content.texts) {
+      paragraph_builder->pushStyle(styled_text.style);
+      paragraph_builder->addText(styled_text.text.data(),
+                                 styled_text.text.size());
+    }
+
+    paragraph->paragraph = paragraph_builder->Build();
+  }
+
+  VLK_ENSURE(paragraph->paragraph != nullptr);
 
-  sk_sp<SkFontMgr> font_mgr = SkFontMgr::RefDefault();
+  return paragraph;
+}
 
-  if (font_mgr != nullptr) font_collection->setDefaultFontManager(font_mgr);
+// builds, shapes and measures the paragraph. thread-safe.
+inline std::shared_ptr<CachedParagraph> shape_paragraph(
+    ParagraphContent const& content,
+    std::shared_ptr<ShapingContext> const& shaping_context) {
+  std::shared_ptr paragraph = build_paragraph(content, shaping_context);
+  paragraph->intrinsic_extent = stx::Some(paragraph->measure());
+  return paragraph;
+}
 
-  std::unique_ptr<sktext::ParagraphBuilder> paragraph_builder =
-      sktext::ParagraphBuilderImpl::make(paragraph_style, font_collection);
+// average advance of a UTF-8 code unit and the line height, relative to the
+// font size
+constexpr float kEstimatedAdvance = 0.5f;
+constexpr float kEstimatedLineHeight = 1.2f;
 
-  VLK_ENSURE(paragraph_builder != nullptr);
+// a rough single-line estimate of the paragraph's extent, reported whilst it
+// is shaped
+inline SelfExtent estimate_extent(
+    stx::Span<impl::InlineTextStorage const> inline_texts,
+    impl::ParagraphStorage const& paragraph_storage) {
+  float width = 0.0f;
+  float line_height = 0.0f;
 
   for (auto const& inline_text : inline_texts) {
+    float const font_size = inline_text.props.font_size().unwrap_or(
+        paragraph_storage.props.font_size());
+    width += kEstimatedAdvance * font_size * inline_text.text.size();
+    line_height = std::max(line_height, kEstimatedLineHeight * font_size);
+  }
+
+  SelfExtent extent{};
+  extent.width.min = 0;
+  extent.width.max = static_cast<int64_t>(std::ceil(width));
+  extent.width.bias = extent.width.max;
+
+  extent.height.min = static_cast<int64_t>(std::ceil(line_height));
+  extent.height.max = extent.height.min;
+  extent.height.bias = extent.height.min;
+
+  return extent;
+}
+
+// replaces the paints of the paragraph's styled blocks. they don't affect the
+// paragraph's extent, but the paragraph must be laid out again before it is
+// painted with them (see `CachedParagraph::invalidate_layout`).
+inline void update_paint(sktext::Paragraph& paragraph,
+                         stx::Span<impl::InlineTextStorage const> inline_texts,
+                         impl::ParagraphStorage const& paragraph_storage) {
+  SkSpan<sktext::Block> blocks =
+      static_cast<sktext::ParagraphImpl&>(paragraph).styles();
+
+  size_t block = 0;
+  size_t begin = 0;
+
+  for (auto const& inline_text : inline_texts) {
+    size_t const end = begin + inline_text.text.size();
+
     sktext::TextStyle const text_style =
         make_text_style(inline_text, paragraph_storage);
-    paragraph_builder->pushStyle(text_style);
-    paragraph_builder->addText(inline_text.text.data(),
-                               inline_text.text.size());
-  }
 
-  std::unique_ptr<sktext::Paragraph> paragraph = paragraph_builder->Build();
+    // the blocks are ordered by their range of the text
+    while (block < blocks.size() && blocks[block].fRange.end <= end) {
+      if (blocks[block].fRange.start >= begin) {
+        sktext::TextStyle& style = blocks[block].fStyle;
+        style.setForegroundColor(text_style.getForeground());
+        style.setBackgroundColor(text_style.getBackground());
+        style.setDecoration(text_style.getDecorationType());
+        style.setDecorationColor(text_style.getDecorationColor());
+        style.setDecorationStyle(text_style.getDecorationStyle());
+      }
 
-  VLK_ENSURE(paragraph != nullptr);
+      block++;
+    }
 
-  return paragraph;
+    begin = end;
+  }
 }
+
 }  // namespace impl
 
-void Text::rebuild_paragraph() {
-  paragraph_ = impl::build_paragraph(inline_texts_, paragraph_storage_);
-  VLK_ENSURE(paragraph_ != nullptr);
+void Text::rebuild_paragraph(bool synchronous) {
+  SharedFontCollection& font_collection = get_font_collection();
+  ParagraphCache& paragraph_cache = font_collection.get_paragraph_cache();
 
-  // perform layout pass to get minimum and maximum width
-  paragraph_->layout(0.0F);
+  std::string key = impl::make_paragraph_key(inline_texts_, paragraph_storage_);
 
-  float const min_intrinsic_width = paragraph_->getMinIntrinsicWidth();
-  float const max_intrinsic_width = paragraph_->getMaxIntrinsicWidth();
+  // i.e. the font loaded and the text changed on the same frame
+  if (shaping_.is_some() && shaping_key_ == key) return;
 
-  // perform another layout pass to get the (maximum length, minimum height)
-  // values
-  paragraph_->layout(min_intrinsic_width);
-  float const max_intrinsic_height = paragraph_->getHeight();
+  // the paragraph being shaped (if any) is superseded
+  shaping_ = stx::None;
 
-  // perform another layout pass to get the (minimum length, maximum height)
-  // values
-  paragraph_->layout(max_intrinsic_width);
-  float const min_intrinsic_height = paragraph_->getHeight();
+  if (std::shared_ptr cached = paragraph_cache.find(key); cached != nullptr) {
+    adopt_paragraph(std::move(key), std::move(cached));
+    return;
+  }
 
-  // we request for max extent but still layout for the given extent.
-  SelfExtent extent{};
-  extent.width.min = static_cast<int64_t>(std::ceil(min_intrinsic_width));
-  extent.width.max = static_cast<int64_t>(std::ceil(max_intrinsic_width));
-  extent.width.bias = extent.width.max;
+  impl::ParagraphContent content = impl::make_paragraph_content(
+      inline_texts_, paragraph_storage_, font_collection);
 
-  extent.height.min = static_cast<int64_t>(std::ceil(min_intrinsic_height));
-  extent.height.max = static_cast<int64_t>(std::ceil(max_intrinsic_height));
-  extent.height.bias = extent.width.max;
+  if (synchronous || font_collection.is_shaping_synchronous()) {
+    std::shared_ptr paragraph = impl::shape_paragraph(
+        content, font_collection.get_shaping_context());
+    paragraph->size_bytes =
+        ParagraphCache::estimate_size(key, content.text_size);
+    paragraph_cache.insert(key, paragraph);
+    adopt_paragraph(std::move(key), std::move(paragraph));
+    return;
+  }
+
+  shaping_key_ = std::move(key);
+  shaping_text_size_ = content.text_size;
+
+  shaping_ = stx::Some(FutureAwaiter{
+      font_collection.shape_async(
+          [content_ = std::move(content)](
+              std::shared_ptr<ShapingContext> const& shaping_context) {
+            return impl::shape_paragraph(content_, shaping_context);
+          }),
+      stx::fn::rc::make_static([] {})});
+
+  // the previous paragraph keeps being reported and drawn until then
+  if (paragraph_ == nullptr) {
+    Widget::update_self_extent(estimate_extent());
+  }
+}
+
+void Text::finish_shaping() {
+  std::shared_ptr<CachedParagraph> paragraph = nullptr;
+  bool failed = false;
+
+  shaping_.value().future_.ref().match(
+      [&](std::shared_ptr<CachedParagraph>* result) { paragraph = *result; },
+      [&](stx::FutureError) { failed = true; });
+
+  shaping_ = stx::None;
+
+  // i.e. the task was canceled by the scheduler. nothing else would re-queue
+  // the paragraph, and re-queueing it could fail again, so it is shaped on
+  // this thread instead
+  if (failed || paragraph == nullptr) {
+    rebuild_paragraph(true);
+    Widget::mark_layout_dirty();
+    Widget::mark_render_dirty();
+    return;
+  }
+
+  ParagraphCache& paragraph_cache = get_font_collection().get_paragraph_cache();
+
+  // an identical paragraph might have been cached whilst this one was shaped
+  if (std::shared_ptr cached = paragraph_cache.find(shaping_key_);
+      cached != nullptr) {
+    paragraph = std::move(cached);
+  } else {
+    paragraph->size_bytes =
+        ParagraphCache::estimate_size(shaping_key_, shaping_text_size_);
+    paragraph_cache.insert(shaping_key_, paragraph);
+  }
+
+  adopt_paragraph(std::move(shaping_key_), std::move(paragraph));
+
+  Widget::mark_layout_dirty();
+  Widget::mark_render_dirty();
+}
+
+SelfExtent Text::estimate_extent() const {
+  return impl::estimate_extent(inline_texts_, paragraph_storage_);
+}
+
+void Text::adopt_paragraph(std::string key,
+                           std::shared_ptr<CachedParagraph> paragraph) {
+  VLK_ENSURE(paragraph->intrinsic_extent.is_some());
+
+  paragraph_key_ = std::move(key);
+  paragraph_ = std::move(paragraph);
+  drawn_paragraph_ = nullptr;
+  generation_++;
 
   // NOTE: only updated if extent actually changes, in which reflow would occur
-  Widget::update_self_extent(extent);
+  Widget::update_self_extent(paragraph_->intrinsic_extent.value());
+}
+
+void Text::repaint_paragraph() {
+  ParagraphCache& paragraph_cache = get_font_collection().get_paragraph_cache();
+
+  // the copy is keyed by the previous paints
+  drawn_paragraph_ = nullptr;
+
+  std::string key = impl::make_paragraph_key(inline_texts_, paragraph_storage_);
+
+  // the shaping and layout are identical, so is the extent
+  if (std::shared_ptr cached = paragraph_cache.find(key); cached != nullptr) {
+    paragraph_ = std::move(cached);
+    paragraph_key_ = std::move(key);
+    return;
+  }
+
+  bool const is_cached =
+      paragraph_cache.holds(paragraph_key_, paragraph_.get());
+
+  // other widgets share the paragraph, so it is rebuilt rather than modified
+  if (paragraph_.use_count() > (is_cached ? 2 : 1)) {
+    rebuild_paragraph();
+    return;
+  }
+
+  if (is_cached) paragraph_cache.erase(paragraph_key_);
+
+  impl::update_paint(*paragraph_->paragraph, inline_texts_,
+                     paragraph_storage_);
+  paragraph_->invalidate_layout();
+
+  paragraph_key_ = std::move(key);
+  paragraph_cache.insert(paragraph_key_, paragraph_);
+}
+
+CachedParagraph& Text::get_drawn_paragraph(float width) {
+  SharedFontCollection& font_collection = get_font_collection();
+  ParagraphCache& paragraph_cache = font_collection.get_paragraph_cache();
+
+  bool const is_shared =
+      paragraph_.use_count() >
+      (paragraph_cache.holds(paragraph_key_, paragraph_.get()) ? 2 : 1);
+
+  // whilst the next paragraph is shaped, the text no longer matches the
+  // shared paragraph's and no copy of it can be built
+  if (!is_shared || shaping_.is_some() || paragraph_->draw_width.is_none() ||
+      paragraph_->draw_width.value() == width) {
+    paragraph_->draw_width = stx::Some(float{width});
+    return *paragraph_;
+  }
+
+  if (drawn_paragraph_ != nullptr &&
+      drawn_paragraph_->draw_width.value() == width) {
+    return *drawn_paragraph_;
+  }
+
+  // another widget draws the shared paragraph at another width
+  std::string key = paragraph_key_;
+  impl::append_key(key, width);
+
+  std::shared_ptr paragraph = paragraph_cache.find(key);
+
+  if (paragraph == nullptr) {
+    impl::ParagraphContent const content = impl::make_paragraph_content(
+        inline_texts_, paragraph_storage_, font_collection);
+    paragraph = impl::build_paragraph(content,
+                                      font_collection.get_shaping_context());
+    paragraph->intrinsic_extent = paragraph_->intrinsic_extent.copy();
+    paragraph->draw_width = stx::Some(float{width});
+    paragraph->size_bytes =
+        ParagraphCache::estimate_size(key, content.text_size);
+    paragraph_cache.insert(std::move(key), paragraph);
+  }
+
+  drawn_paragraph_ = std::move(paragraph);
+
+  return *drawn_paragraph_;
+}
+
+float Text::layout_paragraph(float width) {
+  float const height = paragraph_->layout(width);
+
+  if (measurement_cache_.find(generation_, width).is_none()) {
+    measurement_cache_.insert(generation_, width, height);
+  }
+
+  return height;
 }
 
 void Text::update_text(std::vector<InlineText> inline_texts) {
   diff_ |= impl::inline_texts_diff(inline_texts_, inline_texts);
 
-  inline_texts_.clear();
+  // the loaded fonts are carried over, the inline texts whose font didn't
+  // change would otherwise be rebuilt once it is loaded again
+  if (inline_texts_.size() == inline_texts.size()) {
+    for (size_t i = 0; i < inline_texts.size(); i++) {
+      inline_texts_[i].text = std::move(inline_texts[i].text);
+      inline_texts_[i].props = std::move(inline_texts[i].props);
+    }
+  } else {
+    inline_texts_.clear();
 
-  for (InlineText& inline_text : inline_texts) {
-    impl::InlineTextStorage storage{std::move(inline_text.text),
-                                    std::move(inline_text.props), stx::None};
-    inline_texts_.push_back(std::move(storage));
+    for (InlineText& inline_text : inline_texts) {
+      impl::InlineTextStorage storage{std::move(inline_text.text),
+                                      std::move(inline_text.props), stx::None};
+      inline_texts_.push_back(std::move(storage));
+    }
   }
+
+  // the fonts are loaded and the paragraph is rebuilt on tick
+  Widget::subscribe_ticks();
 }
 
 void Text::update_paragraph_props(ParagraphProps paragraph_props) {
@@ -508,23 +848,43 @@ void Text::update_paragraph_props(ParagraphProps paragraph_props) {
   // this means the inline text's style and font might change
   paragraph_storage_ =
       impl::ParagraphStorage{std::move(paragraph_props), stx::None};
+
+  Widget::subscribe_ticks();
 }
 
 Extent Text::trim(Extent extent) {
-  VLK_ENSURE(paragraph_ != nullptr);
+  float const width = static_cast<float>(extent.width);
+
+  // the paragraph is still being shaped, its estimated lines are wrapped
+  if (paragraph_ == nullptr) {
+    SelfExtent const estimate = estimate_extent();
+    int64_t const num_lines =
+        extent.width == 0
+            ? 1
+            : std::max<int64_t>(1, (estimate.width.max + extent.width - 1) /
+                                       extent.width);
+    return Extent{extent.width,
+                  static_cast<uint32_t>(num_lines * estimate.height.max)};
+  }
 
   // whatever width is given to the text widget is used and its height is
-  // trimmed to fit the text's height
-  paragraph_->layout(extent.width);
-  return Extent{extent.width,
-                static_cast<uint32_t>(std::ceil(paragraph_->getHeight()))};
+  // trimmed to fit the text's height. the paragraph is only re-laid out if it
+  // hasn't been measured at this width since its text or style last changed.
+  float const height =
+      measurement_cache_.find(generation_, width).unwrap_or_else([&] {
+        return layout_paragraph(width);
+      });
+
+  return Extent{extent.width, static_cast<uint32_t>(std::ceil(height))};
 }
 
 void Text::draw(Canvas& canvas) {
   // TODO(lamarrr): rendering should be done at device scale. and cache should
   // be recorded at logical scale. i.e. offscreen rendered at physical scale and
   // recorded at onscreen scale
-  VLK_ENSURE(paragraph_ != nullptr);
+
+  // nothing is drawn until the paragraph is first shaped
+  if (paragraph_ == nullptr) return;
 
   SkCanvas& sk_canvas = canvas.to_skia();
 
@@ -535,9 +895,14 @@ void Text::draw(Canvas& canvas) {
   // the text might overflow so we clip just in case it actually does
   sk_canvas.clipRect(SkRect::MakeWH(widget_extent.width, widget_extent.height));
 
+  // measurements could have left the paragraph laid out at another width
+  CachedParagraph& paragraph =
+      get_drawn_paragraph(static_cast<float>(widget_extent.width));
+  paragraph.layout(static_cast<float>(widget_extent.width));
+
   // if there's leftover space, we might need to perform another layout step or
   // add the notion of text layout to the system?
-  paragraph_->paint(&sk_canvas, 0.0f, 0.0f);
+  paragraph.paragraph->paint(&sk_canvas, 0.0f, 0.0f);
 
   sk_canvas.restore();
 }
@@ -550,6 +915,19 @@ void Text::tick(std::chrono::nanoseconds interval,
   auto tmp = context.get("VLK_AssetLoader").unwrap();
   auto asset_loader = tmp.handle->as<AssetLoader>().unwrap();
 
+  if (font_collection_ == nullptr) {
+    font_collection_ = context.get("VLK_FontCollection")
+                           .unwrap()
+                           .handle->as<SharedFontCollection>()
+                           .unwrap();
+  }
+
+  if (shaping_.is_some()) {
+    shaping_.value().tick(interval);
+    // a canceled task is done without completing
+    if (shaping_.value().future_.is_done()) finish_shaping();
+  }
+
   for (auto& inline_text : inline_texts_) {
     inline_text.font_future.match(
         [interval](impl::FontFuture& future) { future.awaiter.tick(interval); },
@@ -600,11 +978,28 @@ void Text::tick(std::chrono::nanoseconds interval,
   }
 
   if (diff_ != impl::TextDiff::None) {
-    rebuild_paragraph();
+    if (paragraph_ != nullptr && shaping_.is_none() &&
+        (diff_ & ~impl::kPaintOnlyDiff) == impl::TextDiff::None) {
+      repaint_paragraph();
+    } else {
+      rebuild_paragraph();
+    }
     WidgetDirtiness dirtiness = impl::map_diff(diff_);
     Widget::add_dirtiness(dirtiness);
     diff_ = impl::TextDiff::None;
   }
+
+  bool const is_loading =
+      shaping_.is_some() ||
+      std::any_of(inline_texts_.begin(), inline_texts_.end(),
+                  [](impl::InlineTextStorage const& inline_text) {
+                    return inline_text.font_future.is_some() &&
+                           inline_text.font_future.value().awaiter.is_pending();
+                  });
+
+  if (!is_loading) {
+    Widget::unsubscribe_ticks();
+  }
 }
 
 }  // namespace ui
@@ -0,0 +1,362 @@
+#include "vlk/ui/widgets/text_document.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "include/core/SkCanvas.h"
+#include "modules/skparagraph/include/Paragraph.h"
+#include "modules/skparagraph/include/ParagraphBuilder.h"
+#include "modules/skparagraph/include/TextStyle.h"
+#include "vlk/subsystems/asset_loader.h"
+#include "vlk/utils.h"
+
+namespace sktext = skia::textlayout;
+
+namespace vlk {
+namespace ui {
+
+namespace impl {
+
+// the height of a line relative to the font size, used until a block of the
+// document is measured
+constexpr float kEstimatedLineHeight = 1.2f;
+
+}  // namespace impl
+
+TextDocument::TextDocument(std::string_view text,
+                           ParagraphProps paragraph_props)
+    : paragraph_storage_{std::move(paragraph_props), stx::None} {
+  // the document fills the width it is given and is as tall as its lines
+  Widget::update_self_extent(SelfExtent::relative(1.0f, 1.0f));
+  Widget::update_needs_trimming(true);
+  split_into_blocks(text);
+  update_block_offsets();
+  // the paragraph's font is loaded on tick
+  Widget::subscribe_ticks();
+}
+
+void TextDocument::update_text(std::string_view text) {
+  num_shaped_blocks_ = 0;
+  blocks_.clear();
+  split_into_blocks(text);
+  update_block_offsets();
+  Widget::mark_layout_dirty();
+  Widget::mark_render_dirty();
+}
+
+void TextDocument::append_text(std::string_view text) {
+  if (text.empty()) return;
+
+  // the text continues the last line, so the last block is split again along
+  // with the appended text. the preceding blocks are left untouched.
+  std::string tail;
+
+  if (!blocks_.empty()) {
+    impl::TextBlock& last = blocks_.back();
+    if (last.paragraph != nullptr) num_shaped_blocks_--;
+    tail = std::move(last.text);
+    blocks_.pop_back();
+  }
+
+  tail.append(text);
+  split_into_blocks(tail);
+  update_block_offsets();
+  Widget::mark_layout_dirty();
+  Widget::mark_render_dirty();
+}
+
+void TextDocument::update_paragraph_props(ParagraphProps paragraph_props) {
+  paragraph_storage_ =
+      impl::ParagraphStorage{std::move(paragraph_props), stx::None};
+  release_blocks();
+  // the estimates of the blocks measured with the previous style are stale
+  for (impl::TextBlock& block : blocks_) block.is_measured = false;
+  update_block_offsets();
+  Widget::mark_layout_dirty();
+  Widget::mark_render_dirty();
+  // the paragraph's font is loaded on tick
+  Widget::subscribe_ticks();
+}
+
+size_t TextDocument::get_num_lines() const {
+  size_t num_lines = 0;
+  for (impl::TextBlock const& block : blocks_) num_lines += block.num_lines;
+  return num_lines;
+}
+
+Extent TextDocument::trim(Extent extent) {
+  float const width = static_cast<float>(extent.width);
+
+  if (width_.is_none() || width_.value() != width) {
+    // only the shaped blocks are re-laid out at the new width, the heights of
+    // the others are estimated until they are drawn
+    for (impl::TextBlock& block : blocks_) {
+      if (block.paragraph != nullptr) {
+        block.height = layout_block(block, width);
+        block.is_measured = true;
+      } else {
+        block.is_measured = false;
+      }
+    }
+
+    width_ = stx::Some(float{width});
+    update_block_offsets();
+  }
+
+  return Extent{extent.width,
+                static_cast<uint32_t>(std::ceil(block_offsets_.back()))};
+}
+
+void TextDocument::draw(Canvas& canvas) {
+  if (blocks_.empty()) return;
+
+  num_draws_++;
+
+  SkCanvas& sk_canvas = canvas.to_skia();
+  Extent const widget_extent = canvas.extent();
+  float const width = static_cast<float>(widget_extent.width);
+  VRect const draw_area = canvas.draw_area();
+  float const area_top = draw_area.offset.y;
+  float const area_bottom = draw_area.offset.y + draw_area.extent.height;
+
+  sk_canvas.save();
+  sk_canvas.clipRect(SkRect::MakeWH(widget_extent.width, widget_extent.height));
+
+  // the first block ending below the top of the area
+  size_t const first =
+      std::upper_bound(block_offsets_.begin() + 1, block_offsets_.end(),
+                       area_top) -
+      (block_offsets_.begin() + 1);
+
+  // the blocks are painted at their present offsets even if their measured
+  // heights differ from the estimates, so the frame stays consistent. the
+  // document is reflowed on the next tick.
+  for (size_t i = first; i < blocks_.size() && block_offsets_[i] < area_bottom;
+       i++) {
+    impl::TextBlock& block = blocks_[i];
+
+    if (block.paragraph == nullptr) shape_block(block);
+
+    float const height = layout_block(block, width);
+
+    if (!block.is_measured || block.height != height) {
+      block.height = height;
+      block.is_measured = true;
+      needs_reflow_ = true;
+    }
+
+    block.last_drawn = num_draws_;
+    block.paragraph->paint(&sk_canvas, 0.0f, block_offsets_[i]);
+  }
+
+  sk_canvas.restore();
+
+  if (needs_reflow_) Widget::subscribe_ticks();
+}
+
+void TextDocument::tick(std::chrono::nanoseconds interval,
+                        SubsystemsContext const& context) {
+  if (font_collection_ == nullptr) {
+    font_collection_ = context.get("VLK_FontCollection")
+                           .unwrap()
+                           .handle->as<SharedFontCollection>()
+                           .unwrap();
+    // the blocks shaped before binding used the unbound collection
+    release_blocks();
+  }
+
+  auto tmp = context.get("VLK_AssetLoader").unwrap();
+  auto asset_loader = tmp.handle->as<AssetLoader>().unwrap();
+
+  paragraph_storage_.font_future.match(
+      [interval](impl::FontFuture& future) { future.awaiter.tick(interval); },
+      []() {});
+
+  if (paragraph_storage_.font_future.is_none()) {
+    FontSource const source = paragraph_storage_.props.font();
+
+    auto on_loaded =
+        stx::fn::rc::make_functor(stx::os_allocator, [this]() {
+          paragraph_storage_.font_future.value().awaiter.future_.ref().match(
+              [&](stx::Result<FontAsset, FontLoadError>* result) {
+                result->match(
+                    [&](FontAsset const& asset) {
+                      get_font_collection().register_typeface(
+                          impl::get_source_tag(paragraph_storage_.props.font()),
+                          asset.get_raw());
+                    },
+                    [](FontLoadError) {});
+              },
+              [](stx::FutureError) {});
+
+          // the blocks were shaped with a fallback font
+          release_blocks();
+          for (impl::TextBlock& block : blocks_) block.is_measured = false;
+          update_block_offsets();
+          Widget::mark_layout_dirty();
+          Widget::mark_render_dirty();
+        }).unwrap();
+
+    if (std::holds_alternative<SystemFont>(source)) {
+      paragraph_storage_.font_future = stx::Some(impl::FontFuture{
+          source,
+          FutureAwaiter{asset_loader->load_font(std::get<SystemFont>(source)),
+                        std::move(on_loaded)}});
+    } else if (std::holds_alternative<FileTypefaceSource>(source)) {
+      paragraph_storage_.font_future = stx::Some(impl::FontFuture{
+          source,
+          FutureAwaiter{
+              asset_loader->load_font(std::get<FileTypefaceSource>(source)),
+              std::move(on_loaded)}});
+    } else if (std::holds_alternative<MemoryTypefaceSource>(source)) {
+      paragraph_storage_.font_future = stx::Some(impl::FontFuture{
+          source,
+          FutureAwaiter{
+              asset_loader->load_font(std::get<MemoryTypefaceSource>(source)),
+              std::move(on_loaded)}});
+    } else {
+      VLK_PANIC("UNSUPPORTED");
+    }
+  }
+
+  if (needs_reflow_) {
+    update_block_offsets();
+    needs_reflow_ = false;
+    Widget::mark_layout_dirty();
+    Widget::mark_render_dirty();
+  }
+
+  bool const is_loading = paragraph_storage_.font_future.is_some() &&
+                          paragraph_storage_.font_future.value()
+                              .awaiter.is_pending();
+
+  if (!is_loading) Widget::unsubscribe_ticks();
+}
+
+void TextDocument::split_into_blocks(std::string_view text) {
+  float const line_height = estimate_line_height();
+
+  while (true) {
+    // the end of the block's `kLinesPerBlock`th line
+    size_t end = 0;
+    size_t num_lines = 1;
+
+    while ((end = text.find('\n', end)) != std::string_view::npos &&
+           num_lines < kLinesPerBlock) {
+      end++;
+      num_lines++;
+    }
+
+    impl::TextBlock block;
+    block.text = std::string{text.substr(0, end)};
+    block.num_lines = num_lines;
+    block.height = num_lines * line_height;
+    blocks_.push_back(std::move(block));
+
+    if (end == std::string_view::npos) break;
+
+    // the line break separating the blocks isn't part of either
+    text = text.substr(end + 1);
+  }
+}
+
+void TextDocument::release_blocks() {
+  for (impl::TextBlock& block : blocks_) {
+    block.paragraph = nullptr;
+    block.laid_out_width = stx::None;
+  }
+
+  num_shaped_blocks_ = 0;
+}
+
+void TextDocument::shape_block(impl::TextBlock& block) {
+  // release the least recently drawn block, if it isn't being drawn
+  if (num_shaped_blocks_ >= kMaxShapedBlocks) {
+    impl::TextBlock* oldest = nullptr;
+
+    for (impl::TextBlock& candidate : blocks_) {
+      if (candidate.paragraph != nullptr &&
+          (oldest == nullptr || candidate.last_drawn < oldest->last_drawn)) {
+        oldest = &candidate;
+      }
+    }
+
+    // its measured height is retained, so the layout doesn't change
+    if (oldest != nullptr && oldest->last_drawn < num_draws_) {
+      oldest->paragraph = nullptr;
+      oldest->laid_out_width = stx::None;
+      num_shaped_blocks_--;
+    }
+  }
+
+  SharedFontCollection& font_collection = get_font_collection();
+  ShapingContext& shaping_context = *font_collection.get_shaping_context();
+
+  sktext::TextStyle const text_style =
+      impl::make_text_style(impl::InlineTextStorage{}, paragraph_storage_);
+
+  std::lock_guard lock{shaping_context.mutex};
+
+  std::unique_ptr<sktext::ParagraphBuilder> builder =
+      shaping_context.make_paragraph_builder(
+          impl::make_paragraph_style(paragraph_storage_.props));
+
+  builder->pushStyle(text_style);
+  builder->addText(block.text.data(), block.text.size());
+  builder->pop();
+
+  block.paragraph = builder->Build();
+  block.laid_out_width = stx::None;
+  num_shaped_blocks_++;
+}
+
+float TextDocument::layout_block(impl::TextBlock& block, float width) {
+  if (block.laid_out_width.is_none() || block.laid_out_width.value() != width) {
+    std::lock_guard lock{get_font_collection().get_shaping_context()->mutex};
+    block.paragraph->layout(width);
+    block.laid_out_width = stx::Some(float{width});
+  }
+
+  return block.paragraph->getHeight();
+}
+
+float TextDocument::estimate_line_height() const {
+  float measured_height = 0.0f;
+  size_t num_measured_lines = 0;
+
+  for (impl::TextBlock const& block : blocks_) {
+    if (block.is_measured) {
+      measured_height += block.height;
+      num_measured_lines += block.num_lines;
+    }
+  }
+
+  if (num_measured_lines == 0) {
+    return paragraph_storage_.props.font_size() * impl::kEstimatedLineHeight;
+  }
+
+  return measured_height / num_measured_lines;
+}
+
+void TextDocument::update_block_offsets() {
+  float const line_height = estimate_line_height();
+
+  block_offsets_.resize(blocks_.size() + 1);
+  block_offsets_[0] = 0.0f;
+
+  for (size_t i = 0; i < blocks_.size(); i++) {
+    impl::TextBlock& block = blocks_[i];
+    if (!block.is_measured) block.height = block.num_lines * line_height;
+    block_offsets_[i + 1] = block_offsets_[i] + block.height;
+  }
+}
+
+}  // namespace ui
+}  // namespace vlk
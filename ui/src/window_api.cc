@@ -20,5 +20,11 @@ WindowApi WindowApi::init() {
 
 bool WindowApi::poll_events() const { return handle->poll_events(); }
 
+bool WindowApi::wait_events(std::chrono::milliseconds timeout) const {
+  return handle->wait_events(timeout);
+}
+
+void WindowApi::wake() { WindowApiHandle::wake(); }
+
 }  // namespace ui
 }  // namespace vlk
@@ -0,0 +1,212 @@
+#include "vlk/ui/animation.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mock_widgets.h"
+#include "vlk/ui/pipeline.h"
+
+namespace animation_test {
+
+struct AnimatedBar : public Widget {
+  AnimatedBar() : Widget{WidgetType::Render} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent::absolute(100, 10));
+  }
+
+  ~AnimatedBar() override {}
+
+  AnimationTarget progress_target() {
+    return AnimationTarget{this, &progress, WidgetDirtiness::Render};
+  }
+
+  float progress = 0.0f;
+};
+
+constexpr std::chrono::nanoseconds kFrame = std::chrono::milliseconds(10);
+
+}  // namespace animation_test
+
+TEST(AnimationTest, Curves) {
+  for (size_t i = 0; i < kNumCurves; i++) {
+    Curve const curve = static_cast<Curve>(i);
+
+    EXPECT_FLOAT_EQ(ease(curve, 0.0f), 0.0f);
+
+    if (curve != Curve::EaseOutSnap && curve != Curve::Zero) {
+      EXPECT_FLOAT_EQ(ease(curve, 1.0f), 1.0f);
+    }
+
+    // the curves are non-decreasing
+    for (float t = 0.0f; t < 1.0f; t += 0.01f) {
+      EXPECT_LE(ease(curve, t), ease(curve, t + 0.01f) + 1e-6f);
+    }
+  }
+
+  EXPECT_FLOAT_EQ(ease(Curve::EaseInOut, 0.5f), 0.5f);
+  EXPECT_FLOAT_EQ(ease(Curve::SmoothInOut, 0.5f), 0.5f);
+  EXPECT_FLOAT_EQ(tween(Curve::EaseIn, 10.0f, 20.0f, 0.5f), 12.5f);
+}
+
+TEST(AnimationTest, Engine) {
+  using namespace animation_test;
+
+  std::vector<std::unique_ptr<AnimatedBar>> bars;
+  WidgetDirtyQueues dirty_queues;
+
+  for (size_t i = 0; i < 100; i++) {
+    bars.emplace_back(new AnimatedBar{});
+    // as if processed on a previous frame
+    WidgetSystemProxy::flush_dirtiness(*bars.back());
+    WidgetSystemProxy::bind_dirty_queues(*bars.back(), &dirty_queues);
+  }
+
+  AnimationEngine engine;
+
+  std::vector<AnimationId> ids;
+
+  // every other bar animates, over 100ms
+  for (size_t i = 0; i < bars.size(); i += 2) {
+    ids.push_back(engine.animate(bars[i]->progress_target(), 0.0f, 100.0f,
+                                 10 * kFrame,
+                                 i % 4 == 0 ? Curve::Linear : Curve::EaseIn));
+  }
+
+  EXPECT_EQ(engine.size(), 50);
+
+  for (size_t i = 0; i < 5; i++) {
+    engine.evaluate(kFrame);
+  }
+
+  EXPECT_NEAR(bars[0]->progress, 50.0f, 1e-3f);
+  EXPECT_NEAR(bars[2]->progress, 25.0f, 1e-3f);
+  EXPECT_FLOAT_EQ(bars[1]->progress, 0.0f);
+
+  // only the animated widgets are marked dirty
+  EXPECT_EQ(dirty_queues.active_widgets.size(), 50);
+
+  for (size_t i = 0; i < bars.size(); i++) {
+    EXPECT_EQ(bars[i]->get_dirtiness(), i % 2 == 0 ? WidgetDirtiness::Render
+                                                   : WidgetDirtiness::None);
+  }
+
+  // cancelling leaves the value as is
+  engine.cancel(ids[0]);
+  engine.cancel(*bars[2]);
+
+  EXPECT_FALSE(engine.is_active(ids[0]));
+  EXPECT_FALSE(engine.is_active(ids[1]));
+  EXPECT_TRUE(engine.is_active(ids[2]));
+  EXPECT_EQ(engine.size(), 48);
+
+  // the animations complete at their end value, and are then removed
+  for (size_t i = 0; i < 6; i++) {
+    engine.evaluate(kFrame);
+  }
+
+  EXPECT_EQ(engine.size(), 0);
+  EXPECT_NEAR(bars[0]->progress, 50.0f, 1e-3f);
+  EXPECT_NEAR(bars[2]->progress, 25.0f, 1e-3f);
+  EXPECT_FLOAT_EQ(bars[4]->progress, 100.0f);
+  EXPECT_FLOAT_EQ(bars[6]->progress, 100.0f);
+  EXPECT_FALSE(engine.is_active(ids[2]));
+
+  // the slots are re-used, but not the ids
+  AnimationId const id =
+      engine.animate_to(bars[1]->progress_target(), 10.0f, kFrame);
+  EXPECT_NE(id, ids.back());
+  EXPECT_FALSE(engine.is_active(ids.back()));
+  EXPECT_TRUE(engine.is_active(id));
+
+  engine.evaluate(kFrame);
+  EXPECT_FLOAT_EQ(bars[1]->progress, 10.0f);
+
+  for (auto& bar : bars) {
+    WidgetSystemProxy::bind_dirty_queues(*bar, nullptr);
+  }
+}
+
+TEST(AnimationTest, Pipeline) {
+  using namespace animation_test;
+
+  MockSized sized{Extent{100, 100}};
+  MockView layer{&sized};
+  layer.init_is_layer(true);
+  MockView root{&layer};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  AnimationEngine& engine = *pipeline.context.get("VLK_Animations")
+                                 .unwrap()
+                                 .handle->as<AnimationEngine>()
+                                 .unwrap();
+  EXPECT_EQ(&engine, pipeline.animations);
+
+  engine.animate(AnimationTarget::layer_opacity(layer), 1.0f, 0.0f,
+                 10 * kFrame);
+  engine.animate(AnimationTarget::layer_translate_x(layer), 0.0f, 200.0f,
+                 10 * kFrame, Curve::EaseOut);
+
+  for (size_t i = 0; i < 5; i++) {
+    pipeline.tick(kFrame);
+  }
+
+  EXPECT_NEAR(layer.get_layer_effects().opacity, 0.5f, 1e-5f);
+  EXPECT_NEAR(layer.get_layer_effects().transform.translate_x, 150.0f,
+              1e-3f);
+
+  // the layer effects are only composited, the layer isn't dirtied
+  EXPECT_EQ(layer.get_dirtiness(), WidgetDirtiness::None);
+
+  for (size_t i = 0; i < 6; i++) {
+    pipeline.tick(kFrame);
+  }
+
+  EXPECT_FLOAT_EQ(layer.get_layer_effects().opacity, 0.0f);
+  EXPECT_EQ(pipeline.animations->size(), 0);
+}
+
+TEST(AnimationTest, Benchmark) {
+  using namespace animation_test;
+
+  constexpr size_t kNumAnimations = 100'000;
+  constexpr size_t kNumFrames = 100;
+
+  std::vector<std::unique_ptr<AnimatedBar>> bars;
+  bars.reserve(kNumAnimations);
+
+  AnimationEngine engine;
+
+  for (size_t i = 0; i < kNumAnimations; i++) {
+    bars.emplace_back(new AnimatedBar{});
+    engine.animate(bars.back()->progress_target(), 0.0f, 1.0f,
+                   (kNumFrames + 1) * kFrame,
+                   static_cast<Curve>(i % kNumCurves));
+  }
+
+  size_t num_changed = 0;
+
+  auto const begin = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < kNumFrames; i++) {
+    num_changed += engine.evaluate(kFrame);
+  }
+
+  auto const duration = std::chrono::steady_clock::now() - begin;
+
+  EXPECT_EQ(engine.size(), kNumAnimations);
+  EXPECT_GT(num_changed, 0);
+
+  std::cout << "\nevaluated " << kNumAnimations << " animations over "
+            << kNumFrames << " frames in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                   .count()
+            << "us, " << num_changed << " values changed\n";
+}
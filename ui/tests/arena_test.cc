@@ -0,0 +1,255 @@
+#include "vlk/ui/arena.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mock_widgets.h"
+#include "vlk/ui/heap_stats.h"
+#include "vlk/ui/hit_test.h"
+#include "vlk/ui/layout_tree.h"
+#include "vlk/ui/pipeline.h"
+#include "vlk/ui/view_tree.h"
+
+namespace arena_test {
+
+struct CountingDestructor {
+  CountingDestructor(std::vector<int>& init_destroyed, int init_id)
+      : destroyed{&init_destroyed}, id{init_id} {}
+
+  ~CountingDestructor() { destroyed->push_back(id); }
+
+  std::vector<int>* destroyed;
+  int id;
+};
+
+using ArenaWidgets = std::vector<Widget*, ArenaStdAllocator<Widget*>>;
+
+// a vertically scrolling column whose child list is allocated on the arena
+struct ArenaScrollView : public Widget {
+  ArenaScrollView(ArenaWidgets init_children, Extent extent,
+                  bool is_layer = false)
+      : Widget{WidgetType::View}, children_{std::move(init_children)} {
+    Widget::init_is_flex(true);
+    Widget::init_is_layer(is_layer);
+    Widget::update_children(stx::Span<Widget* const>{children_.data(),
+                                                     children_.size()});
+    Widget::update_flex(Flex{Direction::Column, Wrap::None, MainAlign::Start,
+                             CrossAlign::Start, Fit::Shrink, Fit::Expand});
+    Widget::update_self_extent(SelfExtent{Constrain::absolute(extent.width),
+                                          Constrain::absolute(extent.height)});
+    Widget::update_view_extent(ViewExtent{
+        Constrain::relative(1.0f), Constrain::unbounded(stx::u32_max)});
+  }
+
+  ~ArenaScrollView() override {}
+
+  ArenaWidgets children_;
+};
+
+bool is_aligned(void* memory) {
+  return reinterpret_cast<uintptr_t>(memory) %
+             ArenaAllocatorHandle::kAlignment ==
+         0;
+}
+
+}  // namespace arena_test
+
+TEST(ArenaTest, Allocations) {
+  using namespace arena_test;
+
+  ArenaAllocatorHandle handle{1024};
+
+  auto const allocate_all = [&handle]() {
+    void* a = handle.allocate(10).unwrap();
+    EXPECT_TRUE(is_aligned(a));
+    std::memset(a, 0xAB, 10);
+
+    // the most recent allocation is extended in-place
+    void* b = handle.reallocate(a, 100).unwrap();
+    EXPECT_EQ(a, b);
+
+    void* c = handle.allocate(16).unwrap();
+    EXPECT_TRUE(is_aligned(c));
+    EXPECT_NE(a, c);
+
+    // the other allocations are copied
+    void* d = handle.reallocate(a, 200).unwrap();
+    EXPECT_NE(a, d);
+    EXPECT_EQ(static_cast<unsigned char*>(d)[9], 0xAB);
+
+    // releasing the most recent allocation makes its memory available again
+    handle.deallocate(d);
+    EXPECT_EQ(handle.allocate(8).unwrap(), d);
+
+    // larger than a chunk
+    void* e = handle.allocate(4096).unwrap();
+    EXPECT_TRUE(is_aligned(e));
+  };
+
+  allocate_all();
+
+  EXPECT_EQ(handle.get_num_chunks(), 2);
+  EXPECT_EQ(handle.get_num_allocations(), 5);
+
+  size_t const bytes_reserved = handle.get_bytes_reserved();
+
+  handle.reset();
+
+  EXPECT_EQ(handle.get_bytes_used(), 0);
+
+  // the chunks are re-used after a reset
+  HeapStats const start = get_heap_stats();
+
+  for (size_t i = 0; i < 4; i++) {
+    allocate_all();
+    handle.reset();
+  }
+
+  EXPECT_EQ(get_heap_stats().since(start).num_allocations, 0);
+  EXPECT_EQ(handle.get_num_chunks(), 2);
+  EXPECT_EQ(handle.get_bytes_reserved(), bytes_reserved);
+}
+
+TEST(ArenaTest, Objects) {
+  using namespace arena_test;
+
+  std::vector<int> destroyed;
+
+  {
+    Arena arena;
+
+    arena.make<CountingDestructor>(destroyed, 0);
+    arena.make<CountingDestructor>(destroyed, 1);
+    int* value = arena.make<int>(5);
+    arena.make<CountingDestructor>(destroyed, 2);
+
+    EXPECT_EQ(*value, 5);
+    EXPECT_TRUE(destroyed.empty());
+
+    // destroyed in reverse order of construction
+    arena.reset();
+
+    EXPECT_EQ(destroyed, (std::vector<int>{2, 1, 0}));
+    EXPECT_EQ(arena.get_handle().get_bytes_used(), 0);
+
+    arena.make<CountingDestructor>(destroyed, 3);
+  }
+
+  EXPECT_EQ(destroyed, (std::vector<int>{2, 1, 0, 3}));
+}
+
+// the trees and the hit-test index, ticked by hand
+TEST(ArenaTest, SteadyStateTreeTicks) {
+  using namespace arena_test;
+
+  Arena arena;
+
+  // the screen's widgets and their child lists are all on the arena
+  ArenaWidgets children{ArenaStdAllocator<Widget*>{arena}};
+
+  for (size_t i = 0; i < 100; i++) {
+    children.push_back(arena.make<MockSized>(Extent{100, 40}));
+  }
+
+  ArenaScrollView* scroll_view =
+      arena.make<ArenaScrollView>(std::move(children), Extent{100, 400});
+  MockView* root = arena.make<MockView>(scroll_view);
+
+  LayoutTree layout_tree;
+  ViewTree view_tree;
+  HitTestIndex index;
+  WidgetDirtyQueues dirty_queues;
+
+  layout_tree.allot_extent(Extent{1920, 1080});
+  layout_tree.build(*root);
+  layout_tree.tick(std::chrono::nanoseconds(0));
+  view_tree.build(layout_tree.root_node);
+  view_tree.tick(std::chrono::nanoseconds(0));
+  index.build(view_tree);
+
+  WidgetSystemProxy::bind_dirty_queues(*scroll_view, &dirty_queues);
+
+  auto const scroll_frames = [&]() {
+    for (uint32_t offset = 0; offset <= 400; offset += 40) {
+      scroll_view->update_view_offset(ViewOffset::scroll(0, offset));
+      WidgetSystemProxy::flush_dirtiness(*scroll_view);
+      view_tree.mark_views_dirty(dirty_queues.view_offset_dirty);
+      dirty_queues.clear();
+      view_tree.tick(std::chrono::nanoseconds(0));
+      index.update();
+    }
+  };
+
+  // the containers grow to their steady-state capacity
+  scroll_frames();
+  scroll_frames();
+
+  HeapStats const start = get_heap_stats();
+
+  for (size_t i = 0; i < 4; i++) {
+    scroll_frames();
+  }
+
+  EXPECT_EQ(get_heap_stats().since(start).num_allocations, 0);
+
+  // scrolled by 400, the first visible item is the 11th
+  ViewTree::Entry const* hit = index.hit_test(IOffset{10, 10});
+  ASSERT_NE(hit, nullptr);
+  EXPECT_EQ(hit->layout_node->widget, scroll_view->children_[10]);
+
+  WidgetSystemProxy::bind_dirty_queues(*scroll_view, nullptr);
+}
+
+// the pipeline's UI stage: the trees, the hit-test index, the tile cache's
+// recording and snapshot, and the subsystems. the scroll layer is scrolled
+// within the focus margin of its tiles, so no tile is re-recorded (recording
+// allocates skia pictures).
+TEST(ArenaTest, PipelineSteadyStateFrames) {
+  using namespace arena_test;
+
+  Arena arena;
+
+  ArenaWidgets children{ArenaStdAllocator<Widget*>{arena}};
+
+  for (size_t i = 0; i < 100; i++) {
+    children.push_back(arena.make<MockSized>(Extent{100, 40}));
+  }
+
+  ArenaScrollView* scroll_view = arena.make<ArenaScrollView>(
+      std::move(children), Extent{100, 400}, true);
+  MockView* root = arena.make<MockView>(scroll_view);
+
+  RenderContext context;
+  Pipeline pipeline{*root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  auto const scroll_frames = [&]() {
+    for (uint32_t offset = 0; offset <= 160; offset += 8) {
+      scroll_view->update_view_offset(ViewOffset::scroll(0, offset));
+      pipeline.record(std::chrono::milliseconds(16));
+    }
+  };
+
+  // the initial build and recording, and the containers growing to their
+  // steady-state capacity
+  pipeline.record(std::chrono::nanoseconds(0));
+  scroll_frames();
+  scroll_frames();
+
+  HeapStats const start = get_heap_stats();
+
+  for (size_t i = 0; i < 4; i++) {
+    scroll_frames();
+  }
+
+  // idle frames
+  for (size_t i = 0; i < 16; i++) {
+    pipeline.record(std::chrono::milliseconds(16));
+  }
+
+  EXPECT_EQ(get_heap_stats().since(start).num_allocations, 0);
+}
@@ -0,0 +1,317 @@
+#include "vlk/ui/hit_test.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mock_widgets.h"
+#include "vlk/ui/layout_tree.h"
+#include "vlk/ui/view_tree.h"
+
+namespace hit_test {
+
+struct MockHitSized : public Widget {
+  MockHitSized(Extent extent, bool consumes,
+               stx::Option<ZIndex> const& z_index = stx::None)
+      : Widget{WidgetType::Render}, consumes_{consumes} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent{Constrain::absolute(extent.width),
+                                          Constrain::absolute(extent.height)});
+    Widget::init_z_index(z_index.copy());
+  }
+
+  ~MockHitSized() override {}
+
+  virtual bool on_mouse_motion(MouseMotionEvent const& event) override {
+    num_hits++;
+    last_offset = event.offset;
+    return consumes_;
+  }
+
+  bool consumes_ = true;
+  size_t num_hits = 0;
+  IOffset last_offset{};
+};
+
+struct MockWrap : public Widget {
+  MockWrap(std::vector<Widget*> children,
+           stx::Option<ZIndex> const& z_index = stx::None)
+      : Widget{WidgetType::Render}, children_{std::move(children)} {
+    Widget::init_is_flex(true);
+    Widget::update_children(children_);
+    Widget::update_flex(Flex{Direction::Row, Wrap::Wrap, MainAlign::Start,
+                             CrossAlign::Start, Fit::Expand, Fit::Expand});
+    Widget::init_z_index(z_index.copy());
+    Widget::update_self_extent(SelfExtent{Constrain{1.0f}, Constrain{1.0f}});
+  }
+
+  ~MockWrap() override {}
+
+  std::vector<Widget*> children_;
+};
+
+// a vertically scrolling column
+struct MockScrollView : public Widget {
+  MockScrollView(std::vector<Widget*> children, Extent extent)
+      : Widget{WidgetType::View}, children_{std::move(children)} {
+    Widget::init_is_flex(true);
+    Widget::update_children(children_);
+    Widget::update_flex(Flex{Direction::Column, Wrap::None, MainAlign::Start,
+                             CrossAlign::Start, Fit::Shrink, Fit::Expand});
+    Widget::update_self_extent(SelfExtent{Constrain::absolute(extent.width),
+                                          Constrain::absolute(extent.height)});
+    Widget::update_view_extent(ViewExtent{
+        Constrain::relative(1.0f), Constrain::unbounded(stx::u32_max)});
+  }
+
+  ~MockScrollView() override {}
+
+  std::vector<Widget*> children_;
+};
+
+struct Trees {
+  LayoutTree layout_tree;
+  ViewTree view_tree;
+  HitTestIndex index;
+
+  void build(Widget& root, Extent allotted_extent) {
+    layout_tree.allot_extent(allotted_extent);
+    layout_tree.build(root);
+    layout_tree.tick(std::chrono::nanoseconds(0));
+    view_tree.build(layout_tree.root_node);
+    view_tree.tick(std::chrono::nanoseconds(0));
+    index.build(view_tree);
+  }
+
+  void tick(Widget& scrolled) {
+    SubsystemsContext context;
+    WidgetDirtyQueues dirty_queues;
+    WidgetSystemProxy::bind_dirty_queues(scrolled, &dirty_queues);
+    WidgetSystemProxy::tick(scrolled, std::chrono::nanoseconds(0), context);
+    WidgetSystemProxy::bind_dirty_queues(scrolled, nullptr);
+    view_tree.mark_views_dirty(dirty_queues.view_offset_dirty);
+    view_tree.tick(std::chrono::nanoseconds(0));
+    index.update();
+  }
+
+  Widget* hit_test(IOffset point) const {
+    ViewTree::Entry const* entry = index.hit_test(point);
+    return entry == nullptr ? nullptr : entry->layout_node->widget;
+  }
+};
+
+// the topmost entry containing the point, by visiting all of the entries
+Widget* hit_test_linear(Trees const& trees, IOffset point) {
+  ViewTree::Entry const* hit = nullptr;
+  size_t hit_rank = 0;
+
+  for (size_t i = 0; i < trees.view_tree.entries.size(); i++) {
+    ViewTree::Entry const& entry = trees.view_tree.entries[i];
+    IRect const& rect = entry.clip_rect;
+
+    if (rect.visible() && point.x >= rect.offset.x &&
+        point.y >= rect.offset.y &&
+        point.x < rect.offset.x + static_cast<int64_t>(rect.extent.width) &&
+        point.y < rect.offset.y + static_cast<int64_t>(rect.extent.height) &&
+        (hit == nullptr || trees.index.paint_ranks[i] > hit_rank)) {
+      hit = &entry;
+      hit_rank = trees.index.paint_ranks[i];
+    }
+  }
+
+  return hit == nullptr ? nullptr : hit->layout_node->widget;
+}
+
+}  // namespace hit_test
+
+TEST(HitTestTest, ZOrder) {
+  using namespace hit_test;
+
+  MockHitSized a{Extent{100, 100}, false};
+  MockWrap froot{{&a}};
+  MockView vroot{&froot};
+
+  Trees trees;
+  trees.build(vroot, Extent{1920, 1080});
+
+  // the flex container spans the whole root, its child is painted above it
+  EXPECT_EQ(trees.hit_test(IOffset{10, 10}), &a);
+  EXPECT_EQ(trees.hit_test(IOffset{150, 10}), &froot);
+  EXPECT_EQ(trees.hit_test(IOffset{1920, 10}), nullptr);
+
+  // `a` doesn't consume the event, so it falls through to the container
+  MouseMotionEvent event{};
+  event.offset = IOffset{10, 20};
+
+  size_t num_visited = 0;
+  bool const consumed =
+      trees.index.hit_test(event.offset, [&](ViewTree::Entry const& entry) {
+        num_visited++;
+        return entry.layout_node->widget->on_mouse_motion(event);
+      });
+
+  EXPECT_FALSE(consumed);
+  EXPECT_EQ(a.num_hits, 1);
+  EXPECT_EQ(num_visited, 2);
+
+  for (IOffset point : {IOffset{0, 0}, IOffset{99, 99}, IOffset{100, 0},
+                        IOffset{1919, 1079}, IOffset{1920, 1080}}) {
+    EXPECT_EQ(trees.hit_test(point), hit_test_linear(trees, point));
+  }
+
+  // a higher z-index paints the container above its child
+  MockHitSized b{Extent{100, 100}, true};
+  MockWrap fb{{&b}, stx::Some<ZIndex>(10)};
+  MockView vb{&fb};
+
+  Trees z_trees;
+  z_trees.build(vb, Extent{1920, 1080});
+
+  EXPECT_EQ(z_trees.hit_test(IOffset{10, 10}), &fb);
+  EXPECT_EQ(z_trees.hit_test(IOffset{10, 10}),
+            hit_test_linear(z_trees, IOffset{10, 10}));
+}
+
+TEST(HitTestTest, ClipAndScroll) {
+  using namespace hit_test;
+
+  std::vector<std::unique_ptr<MockHitSized>> items;
+  std::vector<Widget*> children;
+
+  for (size_t i = 0; i < 10; i++) {
+    items.emplace_back(new MockHitSized{Extent{100, 40}, true});
+    children.push_back(items.back().get());
+  }
+
+  MockScrollView scroll_view{children, Extent{100, 100}};
+  MockView vroot{&scroll_view};
+
+  Trees trees;
+  trees.build(vroot, Extent{1920, 1080});
+
+  EXPECT_EQ(trees.hit_test(IOffset{10, 10}), items[0].get());
+  EXPECT_EQ(trees.hit_test(IOffset{10, 90}), items[2].get());
+
+  // clipped by the scroll view
+  EXPECT_EQ(trees.hit_test(IOffset{10, 130}), nullptr);
+
+  scroll_view.update_view_offset(ViewOffset::scroll(0, 60));
+  trees.tick(scroll_view);
+
+  // the items are moved to their new cells, all of them moved so they are
+  // re-bucketed without re-computing their paint order
+  EXPECT_EQ(trees.index.bounds, trees.view_tree.root_view().clip_rect);
+  EXPECT_EQ(trees.index.num_paint_order_sorts, 1);
+  EXPECT_EQ(trees.hit_test(IOffset{10, 10}), items[1].get());
+  EXPECT_EQ(trees.hit_test(IOffset{10, 90}), items[3].get());
+  EXPECT_EQ(trees.hit_test(IOffset{10, 130}), nullptr);
+
+  for (int64_t y = 0; y < 120; y += 7) {
+    EXPECT_EQ(trees.hit_test(IOffset{50, y}),
+              hit_test_linear(trees, IOffset{50, y}));
+  }
+
+  MouseMotionEvent event{};
+  event.offset = IOffset{10, 30};
+
+  trees.index.hit_test(event.offset, [&](ViewTree::Entry const& entry) {
+    MouseMotionEvent widget_event = event;
+    widget_event.offset = event.offset - entry.screen_offset;
+    return entry.layout_node->widget->on_mouse_motion(widget_event);
+  });
+
+  // item 1 is at [40, 80) on the content, scrolled by 60
+  EXPECT_EQ(items[1]->num_hits, 1);
+  EXPECT_EQ(items[1]->last_offset, (IOffset{10, 10}));
+}
+
+TEST(HitTestTest, Benchmark) {
+  using namespace hit_test;
+
+  constexpr size_t kNumWidgets = 100'000;
+  constexpr size_t kNumEvents = 100'000;
+
+  std::vector<std::unique_ptr<MockHitSized>> items;
+  std::vector<Widget*> children;
+
+  items.reserve(kNumWidgets);
+  children.reserve(kNumWidgets);
+
+  for (size_t i = 0; i < kNumWidgets; i++) {
+    items.emplace_back(new MockHitSized{Extent{8, 8}, true});
+    children.push_back(items.back().get());
+  }
+
+  MockWrap wrap{children};
+  MockView vroot{&wrap};
+
+  Trees trees;
+
+  auto const build_begin = std::chrono::steady_clock::now();
+  trees.build(vroot, Extent{1920, 4000});
+  auto const build_duration = std::chrono::steady_clock::now() - build_begin;
+
+  ASSERT_EQ(trees.view_tree.entries.size(), kNumWidgets + 1);
+
+  // high-frequency mouse motion, as a pointer sweeping across the screen
+  std::vector<IOffset> points;
+  points.reserve(kNumEvents);
+
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  IOffset point{960, 1600};
+
+  for (size_t i = 0; i < kNumEvents; i++) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    point.x = std::clamp<int64_t>(
+        point.x + static_cast<int64_t>((state >> 33) % 9) - 4, 0, 1919);
+    point.y = std::clamp<int64_t>(
+        point.y + static_cast<int64_t>((state >> 45) % 9) - 4, 0, 3999);
+    points.push_back(point);
+  }
+
+  size_t num_hits = 0;
+
+  auto const begin = std::chrono::steady_clock::now();
+
+  for (IOffset const& p : points) {
+    MouseMotionEvent event{};
+    event.offset = p;
+    num_hits += trees.index.hit_test(p, [&](ViewTree::Entry const& entry) {
+      return entry.layout_node->widget->on_mouse_motion(event);
+    });
+  }
+
+  auto const duration = std::chrono::steady_clock::now() - begin;
+
+  // the linear scan is too slow to run for all the events
+  constexpr size_t kNumLinearEvents = 1'000;
+
+  auto const linear_begin = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < kNumLinearEvents; i++) {
+    EXPECT_EQ(trees.hit_test(points[i]), hit_test_linear(trees, points[i]));
+  }
+
+  auto const linear_duration = std::chrono::steady_clock::now() - linear_begin;
+
+  // the events beyond the widgets only hit the (non-consuming) container
+  EXPECT_GT(num_hits, 0);
+
+  std::cout << "\nindexed " << kNumWidgets << " widgets in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   build_duration)
+                   .count()
+            << "ms (including layout)\n"
+            << kNumEvents << " motion events hit-tested in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                   .count()
+            << "us, " << num_hits << " consumed\n"
+            << kNumLinearEvents << " motion events hit-tested (and verified) "
+            << "with a linear scan in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(
+                   linear_duration)
+                   .count()
+            << "us\n";
+}
@@ -0,0 +1,257 @@
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "mock_widgets.h"
+#include "vlk/ui/pipeline.h"
+#include "vlk/ui/widgets/grid.h"
+#include "vlk/ui/widgets/list.h"
+#include "vlk/ui/window_api_handle.h"
+
+namespace idle_test {
+
+constexpr std::chrono::nanoseconds kFrame = std::chrono::milliseconds(16);
+constexpr std::chrono::milliseconds kIdleWaitTimeout{250};
+
+struct Measurement {
+  std::chrono::nanoseconds wall_time{0};
+  std::chrono::nanoseconds cpu_time{0};
+  size_t num_frames = 0;
+  size_t num_events = 0;
+};
+
+// the process' CPU time, across all threads
+std::chrono::nanoseconds cpu_time() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::duration<double>(static_cast<double>(std::clock()) /
+                                    CLOCKS_PER_SEC));
+}
+
+// the app's event loop, without the presentation. the busy loop ticks the
+// pipeline at the refresh rate even when nothing changed.
+Measurement run_loop(Pipeline& pipeline, WindowApiHandle& events,
+                     bool idle_mode, std::chrono::nanoseconds duration) {
+  Measurement measurement;
+
+  auto const begin = std::chrono::steady_clock::now();
+  std::chrono::nanoseconds const cpu_begin = cpu_time();
+
+  while (std::chrono::steady_clock::now() - begin < duration) {
+    auto const frame_begin = std::chrono::steady_clock::now();
+
+    pipeline.tick(kFrame);
+    measurement.num_frames++;
+
+    while (events.poll_events()) {
+      measurement.num_events++;
+    }
+
+    // the frames are rendered on this thread, so the stale tiles are too
+    if (idle_mode && pipeline.is_idle() &&
+        !pipeline.tile_cache.rasterizer.has_stale_tiles()) {
+      if (events.wait_events(kIdleWaitTimeout)) {
+        measurement.num_events++;
+        while (events.poll_events()) {
+          measurement.num_events++;
+        }
+      }
+    } else {
+      auto const used = std::chrono::steady_clock::now() - frame_begin;
+      if (used < kFrame) std::this_thread::sleep_for(kFrame - used);
+    }
+  }
+
+  measurement.wall_time = std::chrono::steady_clock::now() - begin;
+  measurement.cpu_time = cpu_time() - cpu_begin;
+
+  return measurement;
+}
+
+void print(char const* name, Measurement const& measurement) {
+  std::cout << name << ": " << measurement.num_frames << " frames, "
+            << measurement.num_events << " events, "
+            << std::chrono::duration_cast<std::chrono::microseconds>(
+                   measurement.cpu_time)
+                   .count()
+            << "us of CPU time over "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   measurement.wall_time)
+                   .count()
+            << "ms ("
+            << 100.0 * measurement.cpu_time.count() /
+                   measurement.wall_time.count()
+            << "% of a core)\n";
+}
+
+}  // namespace idle_test
+
+TEST(IdleTest, IsIdle) {
+  using namespace idle_test;
+
+  MockSized sized{Extent{100, 100}};
+  MockView root{&sized};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  EXPECT_FALSE(pipeline.is_idle());
+
+  pipeline.tick(kFrame);
+
+  EXPECT_TRUE(pipeline.is_idle());
+
+  sized.mark_render_dirty();
+  EXPECT_FALSE(pipeline.is_idle());
+
+  pipeline.tick(kFrame);
+  EXPECT_TRUE(pipeline.is_idle());
+
+  // i.e. awaiting a future
+  sized.subscribe_ticks();
+  pipeline.tick(kFrame);
+  EXPECT_FALSE(pipeline.is_idle());
+
+  sized.unsubscribe_ticks();
+  pipeline.tick(kFrame);
+  EXPECT_TRUE(pipeline.is_idle());
+
+  float value = 0.0f;
+  pipeline.animations->animate(
+      AnimationTarget{&sized, &value, WidgetDirtiness::Render}, 0.0f, 1.0f,
+      2 * kFrame);
+  EXPECT_FALSE(pipeline.is_idle());
+
+  for (size_t i = 0; i < 4; i++) {
+    pipeline.tick(kFrame);
+  }
+
+  EXPECT_TRUE(pipeline.is_idle());
+
+  pipeline.viewport.resize(Extent{400, 600}, ViewExtent::relative(1.0f, 1.0f));
+  EXPECT_FALSE(pipeline.is_idle());
+}
+
+TEST(IdleTest, LayerEffects) {
+  using namespace idle_test;
+
+  MockSized sized{Extent{100, 100}};
+  MockView layer{&sized};
+  layer.init_is_layer(true);
+  MockView root{&layer};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  pipeline.tick(kFrame);
+  ASSERT_TRUE(pipeline.is_idle());
+
+  // i.e. faded by an event handler
+  layer.update_layer_effects(LayerEffects{}.with_opacity(0.5f));
+  EXPECT_FALSE(pipeline.is_idle());
+
+  EXPECT_EQ(pipeline.tick(kFrame), BackingStoreDiff::Some);
+  EXPECT_TRUE(pipeline.is_idle());
+}
+
+TEST(IdleTest, ScrolledListAndGrid) {
+  using namespace idle_test;
+
+  VirtualList list{
+      [](size_t) -> Widget* { return new MockSized{Extent{100, 20}}; },
+      VirtualListProps{}.item_count(10'000).item_extent_estimate(20).extent(
+          SelfExtent::relative(1.0f, 0.5f))};
+  Grid grid{[](size_t) -> Widget* { return new MockSized{Extent{50, 50}}; },
+            GridProps{}
+                .columns(4)
+                .cell_extent(Extent{50, 50})
+                .item_count(10'000)
+                .extent(SelfExtent::relative(1.0f, 0.5f))};
+  MockFlex flex{&list, &grid};
+  MockView root{&flex};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  auto const settle = [&]() {
+    for (size_t i = 0; i < 8 && !pipeline.is_idle(); i++) {
+      pipeline.tick(kFrame);
+    }
+  };
+
+  settle();
+  EXPECT_TRUE(pipeline.is_idle());
+
+  for (uint32_t offset = 0; offset <= 4000; offset += 400) {
+    list.scroll_to(offset);
+    grid.scroll_to(offset);
+    EXPECT_FALSE(pipeline.is_idle());
+    pipeline.tick(kFrame);
+  }
+
+  // the loop blocks once the scrolling settles
+  settle();
+  EXPECT_TRUE(pipeline.is_idle());
+  EXPECT_GT(list.get_range_begin(), 0);
+  EXPECT_GT(grid.get_range_begin(), 0);
+}
+
+// measures the CPU usage of an idle window, with a background task waking the
+// event loop up periodically
+TEST(IdleTest, CpuUsage) {
+  using namespace idle_test;
+
+  ASSERT_EQ(SDL_Init(SDL_INIT_EVENTS), 0);
+  WindowApiHandle::register_wake_event();
+
+  // not initialized, so it doesn't quit SDL
+  WindowApiHandle events;
+
+  MockSized sized{Extent{100, 100}};
+  MockView root{&sized};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+  pipeline.context.get_waker()->__bind(&WindowApiHandle::wake);
+
+  pipeline.tick(kFrame);
+  ASSERT_TRUE(pipeline.is_idle());
+
+  constexpr std::chrono::milliseconds kDuration{1000};
+  constexpr size_t kNumWakes = 8;
+
+  Measurement const busy = run_loop(pipeline, events, false, kDuration);
+
+  std::atomic<size_t> num_wakes{0};
+
+  std::thread background{[&]() {
+    std::shared_ptr<EventLoopWaker> waker = pipeline.context.get_waker();
+    for (size_t i = 0; i < kNumWakes; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      waker->wake();
+      num_wakes++;
+    }
+  }};
+
+  Measurement const idle = run_loop(pipeline, events, true, kDuration);
+
+  background.join();
+
+  std::cout << '\n';
+  print("busy", busy);
+  print("idle", idle);
+
+  // a frame per wake-up (or timeout), instead of one per refresh
+  EXPECT_EQ(num_wakes, kNumWakes);
+  EXPECT_GE(idle.num_events, 1);
+  EXPECT_LT(idle.num_frames, busy.num_frames / 3);
+
+  WindowApiHandle::wake_event_type = 0;
+  SDL_Quit();
+}
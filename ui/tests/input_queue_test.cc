@@ -0,0 +1,290 @@
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mock_widgets.h"
+#include "vlk/ui/heap_stats.h"
+#include "vlk/ui/pipeline.h"
+#include "vlk/ui/ring_buffer.h"
+#include "vlk/ui/window_event_queue.h"
+
+namespace input_queue_test {
+
+struct WheelCounter : public Widget {
+  WheelCounter() : Widget{WidgetType::Render} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent::absolute(200, 200));
+  }
+
+  ~WheelCounter() override {}
+
+  virtual bool on_mouse_wheel(MouseWheelEvent const& event) override {
+    wheel_events.push_back(event);
+    return true;
+  }
+
+  virtual bool on_mouse_motion(MouseMotionEvent const& event) override {
+    motion_events.push_back(event);
+    return true;
+  }
+
+  std::vector<MouseWheelEvent> wheel_events;
+  std::vector<MouseMotionEvent> motion_events;
+};
+
+struct ClickCounter : public Widget {
+  ClickCounter() : Widget{WidgetType::Render} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent::absolute(200, 200));
+  }
+
+  ~ClickCounter() override {}
+
+  virtual bool on_mouse_button(MouseButtonEvent const&) override {
+    num_clicks++;
+    if (on_click) on_click();
+    return true;
+  }
+
+  size_t num_clicks = 0;
+  std::function<void()> on_click;
+};
+
+// a row whose children can be removed, i.e. a list of dismissable items
+struct MutableRow : public Widget {
+  explicit MutableRow(std::vector<Widget*> init_children)
+      : Widget{WidgetType::Render}, children_{std::move(init_children)} {
+    Widget::init_is_flex(true);
+    Widget::update_flex(Flex{Direction::Row, Wrap::None, MainAlign::Start,
+                             CrossAlign::Start, Fit::Expand, Fit::Expand});
+    Widget::update_self_extent(SelfExtent::relative(1.0f, 1.0f));
+    Widget::update_children(children_);
+  }
+
+  ~MutableRow() override {}
+
+  void update(std::vector<Widget*> new_children) {
+    children_ = std::move(new_children);
+    Widget::update_children(children_);
+  }
+
+  std::vector<Widget*> children_;
+};
+
+MouseButtonEvent click(int64_t x, EventTimestamp timestamp) {
+  MouseButtonEvent event{};
+  event.offset = IOffset{x, 50};
+  event.clicks = 1;
+  event.timestamp = timestamp;
+  return event;
+}
+
+MouseMotionEvent motion(int64_t x, int64_t dx, EventTimestamp timestamp) {
+  MouseMotionEvent event{};
+  event.offset = IOffset{x, 10};
+  event.translation = IOffset{dx, 0};
+  event.timestamp = timestamp;
+  return event;
+}
+
+}  // namespace input_queue_test
+
+TEST(InputQueueTest, RingBuffer) {
+  RingBuffer<int, 4> ring;
+
+  EXPECT_TRUE(ring.empty());
+
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.push(i));
+  }
+
+  EXPECT_TRUE(ring.full());
+
+  // the oldest elements are overwritten
+  EXPECT_FALSE(ring.push(4));
+  EXPECT_FALSE(ring.push(5));
+
+  EXPECT_EQ(ring.size(), 4);
+  EXPECT_EQ(ring.front(), 2);
+  EXPECT_EQ(ring.back(), 5);
+  EXPECT_EQ(ring[1], 3);
+
+  ring.pop_front();
+  EXPECT_EQ(ring.front(), 3);
+  EXPECT_EQ(ring.size(), 3);
+
+  ring.clear();
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(InputQueueTest, Coalescing) {
+  using namespace input_queue_test;
+
+  WindowEventQueue queue;
+  EventTimestamp const begin = std::chrono::steady_clock::now();
+
+  for (int64_t i = 1; i <= 10; i++) {
+    queue.add_raw(motion(i * 2, 2, begin + std::chrono::milliseconds(i)));
+  }
+
+  MouseButtonEvent press{};
+  press.timestamp = begin + std::chrono::milliseconds(11);
+  queue.add_raw(press);
+
+  for (int64_t i = 12; i <= 15; i++) {
+    queue.add_raw(motion(i * 2, 2, begin + std::chrono::milliseconds(i)));
+  }
+
+  // motion, button, motion
+  ASSERT_EQ(queue.input_events.size(), 3);
+  EXPECT_EQ(queue.num_coalesced, 12);
+
+  MouseMotionEvent const& first =
+      std::get<MouseMotionEvent>(queue.input_events[0]);
+  EXPECT_EQ(first.offset, (IOffset{20, 10}));
+  EXPECT_EQ(first.translation, (IOffset{20, 0}));
+  // the earliest of the merged events' timestamps
+  EXPECT_EQ(first.timestamp, begin + std::chrono::milliseconds(1));
+
+  EXPECT_TRUE(std::holds_alternative<MouseButtonEvent>(queue.input_events[1]));
+  EXPECT_EQ(std::get<MouseMotionEvent>(queue.input_events[2]).translation,
+            (IOffset{8, 0}));
+
+  // the history is at full resolution
+  EXPECT_EQ(queue.motion_history.size(), 14);
+
+  MouseWheelEvent wheel{};
+  wheel.translation = IOffset{0, 1};
+  queue.add_raw(wheel);
+  queue.add_raw(wheel);
+  queue.add_raw(wheel);
+
+  ASSERT_EQ(queue.input_events.size(), 4);
+  EXPECT_EQ(std::get<MouseWheelEvent>(queue.input_events[3]).translation,
+            (IOffset{0, 3}));
+
+  queue.clear();
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.motion_history.size(), 14);
+}
+
+TEST(InputQueueTest, Velocity) {
+  using namespace input_queue_test;
+
+  WindowEventQueue queue;
+  EventTimestamp const begin = std::chrono::steady_clock::now();
+
+  EXPECT_FLOAT_EQ(queue.get_pointer_velocity(MouseID{}).x, 0.0f);
+
+  // 4 pixels every 8ms, i.e. 500 pixels per second
+  for (int64_t i = 0; i < 40; i++) {
+    queue.add_raw(motion(i * 4, 4, begin + std::chrono::milliseconds(i * 8)));
+  }
+
+  VOffset const velocity = queue.get_pointer_velocity(MouseID{});
+  EXPECT_NEAR(velocity.x, 500.0f, 1.0f);
+  EXPECT_FLOAT_EQ(velocity.y, 0.0f);
+}
+
+TEST(InputQueueTest, Overflow) {
+  WindowEventQueue queue;
+
+  HeapStats const start = get_heap_stats();
+
+  for (size_t i = 0; i < WindowEventQueue::kInputCapacity + 10; i++) {
+    MouseButtonEvent event{};
+    event.clicks = static_cast<uint32_t>(i);
+    queue.add_raw(event);
+  }
+
+  // the queue doesn't allocate, the oldest events are dropped
+  EXPECT_EQ(get_heap_stats().since(start).num_allocations, 0);
+  EXPECT_EQ(queue.num_dropped, 10);
+  EXPECT_EQ(queue.input_events.size(), WindowEventQueue::kInputCapacity);
+  EXPECT_EQ(std::get<MouseButtonEvent>(queue.input_events.front()).clicks, 10);
+}
+
+TEST(InputQueueTest, Dispatch) {
+  using namespace input_queue_test;
+
+  WheelCounter counter;
+  MockView root{&counter};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  WindowEventQueue queue;
+  EventTimestamp const begin = std::chrono::steady_clock::now();
+
+  for (int64_t i = 1; i <= 5; i++) {
+    queue.add_raw(motion(i * 2, 2, begin + std::chrono::milliseconds(i)));
+  }
+
+  MouseWheelEvent wheel{};
+  wheel.offset = IOffset{50, 50};
+  wheel.translation = IOffset{0, -1};
+  wheel.timestamp = begin;
+  queue.add_raw(wheel);
+  queue.add_raw(wheel);
+
+  pipeline.dispatch_events(queue);
+
+  ASSERT_EQ(counter.motion_events.size(), 1);
+  EXPECT_EQ(counter.motion_events[0].translation, (IOffset{10, 0}));
+  ASSERT_EQ(counter.wheel_events.size(), 1);
+  EXPECT_EQ(counter.wheel_events[0].translation, (IOffset{0, -2}));
+
+  // the frame that follows carries the earliest input's timestamp
+  counter.mark_render_dirty();
+  ASSERT_EQ(pipeline.tick(std::chrono::milliseconds(16)),
+            BackingStoreDiff::Some);
+  EXPECT_TRUE(pipeline.tile_cache.snapshot.has_input);
+  EXPECT_EQ(pipeline.tile_cache.snapshot.input_timestamp, begin);
+}
+
+TEST(InputQueueTest, DispatchAfterRemoval) {
+  using namespace input_queue_test;
+
+  ClickCounter dismiss;
+  ClickCounter removed;
+  MutableRow row{{&dismiss, &removed}};
+  MockView root{&row};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  // the removed widget would usually be deleted right away
+  dismiss.on_click = [&]() { row.update({&dismiss}); };
+
+  WindowEventQueue queue;
+  EventTimestamp const begin = std::chrono::steady_clock::now();
+
+  // the second click lands on the removed widget's area, [200, 400)
+  queue.add_raw(click(50, begin));
+  queue.add_raw(click(250, begin + std::chrono::milliseconds(1)));
+
+  pipeline.dispatch_events(queue);
+
+  EXPECT_EQ(dismiss.num_clicks, 1);
+  EXPECT_EQ(removed.num_clicks, 0);
+
+  // hit-tested again once the trees are rebuilt
+  pipeline.tick(std::chrono::milliseconds(16));
+
+  queue.clear();
+  queue.add_raw(click(250, begin + std::chrono::milliseconds(20)));
+  queue.add_raw(click(50, begin + std::chrono::milliseconds(21)));
+
+  dismiss.on_click = nullptr;
+  pipeline.dispatch_events(queue);
+
+  EXPECT_EQ(dismiss.num_clicks, 2);
+  EXPECT_EQ(removed.num_clicks, 0);
+}
@@ -1,5 +1,326 @@
 #include "vlk/ui/pipeline.h"
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
 #include "gtest/gtest.h"
+#include "mock_widgets.h"
+
+namespace pipeline_test {
+
+// animates for a fixed number of frames
+struct CountingTicks : public Widget {
+  CountingTicks(size_t init_num_frames,
+                OffscreenTickPolicy policy = OffscreenTickPolicy::Throttle)
+      : Widget{WidgetType::Render} {
+    Widget::init_is_flex(false);
+    Widget::init_offscreen_tick_policy(policy);
+    Widget::update_self_extent(SelfExtent::absolute(20, 20));
+    num_frames = init_num_frames;
+    if (num_frames != 0) Widget::subscribe_ticks();
+  }
+
+  ~CountingTicks() override {}
+
+  virtual void tick(std::chrono::nanoseconds interval,
+                    SubsystemsContext const&) override {
+    num_ticks++;
+    total_interval += interval;
+    Widget::mark_render_dirty();
+    if (num_ticks == num_frames) Widget::unsubscribe_ticks();
+  }
+
+  virtual void on_visibility_changed(bool is_visible) override {
+    visibility_changes.push_back(is_visible);
+  }
+
+  size_t num_frames = 0;
+  size_t num_ticks = 0;
+  std::chrono::nanoseconds total_interval{0};
+  std::vector<bool> visibility_changes;
+};
+
+struct CountingDraws : public Widget {
+  CountingDraws(Extent extent) : Widget{WidgetType::Render} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent::absolute(extent));
+  }
+
+  ~CountingDraws() override {}
+
+  virtual void draw(Canvas&) override { num_draws++; }
+
+  size_t num_draws = 0;
+};
+
+// a column whose children can be appended or removed, i.e. a chat log
+struct MutableColumn : public Widget {
+  MutableColumn(WidgetType type) : Widget{type} {
+    Widget::init_is_flex(true);
+    Widget::update_flex(Flex{Direction::Column, Wrap::None, MainAlign::Start,
+                             CrossAlign::Start, Fit::Expand, Fit::Expand});
+    Widget::update_self_extent(SelfExtent::relative(1.0f, 1.0f));
+    Widget::update_view_extent(ViewExtent::relative(1.0f, 1.0f));
+  }
+
+  ~MutableColumn() override {}
+
+  void update(std::vector<Widget*> new_children) {
+    children_ = std::move(new_children);
+    Widget::update_children(children_);
+  }
+
+  std::vector<Widget*> children_;
+};
+
+}  // namespace pipeline_test
+
+TEST(PipelineTest, None) {}
+
+TEST(PipelineTest, DirtyQueues) {
+  MockSized w{Extent{20, 20}};
+  MockView v{&w};
+  MockView root{&v};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  ASSERT_EQ(pipeline.view_tree.views.size(), 2);
+  ASSERT_EQ(pipeline.view_tree.entries.size(), 1);
+
+  v.update_view_offset(ViewOffset::absolute(5, 0));
+  w.mark_render_dirty();
+
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  // drained without requiring a rebuild
+  EXPECT_FALSE(pipeline.needs_rebuild);
+  EXPECT_FALSE(pipeline.dirty_queues.children_changed);
+  EXPECT_TRUE(pipeline.dirty_queues.view_offset_dirty.empty());
+  EXPECT_TRUE(pipeline.dirty_queues.render_dirty.empty());
+
+  EXPECT_EQ(pipeline.view_tree.entries[0].screen_offset, (IOffset{5, 0}));
+}
+
+TEST(PipelineTest, TickSubscription) {
+  using namespace pipeline_test;
+
+  CountingTicks animated{3};
+  CountingTicks idle{0};
+  MockFlex flex{&animated, &idle};
+  MockView root{&flex};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  for (size_t i = 0; i < 10; i++) {
+    pipeline.tick(std::chrono::nanoseconds(0));
+  }
+
+  // unsubscribed widgets are never ticked, and only flushed when dirty
+  EXPECT_EQ(animated.num_ticks, 3);
+  EXPECT_EQ(idle.num_ticks, 0);
+  EXPECT_TRUE(pipeline.dirty_queues.active_widgets.empty());
+
+  // re-activated by its dirtiness, but not ticked
+  idle.mark_render_dirty();
+  EXPECT_EQ(pipeline.dirty_queues.active_widgets.size(), 1);
+
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  EXPECT_EQ(idle.num_ticks, 0);
+  EXPECT_TRUE(pipeline.dirty_queues.active_widgets.empty());
+
+  animated.num_frames = 5;
+  animated.subscribe_ticks();
+
+  for (size_t i = 0; i < 10; i++) {
+    pipeline.tick(std::chrono::nanoseconds(0));
+  }
+
+  EXPECT_EQ(animated.num_ticks, 5);
+  EXPECT_TRUE(pipeline.dirty_queues.active_widgets.empty());
+}
+
+TEST(PipelineTest, IncrementalRebuild) {
+  using namespace pipeline_test;
+
+  for (WidgetType type : {WidgetType::Render, WidgetType::View}) {
+    std::vector<std::unique_ptr<CountingDraws>> items;
+    std::vector<Widget*> children;
+
+    for (size_t i = 0; i < 11; i++) {
+      items.emplace_back(new CountingDraws{Extent{400, 40}});
+    }
+
+    for (size_t i = 0; i < 10; i++) {
+      children.push_back(items[i].get());
+    }
+
+    MockSized nested{Extent{20, 20}};
+    MockView nested_view{&nested};
+
+    MutableColumn column{type};
+    column.update(children);
+    MockView root{&column};
+
+    RenderContext context;
+    Pipeline pipeline{root, context};
+    pipeline.viewport.resize(Extent{800, 600},
+                             ViewExtent::relative(1.0f, 1.0f));
+
+    pipeline.tick(std::chrono::nanoseconds(0));
+    pipeline.tick(std::chrono::nanoseconds(0));
+
+    size_t const num_entries = pipeline.view_tree.entries.size();
+
+    for (auto& item : items) {
+      item->num_draws = 0;
+    }
+
+    // append a message at [400, 440)
+    children.push_back(items[10].get());
+    column.update(children);
+
+    pipeline.tick(std::chrono::nanoseconds(0));
+
+    EXPECT_EQ(pipeline.view_tree.entries.size(), num_entries + 1);
+    EXPECT_EQ(items[10]->get_layout_extent(), (Extent{400, 40}));
+    EXPECT_GT(items[10]->num_draws, 0);
+
+    // only the widgets on the tiles the new message covers are re-recorded
+    for (size_t i = 0; i < 6; i++) {
+      EXPECT_EQ(items[i]->num_draws, 0);
+    }
+
+    ViewTree::Entry const* hit =
+        pipeline.hit_test_index.hit_test(IOffset{10, 410});
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(hit->layout_node->widget, items[10].get());
+
+    for (auto& item : items) {
+      item->num_draws = 0;
+    }
+
+    // remove the first message, moving all of the others
+    children.erase(children.begin());
+    column.update(children);
+
+    pipeline.tick(std::chrono::nanoseconds(0));
+
+    EXPECT_EQ(pipeline.view_tree.entries.size(), num_entries);
+    EXPECT_GT(items[1]->num_draws, 0);
+
+    hit = pipeline.hit_test_index.hit_test(IOffset{10, 10});
+    ASSERT_NE(hit, nullptr);
+    EXPECT_EQ(hit->layout_node->widget, items[1].get());
+
+    // adding a view requires a full rebuild
+    children.push_back(&nested_view);
+    column.update(children);
+
+    pipeline.tick(std::chrono::nanoseconds(0));
+
+    EXPECT_EQ(pipeline.view_tree.views.size(),
+              type == WidgetType::View ? 3 : 2);
+    EXPECT_EQ(pipeline.view_tree.entries.size(), num_entries + 1);
+  }
+}
+
+TEST(PipelineTest, OffscreenTicks) {
+  using namespace pipeline_test;
+
+  constexpr std::chrono::nanoseconds kInterval = std::chrono::milliseconds(16);
+
+  CountingTicks visible{1000};
+  CountingTicks throttled{1000, OffscreenTickPolicy::Throttle};
+  CountingTicks paused{1000, OffscreenTickPolicy::Pause};
+  CountingDraws spacer{Extent{20, 5000}};
+
+  MutableColumn column{WidgetType::Render};
+  column.update({&visible, &spacer, &throttled, &paused});
+  MockView root{&column};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  // all of the widgets are ticked on the first frame, they aren't on the
+  // trees yet
+  for (size_t i = 0; i < 60; i++) {
+    pipeline.tick(kInterval);
+  }
+
+  EXPECT_EQ(visible.num_ticks, 60);
+  EXPECT_GT(throttled.num_ticks, 1);
+  EXPECT_LE(throttled.num_ticks,
+            1 + (59 * kInterval) / Widget::kOffscreenTickPeriod);
+  EXPECT_EQ(paused.num_ticks, 1);
+
+  EXPECT_FALSE(visible.is_stale());
+  EXPECT_TRUE(throttled.is_stale());
+  EXPECT_EQ(visible.visibility_changes, (std::vector<bool>{true}));
+  EXPECT_TRUE(throttled.visibility_changes.empty());
+
+  // scroll the off-screen widgets into view
+  column.update({&throttled, &paused, &spacer, &visible});
+  pipeline.tick(kInterval);
+
+  EXPECT_EQ(visible.visibility_changes, (std::vector<bool>{true, false}));
+  EXPECT_EQ(throttled.visibility_changes, (std::vector<bool>{true}));
+  EXPECT_EQ(paused.visibility_changes, (std::vector<bool>{true}));
+
+  size_t const num_paused_ticks = paused.num_ticks;
+  pipeline.tick(kInterval);
+
+  // resumed with the interval elapsed whilst they were off-screen
+  EXPECT_EQ(paused.num_ticks, num_paused_ticks + 1);
+  EXPECT_EQ(paused.total_interval, 62 * kInterval);
+  EXPECT_EQ(throttled.total_interval, 62 * kInterval);
+}
+
+TEST(PipelineTest, PausedOffscreenTicksAreIdle) {
+  using namespace pipeline_test;
+
+  constexpr std::chrono::nanoseconds kInterval = std::chrono::milliseconds(16);
+
+  CountingTicks paused{1000, OffscreenTickPolicy::Pause};
+  CountingDraws spacer{Extent{20, 5000}};
+
+  MutableColumn column{WidgetType::Render};
+  column.update({&spacer, &paused});
+  MockView root{&column};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  for (size_t i = 0; i < 3; i++) {
+    pipeline.tick(kInterval);
+  }
+
+  // the paused animator is parked whilst it is off-screen
+  EXPECT_EQ(paused.num_ticks, 1);
+  EXPECT_TRUE(pipeline.dirty_queues.active_widgets.empty());
+  EXPECT_TRUE(pipeline.is_idle());
+
+  for (size_t i = 0; i < 10; i++) {
+    pipeline.tick(kInterval);
+  }
+
+  EXPECT_EQ(paused.num_ticks, 1);
+
+  // and resumed once it is visible again
+  column.update({&paused, &spacer});
+  pipeline.tick(kInterval);
+  EXPECT_FALSE(pipeline.is_idle());
 
-TEST(PipelineTest, None) {}
\ No newline at end of file
+  pipeline.tick(kInterval);
+  EXPECT_EQ(paused.num_ticks, 2);
+  EXPECT_EQ(paused.total_interval, 15 * kInterval);
+}
@@ -0,0 +1,225 @@
+#include "vlk/ui/reconcile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "mock_widgets.h"
+#include "vlk/ui/pipeline.h"
+
+namespace reconcile_test {
+
+struct CountingDraws : public Widget {
+  CountingDraws(WidgetKey init_key) : Widget{WidgetType::Render} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent::absolute(400, 40));
+    key = init_key;
+  }
+
+  ~CountingDraws() override {}
+
+  virtual void draw(Canvas&) override { num_draws++; }
+
+  WidgetKey key = 0;
+  size_t num_draws = 0;
+};
+
+struct KeyedColumn : public Widget {
+  KeyedColumn() : Widget{WidgetType::Render} {
+    Widget::init_is_flex(true);
+    Widget::update_flex(Flex{Direction::Column, Wrap::None, MainAlign::Start,
+                             CrossAlign::Start, Fit::Expand, Fit::Expand});
+    Widget::update_self_extent(SelfExtent::relative(1.0f, 1.0f));
+  }
+
+  ~KeyedColumn() override {}
+
+  void update(std::vector<WidgetKey> const& keys) {
+    if (children.reconcile(keys, [this](WidgetKey key, size_t) -> Widget* {
+          num_built++;
+          return new CountingDraws{key};
+        })) {
+      Widget::update_children(children.get_widgets());
+    }
+  }
+
+  CountingDraws& get(WidgetKey key) const {
+    return *static_cast<CountingDraws*>(children.find(key));
+  }
+
+  KeyedChildren children;
+  size_t num_built = 0;
+};
+
+std::vector<ReconcileOp> reconcile(KeyedChildren& children,
+                                   std::vector<WidgetKey> const& keys) {
+  children.reconcile(keys, [](WidgetKey, size_t) -> Widget* {
+    return new MockSized{Extent{10, 10}};
+  });
+  return std::vector<ReconcileOp>{children.get_ops().begin(),
+                                  children.get_ops().end()};
+}
+
+constexpr size_t kNone = ReconcileOp::kNone;
+
+}  // namespace reconcile_test
+
+TEST(ReconcileTest, Ops) {
+  using namespace reconcile_test;
+
+  KeyedChildren children;
+
+  EXPECT_EQ(reconcile(children, {1, 2, 3, 4, 5}),
+            (std::vector<ReconcileOp>{{ReconcileOpType::Insert, kNone, 0},
+                                      {ReconcileOpType::Insert, kNone, 1},
+                                      {ReconcileOpType::Insert, kNone, 2},
+                                      {ReconcileOpType::Insert, kNone, 3},
+                                      {ReconcileOpType::Insert, kNone, 4}}));
+
+  std::vector<Widget*> const widgets{children.get_widgets().begin(),
+                                     children.get_widgets().end()};
+
+  EXPECT_TRUE(reconcile(children, {1, 2, 3, 4, 5}).empty());
+
+  // moving an item to the front only moves that item
+  EXPECT_EQ(reconcile(children, {5, 1, 2, 3, 4}),
+            (std::vector<ReconcileOp>{{ReconcileOpType::Move, 4, 0}}));
+
+  EXPECT_EQ(children.get_widgets()[0], widgets[4]);
+  EXPECT_EQ(children.get_widgets()[1], widgets[0]);
+
+  // filter
+  EXPECT_EQ(reconcile(children, {5, 2, 4}),
+            (std::vector<ReconcileOp>{{ReconcileOpType::Remove, 3, kNone},
+                                      {ReconcileOpType::Remove, 1, kNone}}));
+
+  EXPECT_EQ(children.get_widgets()[1], widgets[1]);
+  EXPECT_EQ(children.find(3), nullptr);
+
+  // reversal keeps one of the items in place
+  EXPECT_EQ(reconcile(children, {4, 2, 6, 5}),
+            (std::vector<ReconcileOp>{{ReconcileOpType::Move, 2, 0},
+                                      {ReconcileOpType::Move, 1, 1},
+                                      {ReconcileOpType::Insert, kNone, 2}}));
+
+  EXPECT_EQ(children.get_widgets()[3], widgets[4]);
+
+  EXPECT_EQ(reconcile(children, {}),
+            (std::vector<ReconcileOp>{{ReconcileOpType::Remove, 3, kNone},
+                                      {ReconcileOpType::Remove, 2, kNone},
+                                      {ReconcileOpType::Remove, 1, kNone},
+                                      {ReconcileOpType::Remove, 0, kNone}}));
+}
+
+TEST(ReconcileTest, MinimalMoves) {
+  using namespace reconcile_test;
+
+  KeyedChildren children;
+
+  std::vector<WidgetKey> keys;
+  for (WidgetKey key = 0; key < 1000; key++) {
+    keys.push_back(key);
+  }
+
+  reconcile(children, keys);
+
+  // shuffle with a fixed seed
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  for (size_t i = keys.size() - 1; i > 0; i--) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    std::swap(keys[i], keys[(state >> 33) % (i + 1)]);
+  }
+
+  std::vector<ReconcileOp> const ops = reconcile(children, keys);
+
+  // the items that aren't moved form an increasing run of the previous
+  // indices, and no longer one exists
+  std::vector<bool> moved(keys.size(), false);
+  for (ReconcileOp const& op : ops) {
+    ASSERT_EQ(op.type, ReconcileOpType::Move);
+    moved[op.to] = true;
+  }
+
+  std::vector<WidgetKey> stationary;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!moved[i]) stationary.push_back(keys[i]);
+  }
+
+  EXPECT_TRUE(std::is_sorted(stationary.begin(), stationary.end()));
+
+  std::vector<WidgetKey> tails;
+  for (WidgetKey key : keys) {
+    auto const tail = std::lower_bound(tails.begin(), tails.end(), key);
+    if (tail == tails.end()) {
+      tails.push_back(key);
+    } else {
+      *tail = key;
+    }
+  }
+
+  EXPECT_EQ(stationary.size(), tails.size());
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_EQ(children.get_keys()[i], keys[i]);
+  }
+}
+
+TEST(ReconcileTest, Pipeline) {
+  using namespace reconcile_test;
+
+  KeyedColumn column;
+  column.update({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+  MockView root{&column};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  pipeline.tick(std::chrono::nanoseconds(0));
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  auto const reset_draws = [&]() {
+    for (Widget* widget : column.children.get_widgets()) {
+      static_cast<CountingDraws*>(widget)->num_draws = 0;
+    }
+  };
+
+  reset_draws();
+
+  // swap the last two items at [400, 480)
+  column.update({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 11, 10});
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  EXPECT_FALSE(pipeline.needs_rebuild);
+  EXPECT_EQ(column.num_built, 12);
+  EXPECT_EQ(column.get(11).get_layout_extent(), (Extent{400, 40}));
+  EXPECT_GT(column.get(11).num_draws, 0);
+
+  // only the widgets on the tiles the moved items cover are re-recorded
+  for (WidgetKey key = 0; key < 6; key++) {
+    EXPECT_EQ(column.get(key).num_draws, 0);
+  }
+
+  ViewTree::Entry const* hit =
+      pipeline.hit_test_index.hit_test(IOffset{10, 410});
+  ASSERT_NE(hit, nullptr);
+  EXPECT_EQ(hit->layout_node->widget, &column.get(11));
+
+  reset_draws();
+
+  // filter out an item, the items before it keep their recorded tiles
+  column.update({0, 1, 2, 3, 4, 5, 6, 7, 9, 11, 10});
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  EXPECT_EQ(pipeline.view_tree.entries.size(), 12);
+
+  for (WidgetKey key = 0; key < 6; key++) {
+    EXPECT_EQ(column.get(key).num_draws, 0);
+  }
+
+  hit = pipeline.hit_test_index.hit_test(IOffset{10, 330});
+  ASSERT_NE(hit, nullptr);
+  EXPECT_EQ(hit->layout_node->widget, &column.get(9));
+}
@@ -0,0 +1,260 @@
+#include "vlk/ui/render_thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "include/core/SkCanvas.h"
+#include "include/core/SkPaint.h"
+#include "mock_widgets.h"
+#include "vlk/ui/pipeline.h"
+
+namespace render_thread_test {
+
+// draws enough content that rasterizing it costs about as much as recording
+struct Scribble : public Widget {
+  explicit Scribble(uint32_t init_seed)
+      : Widget{WidgetType::Render}, seed{init_seed} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent::absolute(800, 100));
+  }
+
+  ~Scribble() override {}
+
+  virtual void draw(Canvas& canvas) override {
+    SkCanvas& sk_canvas = canvas.to_skia();
+    SkPaint paint;
+    paint.setAntiAlias(true);
+
+    for (uint32_t i = 0; i < 200; i++) {
+      uint32_t const hash = (seed * 2654435761U) ^ (i * 40503U);
+      paint.setColor(SkColorSetARGB(0xC0, hash & 0xFF, (hash >> 8) & 0xFF,
+                                    (hash >> 16) & 0xFF));
+      sk_canvas.drawCircle(static_cast<float>(hash % 800),
+                           static_cast<float>((hash >> 10) % 100),
+                           static_cast<float>(4 + i % 24), paint);
+    }
+  }
+
+  uint32_t seed = 0;
+};
+
+struct ScrollColumn : public Widget {
+  explicit ScrollColumn(std::vector<Widget*> init_children)
+      : Widget{WidgetType::View}, children_{std::move(init_children)} {
+    Widget::init_is_flex(true);
+    Widget::update_children(children_);
+    Widget::update_flex(Flex{Direction::Column, Wrap::None, MainAlign::Start,
+                             CrossAlign::Start, Fit::Shrink, Fit::Expand});
+    Widget::update_self_extent(SelfExtent{Constrain::relative(1.0f),
+                                          Constrain::relative(1.0f)});
+    Widget::update_view_extent(ViewExtent{
+        Constrain::relative(1.0f), Constrain::unbounded(stx::u32_max)});
+  }
+
+  ~ScrollColumn() override {}
+
+  std::vector<Widget*> children_;
+};
+
+struct Scene {
+  Scene() {
+    for (uint32_t i = 0; i < 200; i++) {
+      items.emplace_back(new Scribble{i});
+    }
+
+    std::vector<Widget*> children;
+    for (auto& item : items) children.push_back(item.get());
+
+    column = std::make_unique<ScrollColumn>(std::move(children));
+    root = std::make_unique<MockView>(column.get());
+  }
+
+  void scroll(uint32_t frame) {
+    column->update_view_offset(ViewOffset::scroll(0, frame * 30));
+  }
+
+  std::vector<std::unique_ptr<Scribble>> items;
+  std::unique_ptr<ScrollColumn> column;
+  std::unique_ptr<MockView> root;
+};
+
+std::vector<uint32_t> read_pixels(RasterCache& cache) {
+  SkSurface& surface = cache.get_surface_ref();
+  SkImageInfo const info = SkImageInfo::MakeN32Premul(surface.width(),
+                                                      surface.height());
+  std::vector<uint32_t> pixels;
+  pixels.resize(static_cast<size_t>(info.width()) * info.height());
+  EXPECT_TRUE(surface.readPixels(info, pixels.data(), info.minRowBytes(), 0,
+                                 0));
+  return pixels;
+}
+
+constexpr uint32_t kNumFrames = 120;
+constexpr std::chrono::nanoseconds kFrame = std::chrono::milliseconds(16);
+
+}  // namespace render_thread_test
+
+// compares the throughput of rendering the frames on the UI thread against
+// pipelining them on the render thread, in the headless CPU mode (a render
+// context without a GPU context rasterizes on the CPU). the rendered frames
+// must be identical.
+TEST(RenderThreadTest, PipelinedThroughput) {
+  using namespace render_thread_test;
+
+  RenderContext context;
+
+  Scene serial_scene;
+  Pipeline serial{*serial_scene.root, context};
+  serial.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+  serial.tick(kFrame);
+
+  auto const serial_begin = std::chrono::steady_clock::now();
+
+  for (uint32_t frame = 1; frame <= kNumFrames; frame++) {
+    serial_scene.scroll(frame);
+    EXPECT_EQ(serial.tick(kFrame), BackingStoreDiff::Some);
+  }
+
+  auto const serial_duration = std::chrono::steady_clock::now() - serial_begin;
+
+  Scene pipelined_scene;
+  Pipeline pipelined{*pipelined_scene.root, context};
+  pipelined.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  std::chrono::steady_clock::duration pipelined_duration{0};
+
+  {
+    RenderThread render_thread{context};
+
+    ASSERT_EQ(pipelined.record(kFrame), BackingStoreDiff::Some);
+    render_thread.submit(pipelined.tile_cache.snapshot);
+    render_thread.wait_idle();
+
+    auto const pipelined_begin = std::chrono::steady_clock::now();
+
+    for (uint32_t frame = 1; frame <= kNumFrames; frame++) {
+      pipelined_scene.scroll(frame);
+      ASSERT_EQ(pipelined.record(kFrame), BackingStoreDiff::Some);
+      render_thread.submit(pipelined.tile_cache.snapshot);
+    }
+
+    render_thread.pause();
+
+    pipelined_duration = std::chrono::steady_clock::now() - pipelined_begin;
+
+    EXPECT_EQ(render_thread.get_num_rendered(), kNumFrames + 1);
+
+    EXPECT_EQ(
+        read_pixels(serial.tile_cache.rasterizer.backing_store_cache),
+        read_pixels(render_thread.get_rasterizer().backing_store_cache));
+  }
+
+  auto const to_us = [](std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+        .count();
+  };
+
+  std::cout << "\nserial: " << kNumFrames << " frames in "
+            << to_us(serial_duration) << "us ("
+            << to_us(serial_duration) / kNumFrames << "us/frame)\n"
+            << "pipelined: " << kNumFrames << " frames in "
+            << to_us(pipelined_duration) << "us ("
+            << to_us(pipelined_duration) / kNumFrames << "us/frame)\n"
+            << "speedup: "
+            << static_cast<double>(serial_duration.count()) /
+                   pipelined_duration.count()
+            << "x\n";
+}
+
+TEST(RenderThreadTest, SnapshotIsExchanged) {
+  using namespace render_thread_test;
+
+  RenderContext context;
+
+  Scene scene;
+  Pipeline pipeline{*scene.root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  size_t num_presented = 0;
+
+  RenderThread render_thread{context,
+                             [&num_presented](RasterCache& backing_store) {
+                               EXPECT_TRUE(backing_store.is_surface_init());
+                               num_presented++;
+                             }};
+
+  ASSERT_EQ(pipeline.record(kFrame), BackingStoreDiff::Some);
+  EXPECT_EQ(pipeline.tile_cache.snapshot.layers.size(), 1);
+
+  render_thread.submit(pipeline.tile_cache.snapshot);
+
+  // the render thread's free buffer is handed back
+  EXPECT_TRUE(pipeline.tile_cache.snapshot.layers.empty());
+
+  // nothing changed, so there's nothing to render
+  EXPECT_EQ(pipeline.record(kFrame), BackingStoreDiff::None);
+
+  scene.scroll(1);
+  ASSERT_EQ(pipeline.record(kFrame), BackingStoreDiff::Some);
+  render_thread.submit(pipeline.tile_cache.snapshot);
+
+  render_thread.pause();
+
+  EXPECT_EQ(render_thread.get_num_rendered(), 2);
+  EXPECT_EQ(num_presented, 2);
+  EXPECT_EQ(render_thread.get_rasterizer().layers.size(), 1);
+}
+
+TEST(RenderThreadTest, PauseStopsStaleTiles) {
+  using namespace render_thread_test;
+
+  RenderContext context;
+
+  Scene scene;
+  Pipeline pipeline{*scene.root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  std::atomic<size_t> num_presented{0};
+
+  RenderThread render_thread{
+      context, [&num_presented](RasterCache&) { num_presented++; }};
+
+  // every frame is already over its deadline, so only a tile is rasterized
+  // per iteration and the others are carried over
+  render_thread.set_frame_budget(std::chrono::nanoseconds(0));
+
+  ASSERT_EQ(pipeline.record(kFrame), BackingStoreDiff::Some);
+  render_thread.submit(pipeline.tile_cache.snapshot);
+
+  render_thread.pause();
+
+  EXPECT_EQ(render_thread.get_num_rendered(), 1);
+  EXPECT_TRUE(render_thread.get_rasterizer().has_stale_tiles());
+
+  size_t const num_paused_presents = num_presented;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  // the stale tiles aren't resumed (nor presented) whilst paused
+  EXPECT_EQ(num_presented, num_paused_presents);
+  EXPECT_TRUE(render_thread.get_rasterizer().has_stale_tiles());
+
+  render_thread.resume();
+
+  bool has_stale_tiles = true;
+
+  for (size_t i = 0; i < 1000 && has_stale_tiles; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    render_thread.pause();
+    has_stale_tiles = render_thread.get_rasterizer().has_stale_tiles();
+    render_thread.resume();
+  }
+
+  EXPECT_FALSE(has_stale_tiles);
+  EXPECT_GT(num_presented, num_paused_presents);
+}
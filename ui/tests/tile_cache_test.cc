@@ -1,7 +1,12 @@
 #include "vlk/ui/tile_cache.h"
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "mock_widgets.h"
+#include "vlk/ui/pipeline.h"
 
 TEST(TileCacheTest, Basic) {
   RenderContext context;
@@ -31,7 +36,7 @@ TEST(TileCacheTest, Basic) {
 
   // TODO(lamarrr): layout tree must be ticked and view tree must be ticked
   // before ticking the tile_cache else we get invalid results
-  cache.build(view_tree.root_view, context);
+  cache.build(view_tree, context);
 
   EXPECT_EQ(cache.context, &context);
   EXPECT_EQ(cache.entries.size(), 5);
@@ -49,11 +54,12 @@ TEST(TileCacheTest, Basic) {
   EXPECT_EQ(cache.backing_store_physical_extent, (Extent{2080, 1440}));
   EXPECT_TRUE(cache.backing_store_physical_extent_changed);
 
-  Extent const self_extent = view_tree.root_view.layout_node->self_extent;
+  Extent const self_extent = view_tree.root_view().layout_node->self_extent;
 
   cache.tick(std::chrono::nanoseconds(0));
 
-  Extent const total_tile_extent = cache.cache_tiles.physical_extent();
+  Extent const total_tile_extent =
+      cache.rasterizer.layers[0].cache_tiles.physical_extent();
 
   EXPECT_LE(self_extent.width, total_tile_extent.width);
   EXPECT_LE(self_extent.height, total_tile_extent.height);
@@ -62,6 +68,265 @@ TEST(TileCacheTest, Basic) {
   EXPECT_FALSE(cache.backing_store_physical_extent_changed);
   // TODO(lamarrr): EXPECT_TRUE(cache.any_tile_dirty);
 
-  std::cout << "\nbytes estimate: " << cache.cache_tiles.storage_size_estimate()
+  std::cout << "\nbytes estimate: "
+            << cache.rasterizer.layers[0].cache_tiles.storage_size_estimate()
             << " bytes\n";
 }
+
+struct CountingSized : public Widget {
+  CountingSized(Extent extent, size_t& num_draws)
+      : Widget{WidgetType::Render}, num_draws_{&num_draws} {
+    Widget::init_is_flex(false);
+    Widget::update_self_extent(SelfExtent::absolute(extent));
+  }
+
+  ~CountingSized() override {}
+
+  virtual void draw(Canvas&) override { (*num_draws_)++; }
+
+  size_t* num_draws_;
+};
+
+struct ScrollingView : public Widget {
+  ScrollingView(std::vector<Widget*> children, bool is_layer)
+      : Widget{WidgetType::View}, children_{std::move(children)} {
+    Widget::init_is_flex(true);
+    Widget::init_is_layer(is_layer);
+    Widget::update_children(children_);
+    Widget::update_flex(Flex{Direction::Column, Wrap::None, MainAlign::Start,
+                             CrossAlign::Start, Fit::Shrink, Fit::Expand});
+    Widget::update_self_extent(SelfExtent::relative(1.0f, 1.0f));
+    Widget::update_view_extent(ViewExtent{
+        Constrain::relative(1.0f), Constrain::unbounded(stx::u32_max)});
+  }
+
+  ~ScrollingView() override {}
+
+  std::vector<Widget*> children_;
+};
+
+// returns the number of widget draw calls made while scrolling
+size_t benchmark_scrolling(bool is_layer, size_t num_frames) {
+  size_t num_draws = 0;
+
+  std::vector<std::unique_ptr<CountingSized>> items;
+  std::vector<Widget*> children;
+
+  for (size_t i = 0; i < 200; i++) {
+    items.emplace_back(new CountingSized{Extent{400, 40}, num_draws});
+    children.push_back(items.back().get());
+  }
+
+  ScrollingView scrolling_view{children, is_layer};
+  MockView root{&scrolling_view};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  // settle the initial build, layout, and rasterization
+  pipeline.tick(std::chrono::nanoseconds(0));
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  num_draws = 0;
+
+  auto const begin = std::chrono::steady_clock::now();
+
+  for (size_t frame = 1; frame <= num_frames; frame++) {
+    scrolling_view.update_view_offset(ViewOffset::scroll(0, frame * 8));
+    pipeline.tick(std::chrono::milliseconds(16));
+  }
+
+  auto const duration = std::chrono::steady_clock::now() - begin;
+
+  std::cout << "\n"
+            << (is_layer ? "layer" : "non-layer view") << ": "
+            << num_frames << " scroll frames in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                   .count()
+            << "us, " << num_draws << " widget draw calls\n";
+
+  return num_draws;
+}
+
+TEST(TileCacheTest, ScrollLayerBenchmark) {
+  // scrolling within the focus margin of the layer's tiles
+  EXPECT_EQ(benchmark_scrolling(true, 20), 0);
+  EXPECT_GT(benchmark_scrolling(false, 20), 0);
+}
+
+TEST(TileCacheTest, LayerEffects) {
+  size_t num_draws = 0;
+
+  CountingSized item{Extent{400, 40}, num_draws};
+  ScrollingView layer_view{{&item}, true};
+  MockView root{&layer_view};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  pipeline.tick(std::chrono::nanoseconds(0));
+  pipeline.tick(std::chrono::nanoseconds(0));
+
+  EXPECT_GT(num_draws, 0);
+  num_draws = 0;
+
+  EXPECT_EQ(pipeline.tick(std::chrono::nanoseconds(0)), BackingStoreDiff::None);
+
+  // fade, slide, and scale the layer
+  for (size_t frame = 1; frame <= 10; frame++) {
+    float const t = frame / 10.0f;
+    layer_view.update_layer_effects(
+        LayerEffects{}
+            .with_opacity(1.0f - t * 0.5f)
+            .with_transform(Transform2D::scaling(1.0f + t, 1.0f + t)
+                                .then(Transform2D::translation(t * 40, 0)))
+            .with_clip(stx::Some(IRect{IOffset{0, 0}, Extent{200, 40}})));
+    EXPECT_EQ(pipeline.tick(std::chrono::milliseconds(16)),
+              BackingStoreDiff::Some);
+  }
+
+  EXPECT_EQ(num_draws, 0);
+}
+
+TEST(TileCacheTest, EntryOrder) {
+  constexpr size_t kNumWidgets = 60'000;
+
+  std::vector<std::unique_ptr<MockSized>> items;
+  std::vector<Widget*> children;
+
+  items.reserve(kNumWidgets);
+  children.reserve(kNumWidgets);
+
+  for (size_t i = 0; i < kNumWidgets; i++) {
+    // a few distinct z-indices, interleaved across the tree
+    if (i % 7 == 0) {
+      items.emplace_back(new MockSized{
+          Extent{8, 8}, stx::Some<ZIndex>(static_cast<ZIndex>(i % 5))});
+    } else {
+      items.emplace_back(new MockSized{Extent{8, 8}});
+    }
+
+    children.push_back(items.back().get());
+  }
+
+  ScrollingView scrolling_view{children, false};
+  MockView root{&scrolling_view};
+
+  LayoutTree layout_tree;
+  layout_tree.allot_extent(Extent{1920, 1080});
+  layout_tree.build(root);
+  layout_tree.tick(std::chrono::nanoseconds(0));
+
+  ViewTree view_tree;
+  view_tree.build(layout_tree.root_node);
+  view_tree.tick(std::chrono::nanoseconds(0));
+
+  RenderContext context;
+  TileCache cache;
+
+  auto const begin = std::chrono::steady_clock::now();
+  cache.build(view_tree, context);
+  auto const duration = std::chrono::steady_clock::now() - begin;
+
+  ASSERT_EQ(cache.entries.size(), kNumWidgets);
+
+  // ascending z-index, and tree order amongst equal z-indices
+  for (size_t i = 1; i < cache.entries.size(); i++) {
+    TileCache::Entry const& previous = cache.entries[i - 1];
+    TileCache::Entry const& entry = cache.entries[i];
+    EXPECT_TRUE(previous.z_index < entry.z_index ||
+                (previous.z_index == entry.z_index &&
+                 previous.view_entry < entry.view_entry));
+  }
+
+  for (size_t id = 0; id < cache.entries.size(); id++) {
+    EXPECT_EQ(cache.entry_ids[cache.entries[id].view_entry], id);
+  }
+
+  std::cout << "\nbuilt " << kNumWidgets << " tile cache entries in "
+            << std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                   .count()
+            << "us\n";
+}
+
+TEST(TileCacheTest, ProgressiveRasterization) {
+  size_t num_draws = 0;
+
+  std::vector<std::unique_ptr<CountingSized>> items;
+  std::vector<Widget*> children;
+
+  for (size_t i = 0; i < 100; i++) {
+    items.emplace_back(new CountingSized{Extent{800, 40}, num_draws});
+    children.push_back(items.back().get());
+  }
+
+  ScrollingView scrolling_view{children, false};
+  MockView root{&scrolling_view};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  // every frame is already over its deadline, so only a tile is rasterized
+  // per frame
+  pipeline.tile_cache.rasterizer.frame_budget = std::chrono::nanoseconds(0);
+
+  EXPECT_EQ(pipeline.tick(std::chrono::nanoseconds(0)), BackingStoreDiff::Some);
+
+  TileRasterizer& rasterizer = pipeline.tile_cache.rasterizer;
+  RasterCacheTiles& tiles = rasterizer.layers[0].cache_tiles;
+
+  auto const num_rasterized = [&tiles]() {
+    size_t num = 0;
+    for (RasterCache const& tile : tiles.get_tiles()) {
+      if (tile.is_surface_init()) num++;
+    }
+    return num;
+  };
+
+  // the tile at the center of the viewport is rasterized first
+  EXPECT_EQ(num_rasterized(), 1);
+  EXPECT_TRUE(tiles.tile_at_index(1, 1).is_surface_init());
+  EXPECT_TRUE(rasterizer.has_stale_tiles());
+
+  // nothing is left to record, the stale tiles are the render stage's
+  EXPECT_TRUE(pipeline.is_idle());
+
+  // the remaining tiles are carried over to the next frames
+  for (size_t frame = 0; frame < 100 && rasterizer.has_stale_tiles();
+       frame++) {
+    EXPECT_EQ(pipeline.tick(std::chrono::milliseconds(16)),
+              BackingStoreDiff::Some);
+  }
+
+  EXPECT_FALSE(rasterizer.has_stale_tiles());
+  EXPECT_EQ(num_rasterized(), tiles.get_tiles().size());
+  EXPECT_TRUE(pipeline.is_idle());
+  EXPECT_EQ(pipeline.tick(std::chrono::milliseconds(16)),
+            BackingStoreDiff::None);
+
+  // the re-recorded tiles keep their previous content until they are
+  // re-rasterized
+  scrolling_view.update_view_offset(ViewOffset::scroll(0, 40));
+  pipeline.tick(std::chrono::milliseconds(16));
+
+  EXPECT_EQ(num_rasterized(), tiles.get_tiles().size());
+  EXPECT_TRUE(rasterizer.has_stale_tiles());
+
+  size_t const num_stale = rasterizer.get_num_stale_tiles();
+  num_draws = 0;
+
+  // without re-recording
+  pipeline.tick(std::chrono::milliseconds(16));
+
+  EXPECT_EQ(num_draws, 0);
+  EXPECT_EQ(rasterizer.get_num_stale_tiles(), num_stale - 1);
+
+  // an unbounded budget rasterizes all of the stale tiles at once
+  rasterizer.frame_budget = TileRasterizer::kNoBudget;
+  pipeline.tick(std::chrono::milliseconds(16));
+
+  EXPECT_FALSE(rasterizer.has_stale_tiles());
+}
@@ -90,67 +90,157 @@ TEST(ViewTree, Hierarchy_And_Scrolling) {
 
   view_tree.tick(std::chrono::nanoseconds(0));
 
-  EXPECT_EQ(view_tree.root_view.layout_node->widget, &vroot);
+  ViewTree::View const& root_view = view_tree.root_view();
 
-  EXPECT_EQ(view_tree.root_view.screen_offset.x, 0);
-  EXPECT_EQ(view_tree.root_view.screen_offset.y, 0);
-  EXPECT_EQ(view_tree.root_view.effective_parent_view_offset.x, 0);
-  EXPECT_EQ(view_tree.root_view.effective_parent_view_offset.y, 0);
-  EXPECT_EQ(view_tree.root_view.parent, nullptr);
-  EXPECT_EQ(view_tree.root_view.z_index, 0);
+  EXPECT_EQ(root_view.layout_node->widget, &vroot);
 
-  EXPECT_EQ(view_tree.root_view.entries.size(), 1);
-  EXPECT_EQ(view_tree.root_view.subviews.size(), 2);
+  EXPECT_EQ(root_view.screen_offset.x, 0);
+  EXPECT_EQ(root_view.screen_offset.y, 0);
+  EXPECT_EQ(root_view.effective_parent_view_offset.x, 0);
+  EXPECT_EQ(root_view.effective_parent_view_offset.y, 0);
+  EXPECT_EQ(root_view.parent, ViewTree::kNoView);
+  EXPECT_EQ(root_view.z_index, 0);
+
+  EXPECT_EQ(root_view.entries_end - root_view.entries_begin, 1);
+  EXPECT_EQ(view_tree.views.size(), 3);
+  EXPECT_EQ(root_view.subtree_end, 3);
+  EXPECT_EQ(view_tree.views[1].parent, 0);
+  EXPECT_EQ(view_tree.views[2].parent, 0);
 
   {
     // vroot
-    EXPECT_EQ(view_tree.root_view.layout_node->widget, &vroot);
-    auto screen_offset = view_tree.root_view.entries[0].screen_offset;
+    EXPECT_EQ(root_view.layout_node->widget, &vroot);
+    auto screen_offset =
+        view_tree.entries[root_view.entries_begin].screen_offset;
     EXPECT_EQ(screen_offset.x, 10);
     EXPECT_EQ(screen_offset.y, 0);
   }
 
   {
     // v1
-    EXPECT_EQ(view_tree.root_view.subviews[0].layout_node->widget, &v1);
-    auto screen_offset = view_tree.root_view.subviews[0].screen_offset;
+    EXPECT_EQ(view_tree.views[1].layout_node->widget, &v1);
+    auto screen_offset = view_tree.views[1].screen_offset;
     EXPECT_EQ(screen_offset.x, 10);
     EXPECT_EQ(screen_offset.y, 0);
   }
 
   // v1
-  view_tree.root_view.subviews[0].layout_node->widget->update_view_offset(
-      ViewOffset{
-          Constrain{0.0f, 90, stx::i64_min, stx::i64_max, Clamp{0.0f, 200.0f}},
-          Constrain{0.0f}});
+  view_tree.views[1].layout_node->widget->update_view_offset(ViewOffset{
+      Constrain{0.0f, 90, stx::i64_min, stx::i64_max, Clamp{0.0f, 200.0f}},
+      Constrain{0.0f}});
 
   SubsystemsContext context;
+  WidgetDirtyQueues dirty_queues;
 
-  WidgetSystemProxy::tick(*view_tree.root_view.subviews[0].layout_node->widget,
+  WidgetSystemProxy::bind_dirty_queues(v1, &dirty_queues);
+  WidgetSystemProxy::tick(*view_tree.views[1].layout_node->widget,
                           std::chrono::nanoseconds(0), context);
 
+  ASSERT_EQ(dirty_queues.view_offset_dirty.size(), 1);
+  EXPECT_EQ(dirty_queues.view_offset_dirty[0], 1);
+
+  view_tree.mark_views_dirty(dirty_queues.view_offset_dirty);
   view_tree.tick(std::chrono::nanoseconds(0));
 
   {
     // v1
-    auto screen_offset = view_tree.root_view.subviews[0].screen_offset;
+    auto screen_offset = view_tree.views[1].screen_offset;
     EXPECT_EQ(screen_offset.x, 10);
     EXPECT_EQ(screen_offset.y, 0);
   }
 
   {
     // f1
-    EXPECT_EQ(view_tree.root_view.subviews[0].entries[0].layout_node->widget,
-              &f1);
-    auto screen_offset =
-        view_tree.root_view.subviews[0].entries[0].screen_offset;
-    EXPECT_EQ(screen_offset.x, 100);
-    EXPECT_EQ(screen_offset.y, 0);
+    ViewTree::Entry const& f1_entry =
+        view_tree.entries[view_tree.views[1].entries_begin];
+    EXPECT_EQ(f1_entry.layout_node->widget, &f1);
+    EXPECT_EQ(f1_entry.parent, 1);
+    EXPECT_EQ(f1_entry.screen_offset.x, 100);
+    EXPECT_EQ(f1_entry.screen_offset.y, 0);
   }
 }
 
 namespace view_test {
 
+struct MockSizedView : public Widget {
+  MockSizedView(Widget* child, Extent extent, Extent content_extent)
+      : Widget{WidgetType::View} {
+    child_ = child;
+    Widget::init_is_flex(true);
+    Widget::update_children(stx::Span<Widget*>(&child_, 1));
+    Widget::update_flex(Flex{});
+    Widget::update_self_extent(SelfExtent{Constrain::absolute(extent.width),
+                                          Constrain::absolute(extent.height)});
+    Widget::update_view_extent(
+        ViewExtent{Constrain::absolute(content_extent.width),
+                   Constrain::absolute(content_extent.height)});
+    Widget::update_padding(Padding{});
+  }
+
+  ~MockSizedView() override {
+    // no freeing
+  }
+
+  Widget* child_;
+};
+
+}  // namespace view_test
+
+TEST(ViewTree, NestedClips) {
+  using namespace view_test;
+
+  auto w = MockSized{Extent{400, 400}};
+  auto inner = MockSizedView{&w, Extent{100, 100}, Extent{400, 400}};
+  auto outer = MockSizedView{&inner, Extent{200, 200}, Extent{400, 400}};
+  auto vroot = MockView{&outer};
+
+  LayoutTree layout_tree;
+  layout_tree.allot_extent(Extent{1920, 1080});
+  layout_tree.build(vroot);
+
+  ViewTree view_tree;
+  view_tree.build(layout_tree.root_node);
+
+  layout_tree.tick(std::chrono::nanoseconds(0));
+
+  outer.update_view_offset(ViewOffset::scroll(0, 50));
+
+  view_tree.tick(std::chrono::nanoseconds(0));
+
+  ASSERT_EQ(view_tree.views.size(), 3);
+  ASSERT_EQ(view_tree.entries.size(), 1);
+
+  ViewTree::View const& inner_view = view_tree.views[2];
+  ViewTree::Entry const& entry = view_tree.entries[0];
+
+  EXPECT_EQ(inner_view.layout_node->widget, &inner);
+  EXPECT_EQ(inner_view.parent, 1);
+  EXPECT_EQ(inner_view.screen_offset, (IOffset{0, -50}));
+  EXPECT_EQ(inner_view.clip_rect, (IRect{IOffset{0, 0}, Extent{100, 50}}));
+
+  EXPECT_EQ(entry.layout_node->widget, &w);
+  EXPECT_EQ(entry.parent, 2);
+  EXPECT_EQ(entry.screen_offset, (IOffset{0, -50}));
+  EXPECT_EQ(entry.clip_rect, (IRect{IOffset{0, 0}, Extent{100, 50}}));
+
+  // only the inner view's subtree is updated
+  inner.update_view_offset(ViewOffset::scroll(30, 0));
+
+  SubsystemsContext context;
+  WidgetDirtyQueues dirty_queues;
+  WidgetSystemProxy::bind_dirty_queues(inner, &dirty_queues);
+  WidgetSystemProxy::tick(inner, std::chrono::nanoseconds(0), context);
+
+  view_tree.mark_views_dirty(dirty_queues.view_offset_dirty);
+  view_tree.tick(std::chrono::nanoseconds(0));
+
+  EXPECT_EQ(inner_view.screen_offset, (IOffset{0, -50}));
+  EXPECT_EQ(entry.screen_offset, (IOffset{-30, -50}));
+  EXPECT_EQ(entry.clip_rect, (IRect{IOffset{0, 0}, Extent{100, 50}}));
+}
+
+namespace view_test {
+
 struct Body : public Widget {
   Body(Widget* child, ViewFit const& view_fit) {
     children_[0] = child;
@@ -0,0 +1,97 @@
+#include "vlk/ui/widgets/grid.h"
+
+#include "gtest/gtest.h"
+#include "mock_widgets.h"
+#include "vlk/ui/layout_tree.h"
+
+using namespace vlk::ui;
+using namespace vlk;
+
+TEST(GridTest, UniformCells) {
+  size_t num_built = 0;
+
+  Grid grid{[&](size_t) -> Widget* {
+              num_built++;
+              return new MockSized{Extent{100, 100}};
+            },
+            GridProps{}
+                .columns(4)
+                .cell_extent(Extent{100, 100})
+                .item_count(100'000)
+                .cache_extent(0)};
+
+  EXPECT_EQ(grid.get_num_rows(), 25'000);
+  EXPECT_EQ(grid.get_cell_rect(5), (Rect{Offset{100, 100}, Extent{100, 100}}));
+  EXPECT_EQ(grid.get_cell_rect(99'999),
+            (Rect{Offset{300, 2'499'900}, Extent{100, 100}}));
+
+  SubsystemsContext context;
+  LayoutTree tree;
+  tree.allot_extent(Extent{400, 300});
+
+  WidgetSystemProxy::tick(grid, std::chrono::nanoseconds(0), context);
+  tree.build(grid);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  WidgetSystemProxy::tick(grid, std::chrono::nanoseconds(0), context);
+  EXPECT_EQ(grid.get_range_begin(), 0);
+  EXPECT_EQ(grid.get_range_end(), 12);
+  EXPECT_EQ(num_built, 12);
+
+  tree.build(grid);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  EXPECT_EQ(tree.root_node.children.size(), 12);
+  EXPECT_EQ(tree.root_node.children[5].parent_offset, (Offset{100, 100}));
+  EXPECT_EQ(tree.root_node.view_extent, (Extent{400, 2'500'000}));
+
+  grid.scroll_to(1'000'000);
+  WidgetSystemProxy::tick(grid, std::chrono::nanoseconds(0), context);
+
+  EXPECT_EQ(grid.get_range_begin(), 40'000);
+  EXPECT_EQ(grid.get_range_end(), 40'012);
+  EXPECT_EQ(grid.get_item(0), nullptr);
+  EXPECT_NE(grid.get_item(40'000), nullptr);
+
+  tree.build(grid);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  EXPECT_EQ(tree.root_node.children[0].parent_offset, (Offset{0, 1'000'000}));
+}
+
+TEST(GridTest, SpanningCells) {
+  Grid grid{[](size_t) -> Widget* { return new MockSized{Extent{10, 10}}; },
+            GridProps{}
+                .columns(4)
+                .cell_extent(Extent{10, 10})
+                .spacing(2)
+                .item_count(6)
+                .cache_extent(0),
+            [](size_t index) {
+              return index == 0 ? GridSpan{2, 2} : GridSpan{};
+            }};
+
+  // [0 0 1 2]
+  // [0 0 3 4]
+  // [5 . . .]
+  EXPECT_EQ(grid.get_num_rows(), 3);
+  EXPECT_EQ(grid.get_cell_rect(0), (Rect{Offset{0, 0}, Extent{22, 22}}));
+  EXPECT_EQ(grid.get_cell_rect(2), (Rect{Offset{36, 0}, Extent{10, 10}}));
+  EXPECT_EQ(grid.get_cell_rect(3), (Rect{Offset{24, 12}, Extent{10, 10}}));
+  EXPECT_EQ(grid.get_cell_rect(5), (Rect{Offset{0, 24}, Extent{10, 10}}));
+
+  SubsystemsContext context;
+  LayoutTree tree;
+  tree.allot_extent(Extent{46, 10});
+
+  tree.build(grid);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  // the second row is visible, the spanning item starting on the first row
+  // is still materialized
+  grid.scroll_to(12);
+  WidgetSystemProxy::tick(grid, std::chrono::nanoseconds(0), context);
+
+  EXPECT_EQ(grid.get_range_begin(), 0);
+  EXPECT_EQ(grid.get_range_end(), 5);
+}
@@ -0,0 +1,153 @@
+#include "vlk/ui/widgets/label.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "include/core/SkPictureRecorder.h"
+#include "mock_widgets.h"
+#include "vlk/ui/canvas.h"
+#include "vlk/ui/pipeline.h"
+#include "vlk/ui/widgets/text.h"
+
+namespace label_test {
+
+constexpr size_t kNumLabels = 2000;
+
+bool has_default_typeface() {
+  return SharedFontCollection::unbound().get_default_typeface() != nullptr;
+}
+
+void draw(Widget& widget, Extent extent) {
+  SkPictureRecorder recorder;
+  SkCanvas* sk_canvas =
+      recorder.beginRecording(SkRect::MakeWH(extent.width, extent.height));
+  Canvas canvas{*sk_canvas, extent, Dpr{}};
+  widget.draw(canvas);
+  recorder.finishRecordingAsPicture();
+}
+
+}  // namespace label_test
+
+TEST(LabelTest, SimpleText) {
+  EXPECT_TRUE(impl::is_simple_text(""));
+  EXPECT_TRUE(impl::is_simple_text("Save changes"));
+  EXPECT_TRUE(impl::is_simple_text("Größe: 12 € — naïve café"));
+  EXPECT_TRUE(impl::is_simple_text("Привет, мир"));
+
+  // line breaks and tabs
+  EXPECT_FALSE(impl::is_simple_text("first\nsecond"));
+  EXPECT_FALSE(impl::is_simple_text("name\tvalue"));
+  // combining marks, right-to-left and complex scripts
+  EXPECT_FALSE(impl::is_simple_text("e\xCC\x81"));
+  EXPECT_FALSE(impl::is_simple_text("مرحبا"));
+  EXPECT_FALSE(impl::is_simple_text("नमस्ते"));
+  // zero-width joiner
+  EXPECT_FALSE(impl::is_simple_text("a\xE2\x80\x8D" "b"));
+  // invalid UTF-8
+  EXPECT_FALSE(impl::is_simple_text("\xC3"));
+}
+
+TEST(LabelTest, FallsBackToParagraph) {
+  using namespace label_test;
+
+  if (!has_default_typeface()) GTEST_SKIP() << "no system typeface available";
+
+  Label label{"Save changes"};
+  EXPECT_TRUE(label.is_fast_path());
+
+  Extent const extent = label.trim(Extent{400, 100});
+  EXPECT_GT(extent.height, 0);
+
+  label.update_text("first line\nsecond line");
+  EXPECT_FALSE(label.is_fast_path());
+  EXPECT_GT(label.trim(Extent{400, 100}).height, extent.height);
+
+  label.update_text("Save changes");
+  label.update_props(ParagraphProps{}.underlined());
+  EXPECT_FALSE(label.is_fast_path());
+
+  label.update_props(ParagraphProps{}.direction(TextDirection::Rtl));
+  EXPECT_FALSE(label.is_fast_path());
+
+  // wraps on the paragraph engine once it doesn't fit on a single line
+  label.update_props(ParagraphProps{});
+  EXPECT_TRUE(label.is_fast_path());
+  EXPECT_GT(label.trim(Extent{10, 100}).height, extent.height);
+  draw(label, Extent{10, 100});
+}
+
+TEST(LabelTest, GlyphsAreCached) {
+  using namespace label_test;
+
+  if (!has_default_typeface()) GTEST_SKIP() << "no system typeface available";
+
+  GlyphCache& glyph_cache = SharedFontCollection::unbound().get_glyph_cache();
+  glyph_cache.clear();
+
+  std::vector<std::unique_ptr<Label>> labels;
+
+  for (size_t i = 0; i < kNumLabels; i++) {
+    labels.emplace_back(new Label{"Label #" + std::to_string(i)});
+  }
+
+  // "Label #" and the digits
+  GlyphCache::Stats const stats = glyph_cache.get_stats();
+  EXPECT_EQ(stats.num_fonts, 1);
+  EXPECT_EQ(stats.num_glyphs_resolved, 17);
+}
+
+// compares measuring and drawing single-line labels on the fast path against
+// the paragraph engine
+TEST(LabelTest, LabelBenchmark) {
+  using namespace label_test;
+
+  if (!has_default_typeface()) GTEST_SKIP() << "no system typeface available";
+
+  RenderContext context;
+  MockSized child{Extent{20, 20}};
+  MockView root{&child};
+  Pipeline pipeline{root, context};
+  pipeline.font_collection->set_shaping_synchronous(true);
+
+  Extent const extent{400, 40};
+
+  auto const text_begin = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < kNumLabels; i++) {
+    Text text{"Label #" + std::to_string(i)};
+    text.tick(std::chrono::milliseconds(16), pipeline.context);
+    EXPECT_GT(text.trim(extent).height, 0);
+    draw(text, extent);
+  }
+
+  auto const text_duration = std::chrono::steady_clock::now() - text_begin;
+
+  auto const label_begin = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < kNumLabels; i++) {
+    Label label{"Label #" + std::to_string(i)};
+    EXPECT_TRUE(label.is_fast_path());
+    EXPECT_GT(label.trim(extent).height, 0);
+    draw(label, extent);
+  }
+
+  auto const label_duration = std::chrono::steady_clock::now() - label_begin;
+
+  auto const to_us = [](std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+        .count();
+  };
+
+  std::cout << "\ntext: " << kNumLabels << " labels in "
+            << to_us(text_duration) << "us\n"
+            << "label: " << kNumLabels << " labels in "
+            << to_us(label_duration) << "us\n"
+            << "speedup: "
+            << static_cast<double>(text_duration.count()) /
+                   label_duration.count()
+            << "x\n";
+}
@@ -0,0 +1,195 @@
+#include "vlk/ui/widgets/list.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "mock_widgets.h"
+#include "vlk/ui/layout_tree.h"
+#include "vlk/ui/pipeline.h"
+
+using namespace vlk::ui;
+using namespace vlk;
+
+TEST(VirtualListTest, MaterializesVisibleRange) {
+  size_t num_built = 0;
+
+  VirtualList list{[&](size_t) -> Widget* {
+                     num_built++;
+                     return new MockSized{Extent{100, 20}};
+                   },
+                   VirtualListProps{}
+                       .item_count(2'000'000)
+                       .item_extent_estimate(20)
+                       .cache_extent(40)};
+
+  SubsystemsContext context;
+  LayoutTree tree;
+  tree.allot_extent(Extent{400, 200});
+
+  // not laid out yet, only the cache extent is materialized
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+  EXPECT_EQ(list.get_range_begin(), 0);
+  EXPECT_EQ(list.get_range_end(), 2);
+
+  tree.build(list);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  EXPECT_EQ(list.get_layout_extent(), (Extent{400, 200}));
+
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+  EXPECT_EQ(list.get_range_begin(), 0);
+  EXPECT_EQ(list.get_range_end(), 12);
+  EXPECT_EQ(num_built, 12);
+  // leading spacer + items + trailing spacer
+  EXPECT_EQ(list.get_children().size(), 14);
+
+  tree.build(list);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  list.scroll_to(1'000'000);
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+
+  EXPECT_EQ(list.get_item_extent_estimate(), 20);
+  EXPECT_EQ(list.get_range_begin(), 49'998);
+  EXPECT_EQ(list.get_range_end(), 50'012);
+  EXPECT_EQ(list.get_item(0), nullptr);
+  EXPECT_NE(list.get_item(50'000), nullptr);
+  EXPECT_EQ(list.get_children().size(), 16);
+  EXPECT_EQ(list.get_children()[0]->get_self_extent(),
+            SelfExtent::absolute(Extent{0, 49'998 * 20}));
+
+  tree.build(list);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  // layout, and therefore memory, only covers the materialized range
+  EXPECT_EQ(tree.root_node.children.size(), 16);
+  EXPECT_EQ(tree.root_node.children[1].parent_offset.y, 49'998 * 20);
+}
+
+TEST(VirtualListTest, SettledListLeavesActiveSet) {
+  VirtualList list{
+      [](size_t) -> Widget* { return new MockSized{Extent{100, 20}}; },
+      VirtualListProps{}.item_count(10'000).item_extent_estimate(20)};
+  MockView root{&list};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  auto const settle = [&]() {
+    for (size_t i = 0; i < 8; i++) {
+      pipeline.tick(std::chrono::milliseconds(16));
+    }
+  };
+
+  settle();
+
+  // only ticked whilst its materialized range could move
+  EXPECT_FALSE(list.is_subscribed_to_ticks());
+  EXPECT_TRUE(pipeline.dirty_queues.active_widgets.empty());
+  EXPECT_GT(list.get_range_end(), 0);
+
+  list.scroll_to(20'000);
+  EXPECT_TRUE(list.is_subscribed_to_ticks());
+
+  settle();
+
+  // the default cache extent is 256
+  EXPECT_EQ(list.get_range_begin(), (20'000 - 256) / 20);
+  EXPECT_FALSE(list.is_subscribed_to_ticks());
+  EXPECT_TRUE(pipeline.dirty_queues.active_widgets.empty());
+}
+
+TEST(VirtualListTest, BuilderEndsList) {
+  VirtualList list{[](size_t index) -> Widget* {
+                     if (index >= 5) return nullptr;
+                     return new MockSized{Extent{100, 20}};
+                   },
+                   VirtualListProps{}
+                       .item_count(100)
+                       .item_extent_estimate(20)
+                       .cache_extent(40)};
+
+  SubsystemsContext context;
+  LayoutTree tree;
+  tree.allot_extent(Extent{400, 200});
+
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+  tree.build(list);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+
+  // the materialized range stops at the end signalled by the builder, and the
+  // props are left as they were
+  EXPECT_EQ(list.get_range_end(), 5);
+  EXPECT_EQ(list.get_item_count(), 5);
+  EXPECT_EQ(list.get_props().item_count(), 100);
+  EXPECT_EQ(list.get_extent_estimate(), 5 * 20);
+  EXPECT_EQ(list.get_children().size(), 7);
+  EXPECT_EQ(list.get_children().back()->get_self_extent(),
+            SelfExtent::absolute(Extent{0, 0}));
+
+  // settled at the end of the list
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+  EXPECT_FALSE(list.is_subscribed_to_ticks());
+
+  // updating the props re-discovers the end of the list
+  list.update_props(list.get_props());
+  EXPECT_EQ(list.get_item_count(), 100);
+
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+  EXPECT_EQ(list.get_range_end(), 5);
+  EXPECT_EQ(list.get_item_count(), 5);
+}
+
+TEST(VirtualListTest, RecyclesItems) {
+  size_t num_built = 0;
+  size_t num_recycled = 0;
+
+  VirtualList list{[&](size_t) -> Widget* {
+                     num_built++;
+                     return new MockSized{Extent{100, 20}};
+                   },
+                   VirtualListProps{}
+                       .item_count(10'000)
+                       .item_extent_estimate(20)
+                       .cache_extent(0),
+                   [&](Widget&, size_t) {
+                     num_recycled++;
+                     return true;
+                   }};
+
+  SubsystemsContext context;
+  LayoutTree tree;
+  tree.allot_extent(Extent{400, 200});
+
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+  tree.build(list);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+  EXPECT_EQ(list.get_range_end(), 10);
+  EXPECT_EQ(num_built, 10);
+
+  Widget* const first = list.get_item(0);
+
+  tree.build(list);
+  tree.tick(std::chrono::nanoseconds(0));
+
+  list.scroll_to(1'000);
+  WidgetSystemProxy::tick(list, std::chrono::nanoseconds(0), context);
+
+  // the items that left the range are re-bound instead of being rebuilt
+  EXPECT_EQ(list.get_range_begin(), 50);
+  EXPECT_EQ(list.get_range_end(), 60);
+  EXPECT_EQ(num_built, 10);
+  EXPECT_EQ(num_recycled, 10);
+
+  bool reused_first = false;
+  for (size_t index = 50; index < 60; index++) {
+    if (list.get_item(index) == first) reused_first = true;
+  }
+
+  EXPECT_TRUE(reused_first);
+}
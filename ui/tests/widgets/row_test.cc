@@ -236,7 +236,7 @@ TEST(RowTest, BasicTest) {
     pipeline.tick(std::chrono::nanoseconds(0));
     pipeline.tile_cache.scroll_backing_store_logical(
         IOffset{0, (int64_t)mul * i * 0});
-    pipeline.tile_cache.backing_store_cache.save_pixels_to_file(
+    pipeline.tile_cache.rasterizer.backing_store_cache.save_pixels_to_file(
         "./ui_output_row_" + std::to_string(i));
     VLK_LOG("written tick: {}", i);
   }
@@ -0,0 +1,101 @@
+#include "vlk/ui/widgets/text_document.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "include/core/SkPictureRecorder.h"
+#include "vlk/ui/canvas.h"
+
+namespace text_document_test {
+
+constexpr size_t kNumLines = 100'000;
+
+std::string make_log(size_t num_lines) {
+  std::string log;
+  for (size_t i = 0; i < num_lines; i++) {
+    if (i != 0) log += '\n';
+    log += "[INFO] request #" + std::to_string(i) + " completed in 12ms";
+  }
+  return log;
+}
+
+// records the part of the document visible through a 800x600 viewport
+// scrolled to `scroll_y`
+void draw_viewport(TextDocument& document, Extent extent, float scroll_y) {
+  SkPictureRecorder recorder;
+  SkCanvas* sk_canvas = recorder.beginRecording(
+      SkRect::MakeWH(extent.width, extent.height));
+  Canvas canvas{*sk_canvas, extent, Dpr{},
+                VRect{VOffset{0.0f, scroll_y}, VExtent{800.0f, 600.0f}}};
+  document.draw(canvas);
+  recorder.finishRecordingAsPicture();
+}
+
+}  // namespace text_document_test
+
+TEST(TextDocumentTest, SplitsIntoBlocks) {
+  TextDocument document{"a\nb\n\nc"};
+  EXPECT_EQ(document.get_num_blocks(), 1);
+  EXPECT_EQ(document.get_num_lines(), 4);
+
+  document.update_text(
+      text_document_test::make_log(TextDocument::kLinesPerBlock * 2 + 1));
+  EXPECT_EQ(document.get_num_blocks(), 3);
+  EXPECT_EQ(document.get_num_lines(), TextDocument::kLinesPerBlock * 2 + 1);
+
+  // continues the last line
+  document.append_text(" (retried)");
+  EXPECT_EQ(document.get_num_lines(), TextDocument::kLinesPerBlock * 2 + 1);
+
+  document.append_text("\nanother line");
+  EXPECT_EQ(document.get_num_blocks(), 3);
+  EXPECT_EQ(document.get_num_lines(), TextDocument::kLinesPerBlock * 2 + 2);
+}
+
+TEST(TextDocumentTest, OnlyVisibleBlocksAreShaped) {
+  using namespace text_document_test;
+
+  auto const begin = std::chrono::steady_clock::now();
+
+  TextDocument document{make_log(kNumLines)};
+  Extent const extent = document.trim(Extent{800, stx::u32_max});
+
+  auto const split_duration = std::chrono::steady_clock::now() - begin;
+
+  // nothing is shaped until drawn
+  EXPECT_EQ(document.get_num_shaped_blocks(), 0);
+  EXPECT_GT(extent.height, 600);
+
+  auto const draw_begin = std::chrono::steady_clock::now();
+  draw_viewport(document, extent, extent.height / 2.0f);
+  auto const draw_duration = std::chrono::steady_clock::now() - draw_begin;
+
+  // a 600px viewport spans a couple of blocks at most
+  EXPECT_GE(document.get_num_shaped_blocks(), 1);
+  EXPECT_LE(document.get_num_shaped_blocks(), 3);
+
+  size_t const num_shaped = document.get_num_shaped_blocks();
+
+  // appending only invalidates the last block, which isn't visible
+  document.append_text("\n[INFO] shutting down");
+  EXPECT_EQ(document.get_num_shaped_blocks(), num_shaped);
+
+  // scrolling through the document retains a bounded number of blocks
+  for (float y = 0.0f; y < extent.height; y += extent.height / 200.0f) {
+    draw_viewport(document, extent, y);
+  }
+
+  EXPECT_LE(document.get_num_shaped_blocks(), TextDocument::kMaxShapedBlocks);
+
+  auto const to_us = [](std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+        .count();
+  };
+
+  std::cout << "\n" << kNumLines << " lines split into "
+            << document.get_num_blocks() << " blocks in "
+            << to_us(split_duration) << "us\n"
+            << "viewport drawn in " << to_us(draw_duration) << "us\n";
+}
@@ -0,0 +1,466 @@
+#include "vlk/ui/widgets/text.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "include/core/SkBitmap.h"
+#include "include/core/SkFontMgr.h"
+#include "include/core/SkPictureRecorder.h"
+#include "include/core/SkSurface.h"
+#include "mock_widgets.h"
+#include "modules/skparagraph/src/ParagraphBuilderImpl.h"
+#include "vlk/ui/canvas.h"
+#include "vlk/ui/font_collection.h"
+#include "vlk/ui/paragraph_cache.h"
+#include "vlk/ui/pipeline.h"
+
+namespace sktext = skia::textlayout;
+
+namespace vlk {
+namespace ui {
+
+struct TextTestProxy {
+  // replaces the shaping task with one that never completes, and finishes it
+  // as the scheduler would after canceling it
+  static void fail_shaping(Text& text) {
+    auto promise =
+        stx::make_promise<std::shared_ptr<CachedParagraph>>(stx::os_allocator)
+            .unwrap();
+    text.shaping_ = stx::Some(FutureAwaiter{
+        promise.get_future(), stx::fn::rc::make_static([] {})});
+    text.finish_shaping();
+  }
+};
+
+}  // namespace ui
+}  // namespace vlk
+
+namespace text_test {
+
+constexpr size_t kNumLabels = 5000;
+
+sk_sp<SkTypeface> default_typeface() {
+  sk_sp<SkFontMgr> font_mgr = SkFontMgr::RefDefault();
+  if (font_mgr == nullptr) return nullptr;
+  return font_mgr->legacyMakeTypeface(nullptr, SkFontStyle{});
+}
+
+sktext::ParagraphStyle label_style() {
+  sktext::TextStyle text_style;
+  text_style.setFontFamilies({SkString{"Label"}});
+  text_style.setFontSize(16.0f);
+
+  sktext::ParagraphStyle paragraph_style;
+  paragraph_style.setTextStyle(text_style);
+  return paragraph_style;
+}
+
+void build_label(sktext::ParagraphBuilder& builder, size_t index) {
+  std::string const text = "Label #" + std::to_string(index);
+  builder.addText(text.data(), text.size());
+  std::unique_ptr<sktext::Paragraph> paragraph = builder.Build();
+  paragraph->layout(200.0f);
+  EXPECT_GT(paragraph->getHeight(), 0.0f);
+}
+
+void draw(Widget& widget, Extent extent) {
+  SkPictureRecorder recorder;
+  SkCanvas* sk_canvas =
+      recorder.beginRecording(SkRect::MakeWH(extent.width, extent.height));
+  Canvas canvas{*sk_canvas, extent, Dpr{}};
+  widget.draw(canvas);
+  recorder.finishRecordingAsPicture();
+}
+
+// draws the widget onto a grey raster surface
+SkBitmap render(Widget& widget, Extent extent) {
+  sk_sp<SkSurface> surface =
+      SkSurface::MakeRasterN32Premul(extent.width, extent.height);
+  surface->getCanvas()->clear(SK_ColorGRAY);
+  Canvas canvas{*surface->getCanvas(), extent, Dpr{}};
+  widget.draw(canvas);
+
+  SkBitmap bitmap;
+  bitmap.allocN32Pixels(extent.width, extent.height);
+  EXPECT_TRUE(surface->readPixels(bitmap, 0, 0));
+  return bitmap;
+}
+
+bool is_near(SkColor a, SkColor b) {
+  auto const near = [](U8CPU x, U8CPU y) { return x + 48 >= y && y + 48 >= x; };
+  return near(SkColorGetR(a), SkColorGetR(b)) &&
+         near(SkColorGetG(a), SkColorGetG(b)) &&
+         near(SkColorGetB(a), SkColorGetB(b));
+}
+
+size_t count_pixels(SkBitmap const& bitmap, SkColor color) {
+  size_t num = 0;
+  for (int y = 0; y < bitmap.height(); y++) {
+    for (int x = 0; x < bitmap.width(); x++) {
+      if (is_near(bitmap.getColor(x, y), color)) num++;
+    }
+  }
+  return num;
+}
+
+// the longest horizontal run of pixels of `color`, i.e. a decoration
+size_t longest_run(SkBitmap const& bitmap, SkColor color) {
+  size_t longest = 0;
+  for (int y = 0; y < bitmap.height(); y++) {
+    size_t run = 0;
+    for (int x = 0; x < bitmap.width(); x++) {
+      run = is_near(bitmap.getColor(x, y), color) ? run + 1 : 0;
+      longest = std::max(longest, run);
+    }
+  }
+  return longest;
+}
+
+}  // namespace text_test
+
+TEST(TextTest, FontCollectionIsShared) {
+  RenderContext context;
+  MockSized child{Extent{20, 20}};
+  MockView root{&child};
+  Pipeline pipeline{root, context};
+
+  ASSERT_NE(pipeline.font_collection, nullptr);
+
+  auto subsystem = pipeline.context.get("VLK_FontCollection").unwrap();
+  EXPECT_EQ(subsystem.handle->as<SharedFontCollection>().unwrap(),
+            pipeline.font_collection);
+}
+
+TEST(TextTest, TypefacesAreRegisteredOnce) {
+  using namespace text_test;
+
+  sk_sp<SkTypeface> typeface = default_typeface();
+  if (typeface == nullptr) GTEST_SKIP() << "no system typeface available";
+
+  SharedFontCollection font_collection;
+
+  for (size_t i = 0; i < kNumLabels; i++) {
+    font_collection.register_typeface("Label", typeface);
+  }
+
+  EXPECT_TRUE(font_collection.has_typeface("Label"));
+  EXPECT_FALSE(font_collection.has_typeface("Heading"));
+
+  SharedFontCollection::Stats const stats = font_collection.get_stats();
+  EXPECT_EQ(stats.num_typefaces, 1);
+  EXPECT_EQ(stats.num_duplicate_registrations, kNumLabels - 1);
+  EXPECT_EQ(stats.num_cache_clears, 1);
+}
+
+// compares building the labels' paragraphs with the shared collection against
+// a fresh collection per paragraph (which resolves the font families again for
+// every label)
+TEST(TextTest, SharedFontCollectionBenchmark) {
+  using namespace text_test;
+
+  sk_sp<SkTypeface> typeface = default_typeface();
+  if (typeface == nullptr) GTEST_SKIP() << "no system typeface available";
+
+  sktext::ParagraphStyle const paragraph_style = label_style();
+
+  auto const fresh_begin = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < kNumLabels; i++) {
+    sk_sp<sktext::FontCollection> collection =
+        sk_make_sp<sktext::FontCollection>();
+    collection->getParagraphCache()->turnOn(false);
+    sk_sp provider = sk_make_sp<sktext::TypefaceFontProvider>();
+    provider->registerTypeface(typeface, SkString{"Label"});
+    collection->setAssetFontManager(provider);
+    collection->setDefaultFontManager(SkFontMgr::RefDefault());
+
+    std::unique_ptr<sktext::ParagraphBuilder> builder =
+        sktext::ParagraphBuilderImpl::make(paragraph_style, collection);
+    build_label(*builder, i);
+  }
+
+  auto const fresh_duration = std::chrono::steady_clock::now() - fresh_begin;
+
+  SharedFontCollection font_collection;
+
+  auto const shared_begin = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < kNumLabels; i++) {
+    font_collection.register_typeface("Label", typeface);
+    build_label(*font_collection.make_paragraph_builder(paragraph_style), i);
+  }
+
+  auto const shared_duration = std::chrono::steady_clock::now() - shared_begin;
+
+  SharedFontCollection::Stats const stats = font_collection.get_stats();
+  EXPECT_EQ(stats.num_typefaces, 1);
+  EXPECT_EQ(stats.num_paragraphs_built, kNumLabels);
+  EXPECT_EQ(stats.num_cache_clears, 1);
+
+  auto const to_us = [](std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+        .count();
+  };
+
+  std::cout << "\nfresh collection: " << kNumLabels << " labels in "
+            << to_us(fresh_duration) << "us\n"
+            << "shared collection: " << kNumLabels << " labels in "
+            << to_us(shared_duration) << "us\n"
+            << "speedup: "
+            << static_cast<double>(fresh_duration.count()) /
+                   shared_duration.count()
+            << "x\n";
+}
+
+TEST(TextTest, ParagraphCacheEvictsLeastRecentlyUsed) {
+  ParagraphCache cache{1000};
+
+  auto const make_paragraph = [](size_t size_bytes) {
+    auto paragraph = std::make_shared<CachedParagraph>();
+    paragraph->size_bytes = size_bytes;
+    return paragraph;
+  };
+
+  cache.insert("a", make_paragraph(400));
+  cache.insert("b", make_paragraph(400));
+
+  EXPECT_NE(cache.find("a"), nullptr);
+  EXPECT_EQ(cache.find("c"), nullptr);
+
+  // "b" is the least recently used
+  cache.insert("c", make_paragraph(400));
+
+  EXPECT_EQ(cache.find("b"), nullptr);
+  EXPECT_NE(cache.find("a"), nullptr);
+  EXPECT_NE(cache.find("c"), nullptr);
+
+  ParagraphCache::Stats const stats = cache.get_stats();
+  EXPECT_EQ(stats.num_entries, 2);
+  EXPECT_EQ(stats.size_bytes, 800);
+  EXPECT_EQ(stats.num_evictions, 1);
+  EXPECT_EQ(stats.num_hits, 3);
+  EXPECT_EQ(stats.num_misses, 2);
+  EXPECT_FLOAT_EQ(stats.hit_rate(), 0.6f);
+
+  cache.set_capacity(400);
+  EXPECT_EQ(cache.get_stats().num_entries, 1);
+  EXPECT_EQ(cache.find("a"), nullptr);
+}
+
+TEST(TextTest, MeasureBiasesTowardsSingleLine) {
+  using namespace text_test;
+
+  sk_sp<SkTypeface> typeface = default_typeface();
+  if (typeface == nullptr) GTEST_SKIP() << "no system typeface available";
+
+  SharedFontCollection font_collection;
+  font_collection.register_typeface("Label", typeface);
+
+  std::unique_ptr<sktext::ParagraphBuilder> builder =
+      font_collection.make_paragraph_builder(label_style());
+  std::string const text = "a label that wraps when narrow";
+  builder->addText(text.data(), text.size());
+
+  CachedParagraph paragraph;
+  paragraph.paragraph = builder->Build();
+  paragraph.shaping_context = font_collection.get_shaping_context();
+
+  SelfExtent const extent = paragraph.measure();
+
+  // the bias is the extent of the paragraph laid out on a single line
+  EXPECT_LT(extent.height.min, extent.height.max);
+  EXPECT_EQ(extent.width.bias, extent.width.max);
+  EXPECT_EQ(extent.height.bias, extent.height.min);
+}
+
+TEST(TextTest, IdenticalLabelsShareParagraphs) {
+  RenderContext context;
+  MockSized child{Extent{20, 20}};
+  MockView root{&child};
+  Pipeline pipeline{root, context};
+  pipeline.font_collection->set_shaping_synchronous(true);
+
+  std::vector<std::unique_ptr<Text>> labels;
+
+  for (size_t i = 0; i < 100; i++) {
+    labels.emplace_back(new Text{"kg/m³ (shared label)"});
+  }
+
+  labels.emplace_back(
+      new Text{"kg/m³ (shared label)", TextProps{}.font_size(30.0f)});
+
+  for (auto& label : labels) {
+    label->tick(std::chrono::milliseconds(16), pipeline.context);
+  }
+
+  ParagraphCache::Stats const stats =
+      pipeline.font_collection->get_paragraph_cache().get_stats();
+  EXPECT_EQ(stats.num_misses, 2);
+  EXPECT_EQ(stats.num_hits, 99);
+
+  // all of the labels measure identically
+  for (size_t i = 1; i < 100; i++) {
+    EXPECT_EQ(labels[i]->trim(Extent{120, 400}),
+              labels[0]->trim(Extent{120, 400}));
+  }
+}
+
+TEST(TextTest, PaintOnlyUpdatesAreDrawn) {
+  using namespace text_test;
+
+  if (default_typeface() == nullptr) {
+    GTEST_SKIP() << "no system typeface available";
+  }
+
+  Text text{"if (x) { return y; }"};
+  MockView root{&text};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+  pipeline.font_collection->set_shaping_synchronous(true);
+
+  auto const is_font_loaded = [&text]() {
+    auto const& font_future = text.get_inline_texts()[0].font_future;
+    return font_future.is_some() && !font_future.value().awaiter.is_pending();
+  };
+
+  for (size_t i = 0; i < 1000 && !is_font_loaded(); i++) {
+    pipeline.tick(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  ASSERT_TRUE(is_font_loaded());
+  pipeline.tick(std::chrono::milliseconds(16));
+
+  size_t const num_built =
+      pipeline.font_collection->get_stats().num_paragraphs_built;
+
+  // the laid-out lines cache their paints once first painted
+  SkBitmap const before = render(text, Extent{400, 60});
+  EXPECT_GT(count_pixels(before, SK_ColorBLACK), 0);
+  EXPECT_EQ(count_pixels(before, SK_ColorRED), 0);
+  EXPECT_EQ(longest_run(before, SK_ColorBLUE), 0);
+
+  // highlighting
+  text.update_text("if (x) { return y; }", TextProps{}
+                                               .color(colors::Red)
+                                               .underlined()
+                                               .decoration_color(colors::Blue));
+  pipeline.tick(std::chrono::milliseconds(16));
+
+  EXPECT_EQ(pipeline.font_collection->get_stats().num_paragraphs_built,
+            num_built);
+
+  SkBitmap const after = render(text, Extent{400, 60});
+  EXPECT_GT(count_pixels(after, SK_ColorRED), 0);
+  EXPECT_EQ(count_pixels(after, SK_ColorBLACK), 0);
+  // the underline spans the text
+  EXPECT_GE(longest_run(after, SK_ColorBLUE), 40);
+
+  text.update_text("if (x) { return y; }", TextProps{}.font_size(40.0f));
+  pipeline.tick(std::chrono::milliseconds(16));
+
+  EXPECT_EQ(pipeline.font_collection->get_stats().num_paragraphs_built,
+            num_built + 1);
+}
+
+TEST(TextTest, AsynchronousShaping) {
+  std::string message;
+  for (size_t i = 0; i < 200; i++) message += "a long chat message ";
+
+  Text text{message};
+  MockView root{&text};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  // the paragraph isn't shaped on the UI thread, its extent is estimated
+  pipeline.tick(std::chrono::milliseconds(16));
+  EXPECT_TRUE(text.is_shaping());
+  EXPECT_GT(text.trim(Extent{400, 600}).height, 0);
+
+  for (size_t i = 0; i < 1000 && text.is_shaping(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    pipeline.tick(std::chrono::milliseconds(1));
+  }
+
+  ASSERT_FALSE(text.is_shaping());
+  EXPECT_GE(pipeline.font_collection->get_stats().num_paragraphs_built, 1);
+
+  // the shaped paragraph wraps the message over several lines
+  EXPECT_GT(text.trim(Extent{400, 600}).height,
+            text.trim(Extent{4000, 600}).height);
+}
+
+TEST(TextTest, FailedShapingFallsBackToSynchronous) {
+  std::string message;
+  for (size_t i = 0; i < 200; i++) message += "a long chat message ";
+
+  Text text{message};
+  MockView root{&text};
+
+  RenderContext context;
+  Pipeline pipeline{root, context};
+  pipeline.viewport.resize(Extent{800, 600}, ViewExtent::relative(1.0f, 1.0f));
+
+  pipeline.tick(std::chrono::milliseconds(16));
+  ASSERT_TRUE(text.is_shaping());
+
+  size_t const num_built =
+      pipeline.font_collection->get_stats().num_paragraphs_built;
+
+  TextTestProxy::fail_shaping(text);
+
+  // the paragraph is shaped right away rather than left unshaped. the dropped
+  // task might still complete in the background.
+  EXPECT_FALSE(text.is_shaping());
+  EXPECT_GE(pipeline.font_collection->get_stats().num_paragraphs_built,
+            num_built + 1);
+  EXPECT_GT(text.trim(Extent{400, 600}).height,
+            text.trim(Extent{4000, 600}).height);
+
+  // and isn't queued again
+  pipeline.tick(std::chrono::milliseconds(16));
+  EXPECT_FALSE(text.is_shaping());
+}
+
+TEST(TextTest, SharedParagraphsAtOtherWidths) {
+  using namespace text_test;
+
+  RenderContext context;
+  MockSized child{Extent{20, 20}};
+  MockView root{&child};
+  Pipeline pipeline{root, context};
+  pipeline.font_collection->set_shaping_synchronous(true);
+
+  // i.e. the same label in a narrow and in a wide column
+  Text narrow{"kg/m³ (shared label)"};
+  Text wide{"kg/m³ (shared label)"};
+  Text wide_copy{"kg/m³ (shared label)"};
+
+  for (Text* text : {&narrow, &wide, &wide_copy}) {
+    text->tick(std::chrono::milliseconds(16), pipeline.context);
+  }
+
+  size_t const num_built =
+      pipeline.font_collection->get_stats().num_paragraphs_built;
+
+  for (size_t frame = 0; frame < 10; frame++) {
+    draw(narrow, Extent{60, 100});
+    draw(wide, Extent{400, 100});
+    draw(wide_copy, Extent{400, 100});
+  }
+
+  // the shared paragraph is drawn at the narrow width, the wide labels share
+  // a copy laid out at theirs
+  EXPECT_EQ(pipeline.font_collection->get_stats().num_paragraphs_built,
+            num_built + 1);
+}